@@ -25,31 +25,84 @@ void dma_handler()
 	AdcBuffer::irqHandlerStatic();
 }
 
+void AdcDma::initialize(int32_t transferCount)
+{
+	m_dmaChannel[0] = dma_claim_unused_channel(true);
+	m_dmaChannel[1] = dma_claim_unused_channel(true);
+
+	for (int32_t i = 0; i < 2; i++) {
+		dma_channel_config config = dma_channel_get_default_config(m_dmaChannel[i]);
+		// Reading from constant address, writing to incrementing byte addresses
+		channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+		channel_config_set_read_increment(&config, false);
+		channel_config_set_write_increment(&config, true);
+		// Pace transfers based on availability of ADC samples
+		channel_config_set_dreq(&config, DREQ_ADC);
+		// Trigger the other channel when finished
+		channel_config_set_chain_to(&config, m_dmaChannel[i ^ 1]);
+		dma_channel_configure(m_dmaChannel[i], &config,
+			nullptr,        // dst (set by setWriteAddress)
+			&adc_hw->fifo,  // src
+			transferCount,  // transfer count (reloaded at every trigger)
+			false           // don't start yet
+		);
+	}
+}
+
+void AdcDma::finalize()
+{
+	for (int32_t i = 0; i < 2; i++) {
+		if (m_dmaChannel[i] >= 0) {
+			dma_channel_unclaim(m_dmaChannel[i]);
+			m_dmaChannel[i] = -1;
+		}
+	}
+}
+
+void AdcDma::setWriteAddress(int32_t channelIndex, void* dst)
+{
+	dma_channel_set_write_addr(m_dmaChannel[channelIndex], dst, false);
+}
+
+void AdcDma::start()
+{
+	dma_hw->ints0 = (1u << m_dmaChannel[0]) | (1u << m_dmaChannel[1]);	// clear the interrupt requests left by the last abort
+	dma_channel_start(m_dmaChannel[0]);
+}
+
+void AdcDma::abort()
+{
+	/* Abort both at once, otherwise the aborted channel may trigger the other by chain */
+	const uint32_t mask = (1u << m_dmaChannel[0]) | (1u << m_dmaChannel[1]);
+	dma_hw->abort = mask;
+	while (dma_hw->abort & mask) tight_loop_contents();
+}
+
 void AdcBuffer::irqHandler()
 {
-	/* Clear the interrupt request. */
-	dma_hw->ints0 = 1u << m_dmaChannel;
 	// PRINT_TIME();
 	// printf("dma_handler\n");
 
-	/* Restart DMS */
-	uint8_t* p = m_adcBufferList.writePtr();
-	if (p == nullptr) {
-		// printf("AdcBuffer: overflow\n");
-		p = m_adcBufferList.getLatestWritePtr();
+	/* No need to restart DMA (the other channel is already running). Just commit the finished buffer and set the next buffer */
+	/* Both channels may have finished if the IRQ has been delayed. Handle them in the order of finish */
+	while (true) {
+		const uint32_t mask = 1u << m_dma.getDmaChannel(m_capture.getNextChannelIndex());
+		if ((dma_hw->ints0 & mask) == 0) break;
+		dma_hw->ints0 = mask;	// Clear the interrupt request
+		m_capture.onBufferFinished();
 	}
-	dma_channel_configure(m_dmaChannel, &m_dmaConfig,
-		p,              // dst
-		&adc_hw->fifo,  // src
-		m_captureDepth, // transfer count
-		true            // start immediately
-	);
+}
 
+void AdcBuffer::setIrqEnabled(bool enabled)
+{
+	dma_channel_set_irq0_enabled(m_dma.getDmaChannel(0), enabled);
+	dma_channel_set_irq0_enabled(m_dma.getDmaChannel(1), enabled);
 }
 
 
 int32_t AdcBuffer::initialize(const CONFIG& config)
 {
+	if (config.captureDepth <= 0 || config.captureDepth > BUFFER_SIZE) return RET_ERR;
 	irqHandlerStatic = [this] { irqHandler(); };
 	/* Set parameters */
 	m_captureChannel = config.captureChannel;
@@ -57,7 +110,8 @@ int32_t AdcBuffer::initialize(const CONFIG& config)
 	m_samplingRate = config.samplingRate;
 
 	/* Reset buffer */
-	m_adcBufferList.initialize(BUFFER_NUM, m_captureDepth);
+	m_adcBufferList.initialize(m_captureDepth);
+	m_capture.initialize(&m_adcBufferList, &m_dma);
 
 
 	/* Initialize ADC */
@@ -75,43 +129,37 @@ int32_t AdcBuffer::initialize(const CONFIG& config)
 
 	/* Initialize DMA */
 	// Set up the DMA to start transferring data as soon as it appears in FIFO
-	m_dmaChannel = dma_claim_unused_channel(true);
-	m_dmaConfig = dma_channel_get_default_config(m_dmaChannel);
+	m_dma.initialize(m_captureDepth);
 
-	// Reading from constant address, writing to incrementing byte addresses
-	channel_config_set_transfer_data_size(&m_dmaConfig, DMA_SIZE_8);
-	channel_config_set_read_increment(&m_dmaConfig, false);
-	channel_config_set_write_increment(&m_dmaConfig, true);
-
-	// Pace transfers based on availability of ADC samples
-	channel_config_set_dreq(&m_dmaConfig, DREQ_ADC);
-
-	/* Initialize IRQ for DMA */
-	/* Manually call IRQ handler to config DMA */
-	dma_handler();
-
-	dma_channel_set_irq0_enabled(m_dmaChannel, true);
-	irq_set_exclusive_handler(DMA_IRQ_0 + m_dmaChannel, dma_handler);
-	irq_set_enabled(DMA_IRQ_0 + m_dmaChannel, true);
+	/* Initialize IRQ for DMA (both channels use DMA_IRQ_0) */
+	irq_set_exclusive_handler(DMA_IRQ_0, dma_handler);
+	irq_set_enabled(DMA_IRQ_0, true);
 
 	return RET_OK;
 }
 
 int32_t AdcBuffer::finalize(void)
 {
+	m_dma.finalize();
+	m_capture.finalize();
+	m_adcBufferList.finalize();
 	return RET_OK;
 }
 
 int32_t AdcBuffer::start(void)
 {
+	/* DMA waits for DREQ until ADC starts */
+	setIrqEnabled(true);
+	m_capture.start();
 	adc_run(true);
 	return RET_OK;
 }
 
 int32_t AdcBuffer::stop(void)
 {
-	dma_channel_wait_for_finish_blocking(m_dmaChannel);
 	adc_run(false);
+	setIrqEnabled(false);
+	m_dma.abort();
 	adc_fifo_drain();
 	return RET_OK;
 }
@@ -121,12 +169,17 @@ int32_t AdcBuffer::getBufferSize()
 	return m_adcBufferList.getStoredDataNum();
 }
 
-std::vector<uint8_t>& AdcBuffer::getBuffer(int32_t next)
+uint8_t* AdcBuffer::getBuffer(int32_t next)
+{
+	return m_adcBufferList.referPtr(next);
+}
+
+int32_t AdcBuffer::getCaptureDepth()
 {
-	return m_adcBufferList.refer(next);
+	return m_captureDepth;
 }
 
 void AdcBuffer::deleteFront()
 {
-	(void)m_adcBufferList.read();
+	(void)m_adcBufferList.readPtr();
 }
@@ -4,14 +4,36 @@
 #include <cstdint>
 #include <functional>
 #include "RingBuffer.h"
+#include "PingPongCapture.h"
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 #include "hardware/irq.h"
 
+/* Two DMA channels reading ADC FIFO, chained to each other */
+class AdcDma : public PingPongDma {
+public:
+	AdcDma()
+	{
+		m_dmaChannel[0] = -1;
+		m_dmaChannel[1] = -1;
+	}
+	~AdcDma() {}
+	void initialize(int32_t transferCount);
+	void finalize();
+	void setWriteAddress(int32_t channelIndex, void* dst) override;
+	void start() override;
+	void abort();
+	int32_t getDmaChannel(int32_t channelIndex) { return m_dmaChannel[channelIndex]; }
+
+private:
+	int32_t m_dmaChannel[2];
+};
+
 class AdcBuffer {
 public:
 	static constexpr int32_t ADC_CLOCK  = (48 * 1000 * 1000);        // Fixed value (48MHz)
 	static constexpr int32_t BUFFER_NUM = 4;
+	static constexpr int32_t BUFFER_SIZE = 512;		// max captureDepth
 
 	enum {
 		RET_OK = 0,
@@ -32,21 +54,24 @@ public:
 	int32_t start(void);
 	int32_t stop(void);
 	int32_t getBufferSize();
-	std::vector<uint8_t>& getBuffer(int32_t next);
+	uint8_t* getBuffer(int32_t next);
+	int32_t getCaptureDepth();
+
 	void deleteFront();
 
 public:
 	static std::function<void(void)> irqHandlerStatic;
 private:
 	void irqHandler();
+	void setIrqEnabled(bool enabled);
 
 private:
 	int32_t m_captureChannel;
 	int32_t m_captureDepth;
 	int32_t m_samplingRate;
-	RingBuffer<uint8_t> m_adcBufferList;
-	int32_t m_dmaChannel;
-	dma_channel_config m_dmaConfig;
+	StaticRingBuffer<uint8_t, BUFFER_NUM, BUFFER_SIZE> m_adcBufferList;
+	PingPongCapture<uint8_t> m_capture;
+	AdcDma m_dma;
 };
 
 #endif
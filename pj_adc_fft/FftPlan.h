@@ -0,0 +1,192 @@
+#ifndef FFT_PLAN_H_
+#define FFT_PLAN_H_
+
+#include <cstdint>
+#include <array>
+
+/*** FFT plan
+ * Cooley-Tukey FFT of N points (N = 2^x), the same algorithm as fft() of "C言語による最新アルゴリズム辞典" (奥村晴彦)
+ *   - x[] is the real part and y[] is the imaginary part. The result overwrites them
+ *   - forward() divides the result by N (the same as the original fft()). inverse() doesn't
+ *   - forwardReal() is for real input. N real samples are packed into N / 2 complex values, transformed by the N / 2 points FFT,
+ *     and split into the spectrum of the real input. It's about half the time of forward()
+ * The sine table and the bit-reverse table are calculated at compile time (constexpr), so they are placed in flash and no heap is used
+ * A plan has no state to be modified. The same plan can be used from core0 and core1 at the same time (with different data)
+ ***/
+
+namespace FftPlanTable {
+constexpr double PI = 3.14159265358979323846;
+
+/* Taylor series for |a| <= PI / 4 */
+constexpr double sinSmall(double a)
+{
+	double term = a;
+	double sum = 0;
+	for (int32_t i = 1; i < 30; i += 2) {
+		sum += term;
+		term *= -a * a / ((i + 1) * (i + 2));
+	}
+	return sum;
+}
+
+constexpr double cosSmall(double a)
+{
+	double term = 1;
+	double sum = 0;
+	for (int32_t i = 0; i < 30; i += 2) {
+		sum += term;
+		term *= -a * a / ((i + 1) * (i + 2));
+	}
+	return sum;
+}
+
+/* sin(2 * PI * i / n). The angle is reduced in integer, so the symmetric values are exactly the same */
+constexpr double sinOfIndex(int32_t i, int32_t n)
+{
+	const int32_t n4 = n / 4;
+	const int32_t n8 = n / 8;
+	const int32_t r = ((i % n) + n) % n;
+	const int32_t quadrant = r / n4;
+	const int32_t j = r % n4;
+	/* sin and cos of 2 * PI * j / n, for 0 <= j < n / 4 */
+	const double s = (j <= n8) ? sinSmall(2 * PI * j / n) : cosSmall(2 * PI * (n4 - j) / n);
+	const double c = (j <= n8) ? cosSmall(2 * PI * j / n) : sinSmall(2 * PI * (n4 - j) / n);
+	switch (quadrant) {
+	case 0: return s;
+	case 1: return c;
+	case 2: return -s;
+	default: return -c;
+	}
+}
+
+/* table[i] = sin(2 * PI * i / N). cos(2 * PI * i / N) = table[i + N / 4] */
+template<int32_t N>
+constexpr std::array<float, N * 3 / 4> makeSinTable()
+{
+	std::array<float, N * 3 / 4> table{};
+	for (int32_t i = 0; i < N * 3 / 4; i++) {
+		table[i] = static_cast<float>(sinOfIndex(i, N));
+	}
+	return table;
+}
+
+template<int32_t N>
+constexpr std::array<uint16_t, N> makeBitReverseTable()
+{
+	std::array<uint16_t, N> table{};
+	for (int32_t i = 0; i < N; i++) {
+		int32_t reversed = 0;
+		for (int32_t bit = 1, rbit = N / 2; bit < N; bit <<= 1, rbit >>= 1) {
+			if (i & bit) reversed |= rbit;
+		}
+		table[i] = static_cast<uint16_t>(reversed);
+	}
+	return table;
+}
+}
+
+template<int32_t N>
+class FftPlan
+{
+	static_assert(N >= 4 && (N & (N - 1)) == 0, "N must be 2^x (4 or more)");
+	static_assert(N <= 65536, "bit-reverse table is 16-bit");
+
+public:
+	static constexpr int32_t SIZE = N;
+
+	constexpr FftPlan() {}
+
+	void forward(float x[], float y[]) const
+	{
+		transform(x, y, false);
+		constexpr float scale = 1.0f / N;	// exact, so the same as x / N
+		for (int32_t i = 0; i < N; i++) {
+			x[i] *= scale;
+			y[i] *= scale;
+		}
+	}
+
+	void inverse(float x[], float y[]) const
+	{
+		transform(x, y, true);
+	}
+
+	/* x[0, N) are real input samples (y[] is not read). The result is the same as forward() with y[] = 0,
+	 * but only the bins 0 to N / 2 are written: x[0, N / 2] and y[0, N / 2] (the other bins are the complex conjugate of them) */
+	void forwardReal(float x[], float y[]) const
+	{
+		static_assert(N >= 8, "forwardReal needs N >= 8");
+		constexpr int32_t n2 = N / 2;
+		constexpr int32_t n4 = N / 4;
+		/* z[n] = x[2n] + i * x[2n + 1] */
+		for (int32_t i = 0; i < n2; i++) {
+			y[i] = x[2 * i + 1];
+			x[i] = x[2 * i];
+		}
+		FftPlan<n2>::transform(x, y, false);
+
+		/* X[k] = Fe[k] + W^k * Fo[k], X[N/2 - k] = conj(Fe[k] - W^k * Fo[k]), W = exp(-2 * PI * i / N)
+		 * Fe[k] = (Z[k] + conj(Z[N/2 - k])) / 2, Fo[k] = (Z[k] - conj(Z[N/2 - k])) / 2i */
+		constexpr float scale = 1.0f / N;
+		const float z0r = x[0];
+		const float z0i = y[0];
+		x[0] = (z0r + z0i) * scale;
+		y[0] = 0;
+		x[n2] = (z0r - z0i) * scale;
+		y[n2] = 0;
+		constexpr float halfScale = 0.5f / N;
+		for (int32_t k = 1; k <= n4; k++) {
+			const int32_t m = n2 - k;
+			const float feRe = (x[k] + x[m]) * halfScale;
+			const float feIm = (y[k] - y[m]) * halfScale;
+			const float foRe = (y[k] + y[m]) * halfScale;
+			const float foIm = (x[m] - x[k]) * halfScale;
+			const float c = SIN_TABLE[k + n4];
+			const float s = SIN_TABLE[k];
+			const float tr = c * foRe + s * foIm;
+			const float ti = c * foIm - s * foRe;
+			x[k] = feRe + tr;
+			y[k] = feIm + ti;
+			x[m] = feRe - tr;
+			y[m] = ti - feIm;
+		}
+	}
+
+private:
+	template<int32_t> friend class FftPlan;	// FftPlan<2N>::forwardReal uses transform()
+
+	static void transform(float x[], float y[], bool isInverse)
+	{
+		constexpr int32_t n4 = N / 4;
+		for (int32_t i = 0; i < N; i++) {
+			const int32_t j = BIT_REVERSE_TABLE[i];
+			if (i < j) {
+				float t = x[i];  x[i] = x[j];  x[j] = t;
+				t = y[i];  y[i] = y[j];  y[j] = t;
+			}
+		}
+		for (int32_t k = 1; k < N; k *= 2) {
+			const int32_t k2 = k + k;
+			const int32_t d = N / k2;
+			int32_t h = 0;
+			for (int32_t j = 0; j < k; j++) {
+				const float c = SIN_TABLE[h + n4];
+				const float s = isInverse ? -SIN_TABLE[h] : SIN_TABLE[h];
+				for (int32_t i = j; i < N; i += k2) {
+					const int32_t ik = i + k;
+					const float dx = s * y[ik] + c * x[ik];
+					const float dy = c * y[ik] - s * x[ik];
+					x[ik] = x[i] - dx;  x[i] += dx;
+					y[ik] = y[i] - dy;  y[i] += dy;
+				}
+				h += d;
+			}
+		}
+	}
+
+private:
+	static constexpr std::array<float, N * 3 / 4> SIN_TABLE = FftPlanTable::makeSinTable<N>();
+	static constexpr std::array<uint16_t, N> BIT_REVERSE_TABLE = FftPlanTable::makeBitReverseTable<N>();
+};
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef FFT_PLAN_Q15_H_
+#define FFT_PLAN_Q15_H_
+
+#include <cstdint>
+#include <array>
+#include "FftPlan.h"
+
+/*** FFT plan (Q15)
+ * Integer version of FftPlan for CPUs without FPU (Cortex-M0+). The algorithm is the same as FftPlan
+ *   - x[] and y[] are int16_t. The twiddle factors are Q15, and a butterfly uses only 32-bit multiplications
+ *   - Block floating point: the whole block is shifted right only when the next stage may overflow, and the shift is counted in the exponent.
+ *     forward() and forwardReal() return the exponent. (x[k] + i * y[k]) * 2^exponent is the DFT of the input (not divided by N)
+ *   - forwardReal() is for real input (the same as FftPlan::forwardReal)
+ *   - magnitude() is sqrt(x^2 + y^2) in integer
+ * The tables are calculated at compile time (constexpr), so they are placed in flash and no heap is used
+ ***/
+
+namespace FftPlanTable {
+constexpr int16_t toQ15(double value)
+{
+	const double scaled = value * 32768.0;
+	const double rounded = (scaled >= 0) ? static_cast<double>(static_cast<int32_t>(scaled + 0.5)) : -static_cast<double>(static_cast<int32_t>(-scaled + 0.5));
+	return static_cast<int16_t>(rounded > 32767 ? 32767 : (rounded < -32768 ? -32768 : rounded));
+}
+
+/* table[i] = sin(2 * PI * i / N) in Q15. cos(2 * PI * i / N) = table[i + N / 4] */
+template<int32_t N>
+constexpr std::array<int16_t, N * 3 / 4> makeSinTableQ15()
+{
+	std::array<int16_t, N * 3 / 4> table{};
+	for (int32_t i = 0; i < N * 3 / 4; i++) {
+		table[i] = toQ15(sinOfIndex(i, N));
+	}
+	return table;
+}
+
+/* table[i] = 0.54 - 0.46 * cos(2 * PI * i / N) in Q15 */
+template<int32_t N>
+constexpr std::array<int16_t, N> makeHammingWindowQ15()
+{
+	std::array<int16_t, N> table{};
+	for (int32_t i = 0; i < N; i++) {
+		table[i] = toQ15(0.54 - 0.46 * sinOfIndex(i + N / 4, N));
+	}
+	return table;
+}
+
+/* table[i] = 0.5 - 0.5 * cos(2 * PI * i / N) in Q15 */
+template<int32_t N>
+constexpr std::array<int16_t, N> makeHannWindowQ15()
+{
+	std::array<int16_t, N> table{};
+	for (int32_t i = 0; i < N; i++) {
+		table[i] = toQ15(0.5 - 0.5 * sinOfIndex(i + N / 4, N));
+	}
+	return table;
+}
+}
+
+template<int32_t N>
+class FftPlanQ15
+{
+	static_assert(N >= 4 && (N & (N - 1)) == 0, "N must be 2^x (4 or more)");
+	static_assert(N <= 65536, "bit-reverse table is 16-bit");
+
+public:
+	static constexpr int32_t SIZE = N;
+
+	constexpr FftPlanQ15() {}
+
+	int32_t forward(int16_t x[], int16_t y[]) const
+	{
+		int32_t maxValue;
+		return transform(x, y, maxValue);
+	}
+
+	/* x[0, N) are real input samples (y[] is not read). Only the bins 0 to N / 2 are written: x[0, N / 2] and y[0, N / 2] */
+	int32_t forwardReal(int16_t x[], int16_t y[]) const
+	{
+		static_assert(N >= 8, "forwardReal needs N >= 8");
+		constexpr int32_t n2 = N / 2;
+		constexpr int32_t n4 = N / 4;
+		for (int32_t i = 0; i < n2; i++) {
+			y[i] = x[2 * i + 1];
+			x[i] = x[2 * i];
+		}
+		int32_t maxValue;
+		int32_t exponent = FftPlanQ15<n2>::transform(x, y, maxValue);
+
+		/* X[k] = Fe[k] + W^k * Fo[k], X[N/2 - k] = conj(Fe[k] - W^k * Fo[k]) (see FftPlan::forwardReal) */
+		/* |X| is 2 * max|Z| at most, so the same headroom as a butterfly is needed */
+		const int32_t shift = headroomShift(maxValue);
+		exponent += shift;
+		const int32_t round = (1 << shift) >> 1;
+		const int32_t z0r = x[0];
+		const int32_t z0i = y[0];
+		x[0] = static_cast<int16_t>((z0r + z0i + round) >> shift);
+		y[0] = 0;
+		x[n2] = static_cast<int16_t>((z0r - z0i + round) >> shift);
+		y[n2] = 0;
+		const int32_t halfShift = shift + 1;
+		const int32_t halfRound = 1 << shift;
+		for (int32_t k = 1; k <= n4; k++) {
+			const int32_t m = n2 - k;
+			const int32_t feRe = (x[k] + x[m] + halfRound) >> halfShift;
+			const int32_t feIm = (y[k] - y[m] + halfRound) >> halfShift;
+			const int32_t foRe = (y[k] + y[m] + halfRound) >> halfShift;
+			const int32_t foIm = (x[m] - x[k] + halfRound) >> halfShift;
+			const int32_t c = SIN_TABLE[k + n4];
+			const int32_t s = SIN_TABLE[k];
+			const int32_t tr = (c * foRe + s * foIm + Q15_ROUND) >> 15;
+			const int32_t ti = (c * foIm - s * foRe + Q15_ROUND) >> 15;
+			x[k] = static_cast<int16_t>(feRe + tr);
+			y[k] = static_cast<int16_t>(feIm + ti);
+			x[m] = static_cast<int16_t>(feRe - tr);
+			y[m] = static_cast<int16_t>(ti - feIm);
+		}
+		return exponent;
+	}
+
+	/* sqrt(x^2 + y^2) rounded to the nearest */
+	static uint16_t magnitude(int16_t x, int16_t y)
+	{
+		return sqrt32(static_cast<uint32_t>(x * x) + static_cast<uint32_t>(y * y));
+	}
+
+	/* Bit-by-bit square root. No division is used (Cortex-M0+ has no divide instruction) */
+	static uint16_t sqrt32(uint32_t num)
+	{
+		uint32_t res = 0;
+		uint32_t bit = 1UL << 30;
+		while (bit > num) bit >>= 2;
+		while (bit != 0) {
+			if (num >= res + bit) {
+				num -= res + bit;
+				res = (res >> 1) + bit;
+			} else {
+				res >>= 1;
+			}
+			bit >>= 2;
+		}
+		if (num > res) res++;	// rounding: num - res^2 > res
+		return static_cast<uint16_t>(res);
+	}
+
+private:
+	template<int32_t> friend class FftPlanQ15;	// FftPlanQ15<2N>::forwardReal uses transform()
+
+	static constexpr int32_t Q15_ROUND = 1 << 14;
+	/* A butterfly (and the split of forwardReal) makes a component 2 * sqrt(2) times larger at most. 11584 * 2 * sqrt(2) + rounding < 32767 */
+	static constexpr int32_t HEADROOM_MAX = 11584;
+
+	static int32_t headroomShift(int32_t maxValue)
+	{
+		int32_t shift = 0;
+		while ((maxValue >> shift) > HEADROOM_MAX) shift++;
+		return shift;
+	}
+
+	static int32_t absolute(int32_t value)
+	{
+		return value < 0 ? -value : value;
+	}
+
+	/* Returns the exponent. maxValue is the bitwise OR of the absolute values of the result (not less than the max, and less than twice of it) */
+	static int32_t transform(int16_t x[], int16_t y[], int32_t& maxValue)
+	{
+		constexpr int32_t n4 = N / 4;
+		maxValue = 0;
+		for (int32_t i = 0; i < N; i++) {
+			const int32_t j = BIT_REVERSE_TABLE[i];
+			if (i < j) {
+				int16_t t = x[i];  x[i] = x[j];  x[j] = t;
+				t = y[i];  y[i] = y[j];  y[j] = t;
+			}
+			maxValue |= absolute(x[i]) | absolute(y[i]);
+		}
+		int32_t exponent = 0;
+		for (int32_t k = 1; k < N; k *= 2) {
+			const int32_t k2 = k + k;
+			const int32_t d = N / k2;
+			const int32_t shift = headroomShift(maxValue);
+			const int32_t round = (1 << shift) >> 1;
+			exponent += shift;
+			int32_t bits = 0;
+			int32_t h = 0;
+			for (int32_t j = 0; j < k; j++) {
+				const int32_t c = SIN_TABLE[h + n4];
+				const int32_t s = SIN_TABLE[h];
+				for (int32_t i = j; i < N; i += k2) {
+					const int32_t ik = i + k;
+					const int32_t xi = (x[i] + round) >> shift;
+					const int32_t yi = (y[i] + round) >> shift;
+					const int32_t xk = (x[ik] + round) >> shift;
+					const int32_t yk = (y[ik] + round) >> shift;
+					const int32_t dx = (s * yk + c * xk + Q15_ROUND) >> 15;
+					const int32_t dy = (c * yk - s * xk + Q15_ROUND) >> 15;
+					const int32_t x0 = xi + dx;
+					const int32_t y0 = yi + dy;
+					const int32_t x1 = xi - dx;
+					const int32_t y1 = yi - dy;
+					x[i] = static_cast<int16_t>(x0);
+					y[i] = static_cast<int16_t>(y0);
+					x[ik] = static_cast<int16_t>(x1);
+					y[ik] = static_cast<int16_t>(y1);
+					bits |= absolute(x0) | absolute(y0) | absolute(x1) | absolute(y1);
+				}
+				h += d;
+			}
+			maxValue = bits;
+		}
+		return exponent;
+	}
+
+private:
+	static constexpr std::array<int16_t, N * 3 / 4> SIN_TABLE = FftPlanTable::makeSinTableQ15<N>();
+	static constexpr std::array<uint16_t, N> BIT_REVERSE_TABLE = FftPlanTable::makeBitReverseTable<N>();
+};
+
+#endif
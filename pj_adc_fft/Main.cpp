@@ -11,19 +11,27 @@
 #include "TpTsc2046SPI.h"
 #include "AdcBuffer.h"
 #include "RingBuffer.h"
+#include "FftPlan.h"
+#include "FftPlanQ15.h"
+#include "Stft.h"
+#include "SpectrumAnalyzer.h"
 
 /*** CONST VALUE ***/
 static constexpr std::array<uint8_t, 2> COLOR_BG = { 0x00, 0x00 };
 static constexpr std::array<uint8_t, 2> COLOR_LINE = { 0xF8, 0x00 };
 static constexpr std::array<uint8_t, 2> COLOR_LINE_FFT = { 0x00, 0x1F };
+static constexpr std::array<uint8_t, 2> COLOR_PEAK_FFT = { 0xFF, 0xE0 };
 static constexpr int32_t SCALE = 1;
-static constexpr int32_t SCALE_FFT = 8;
 static constexpr int32_t BUFFER_SIZE = 512;	// 2^x
 static constexpr int32_t SAMPLING_RATE = 10000;
-#ifndef MIN
-#define MIN(a, b) ((a) < (b) ? (a) : (b))
-#endif
-static constexpr int32_t MIN_ADC_BUFFER_SIZE = MIN(4, AdcBuffer::BUFFER_NUM);
+static constexpr int32_t HOP_SIZE = BUFFER_SIZE / 4;	// 75% overlap
+static constexpr int32_t SINGLE_CORE_MAX_BLOCK_NUM = 2;	// ADC buffers processed per call in single core mode, so that the UI is not starved
+static constexpr int32_t SPECTRUM_COLUMN_NUM = 128;		// (BUFFER_SIZE / 2) bins are max-pooled
+static constexpr int32_t SPECTRUM_COLUMN_WIDTH = 2;
+static constexpr int32_t SPECTRUM_HEIGHT = 120;
+static constexpr float SPECTRUM_DB_MIN = -80.0f;
+static constexpr float SPECTRUM_DB_MAX = 0.0f;
+static constexpr int32_t SPECTRUM_FULL_REDRAW_INTERVAL = 32;	// to repair the pixels overwritten by the wave and the text
 
 /*** MACRO ***/
 #ifndef BUILD_ON_PC
@@ -40,14 +48,18 @@ static LcdIli9341SPI& createStaticLcd(void);
 static TpTsc2046SPI& createStaticTp(void);
 static AdcBuffer& createStaticAdcBuffer(void);
 static void reset(LcdIli9341SPI& lcd);
-static bool displayWave(AdcBuffer& adcBuffer, LcdIli9341SPI& lcd);
+static bool displayWave(LcdIli9341SPI& lcd);
 static void displayFft(LcdIli9341SPI& lcd);
 static void displayTime(LcdIli9341SPI& lcd, bool isSkipDisplay, uint32_t core0, uint32_t core1);
 static void switchMultiCore(TpTsc2046SPI& tp);
 
 /*** GLOBAL VARIABLE ***/
 AdcBuffer* g_adcBuffer;
-RingBuffer<float> g_fftResultList;
+StaticRingBuffer<uint8_t, 3, BUFFER_SIZE> g_waveList;					// copy of ADC data for display (written by core1)
+StaticRingBuffer<StftFrame<BUFFER_SIZE>, 2, 1> g_stftFrameList;		// written and read by core1
+StaticRingBuffer<SpectrumColumns<SPECTRUM_COLUMN_NUM>, 3, 1> g_spectrumList;	// written by core1
+static Stft<BUFFER_SIZE> g_stft;
+static SpectrumAnalyzer<BUFFER_SIZE / 2, SPECTRUM_COLUMN_NUM> g_spectrumAnalyzer;
 static int32_t g_timeFFT = 0;	// [msec]
 static bool g_multiCore = true;
 
@@ -66,7 +78,22 @@ int main() {
 	reset(lcd);
 	
 	/* Prepare core1 for FFT */
-	g_fftResultList.initialize(3, BUFFER_SIZE / 2);
+	Stft<BUFFER_SIZE>::CONFIG stftConfig;
+	stftConfig.hopSize = HOP_SIZE;
+	stftConfig.windowType = Stft<BUFFER_SIZE>::WINDOW_HAMMING;
+	stftConfig.gain = 1.0f;
+	g_stft.initialize(stftConfig);
+	SpectrumAnalyzer<BUFFER_SIZE / 2, SPECTRUM_COLUMN_NUM>::CONFIG analyzerConfig;
+	analyzerConfig.averagingRate = 0.25f;
+	analyzerConfig.peakHoldFrameNum = SAMPLING_RATE / HOP_SIZE / 2;		// 0.5 sec
+	analyzerConfig.peakDecayDb = 0.5f;
+	analyzerConfig.dbMin = SPECTRUM_DB_MIN;
+	analyzerConfig.dbMax = SPECTRUM_DB_MAX;
+	analyzerConfig.height = SPECTRUM_HEIGHT;
+	g_spectrumAnalyzer.initialize(analyzerConfig);
+	g_waveList.initialize();
+	g_stftFrameList.initialize();
+	g_spectrumList.initialize();
 	if (g_multiCore) {
 		multicore_launch_core1(core1_main);
 	}
@@ -75,7 +102,7 @@ int main() {
 	adcBuffer.start();
 	while(1) {
 		uint32_t t0 = to_ms_since_boot(get_absolute_time());
-		bool isSkipDisplay = displayWave(adcBuffer, lcd);
+		bool isSkipDisplay = displayWave(lcd);
 		displayFft(lcd);
 
 		if (!g_multiCore) {
@@ -148,23 +175,24 @@ static void reset(LcdIli9341SPI& lcd)
 }
 
 
-static bool displayWave(AdcBuffer& adcBuffer, LcdIli9341SPI& lcd)
+static bool displayWave(LcdIli9341SPI& lcd)
 {
 	/*
 	               n Frame                     n + 1
 	buff[0]   RP, LINE(PREVIOUS)           
 	buff[1]       LINE(NEW)                RP  LINE(PREVIOUS)
-	buff[2]   ADC is writing to this buff      LINE(NEW)
-	buff[3]   WP                           ADC is writing to this buff(this buff is not valid yet)
-	buff[4]                                WP
+	buff[2]   WP                               LINE(NEW)
+	buff[3]                                WP
+	ADC buffers are consumed by core1 (STFT), and core1 copies them to g_waveList
 	*/
-	if (adcBuffer.getBufferSize() >= MIN_ADC_BUFFER_SIZE) {
-		auto& adcBufferPrevious = adcBuffer.getBuffer(0);
-		auto& adcBufferLatest = adcBuffer.getBuffer(1);
+	if (g_waveList.getStoredDataNum() >= 2) {
+		const uint8_t* adcBufferPrevious = g_waveList.referPtr(0);
+		const uint8_t* adcBufferLatest = g_waveList.referPtr(1);
+		const int32_t drawWidth = std::min(LcdIli9341SPI::WIDTH, g_waveList.getDataSize());
 		const float scale = 1 / 256.0 * SCALE * LcdIli9341SPI::HEIGHT;
 		const float offset = - 0.5 * SCALE * LcdIli9341SPI::HEIGHT + LcdIli9341SPI::HEIGHT / 2 - 50;
 		/* Delete previous line */
-		for (int32_t i = 1; i < std::min(LcdIli9341SPI::WIDTH, (int32_t)adcBufferPrevious.size()); i++) {
+		for (int32_t i = 1; i < drawWidth; i++) {
 			// lcd.drawRect(i, (adcBufferPrevious[i] / 256.0 - 0.5) * SCALE * LcdIli9341SPI::HEIGHT + LcdIli9341SPI::HEIGHT / 2, 2, 2, COLOR_BG);
 			lcd.drawLine(
 				i - 1, adcBufferPrevious[i - 1] * scale + offset,
@@ -172,14 +200,14 @@ static bool displayWave(AdcBuffer& adcBuffer, LcdIli9341SPI& lcd)
 				2, COLOR_BG);
 		}
 		/* Draw new line */
-		for (int32_t i = 1; i < std::min(LcdIli9341SPI::WIDTH, (int32_t)adcBufferPrevious.size()); i++) {
+		for (int32_t i = 1; i < drawWidth; i++) {
 			// lcd.drawRect(i, (adcBufferLatest[i] / 256.0 - 0.5) * SCALE * LcdIli9341SPI::HEIGHT + LcdIli9341SPI::HEIGHT / 2, 2, 2, COLOR_LINE);
 			lcd.drawLine(
 				i - 1, adcBufferLatest[i - 1] * scale + offset,
 				i, adcBufferLatest[i] * scale + offset + 1,
 				2, COLOR_LINE);
 		}
-		adcBuffer.deleteFront();
+		(void)g_waveList.readPtr();
 		return false;
 	} else {
 		// printf("displayWave: underflow\n");
@@ -190,27 +218,28 @@ static bool displayWave(AdcBuffer& adcBuffer, LcdIli9341SPI& lcd)
 
 static void displayFft(LcdIli9341SPI& lcd)
 {
-	if (g_fftResultList.getStoredDataNum() >= 3) {
-		auto& fftPrevious = g_fftResultList.refer(0);
-		auto& fftLatest = g_fftResultList.refer(1);
-		
-		/* Delete previous line */
-		for (int32_t i = 1; i < fftPrevious.size(); i++) {
-			// lcd.drawRect(LcdIli9341SPI::WIDTH - i, fftPrevious[i] * LcdIli9341SPI::HEIGHT, 2, 2, COLOR_BG);
-			lcd.drawLine(
-				i - 1, LcdIli9341SPI::HEIGHT * (1 - fftPrevious[i - 1]),
-				i, LcdIli9341SPI::HEIGHT * (1 - fftPrevious[i]) + 1,
-				2, COLOR_BG);
+	/* core1 may be faster than the display. Only the latest columns are drawn, and only the pixels changed from the drawn columns are drawn */
+	static SpectrumColumns<SPECTRUM_COLUMN_NUM> s_drawnColumns;
+	static int32_t s_drawCount = 0;
+	const int32_t storedNum = g_spectrumList.getStoredDataNum();
+	if (storedNum > 0) {
+		const SpectrumColumns<SPECTRUM_COLUMN_NUM>* latest = g_spectrumList.referPtr(storedNum - 1);
+		const bool isFullRedraw = (s_drawCount % SPECTRUM_FULL_REDRAW_INTERVAL) == 0;
+		(void)drawSpectrumColumns(isFullRedraw ? nullptr : &s_drawnColumns, *latest, SPECTRUM_COLUMN_WIDTH, LcdIli9341SPI::HEIGHT, SPECTRUM_HEIGHT,
+			[&lcd](int32_t x, int32_t y, int32_t w, int32_t h, int32_t color) {
+				if (color == SPECTRUM_COLOR_BAR) {
+					lcd.drawRect(x, y, w, h, COLOR_LINE_FFT);
+				} else if (color == SPECTRUM_COLOR_PEAK) {
+					lcd.drawRect(x, y, w, h, COLOR_PEAK_FFT);
+				} else {
+					lcd.drawRect(x, y, w, h, COLOR_BG);
+				}
+			});
+		s_drawnColumns = *latest;
+		s_drawCount++;
+		for (int32_t i = 0; i < storedNum; i++) {
+			(void)g_spectrumList.readPtr();
 		}
-		/* Draw new line */
-		for (int32_t i = 1; i < fftLatest.size(); i++) {
-			// lcd.drawRect(LcdIli9341SPI::WIDTH - i, fftLatest[i] * LcdIli9341SPI::HEIGHT, 2, 2, COLOR_LINE);
-			lcd.drawLine(
-				i - 1, LcdIli9341SPI::HEIGHT * (1 - fftLatest[i - 1]),
-				i, LcdIli9341SPI::HEIGHT * (1 - fftLatest[i]) + 1,
-				2, COLOR_LINE_FFT);
-		}
-		(void)g_fftResultList.read();
 	} else {
 		// printf("displayFft: underflow\n");
 	}
@@ -250,7 +279,11 @@ static void switchMultiCore(TpTsc2046SPI& tp)
 			if (g_multiCore) {
 				g_multiCore = false;
 				multicore_reset_core1();
-				g_fftResultList.initialize(3, BUFFER_SIZE / 2);
+				g_waveList.initialize();
+				g_stftFrameList.initialize();
+				g_spectrumList.initialize();
+				g_stft.reset();		// core1 may have been stopped in the middle of a frame
+				g_spectrumAnalyzer.reset();
 			} else {
 				g_multiCore = true;
 				multicore_launch_core1(core1_main);
@@ -260,13 +293,6 @@ static void switchMultiCore(TpTsc2046SPI& tp)
 	}		
 }
 
-extern int fft(int n, float x[], float y[]);
-static double hammingWindow(double x)
-{
-	double val = 0.54 - 0.46 * std::cos(2 * M_PI * x);
-	return val;
-}
-
 static void core1_main()
 {
 	if (g_multiCore) {
@@ -274,8 +300,10 @@ static void core1_main()
 	}
 #if 0
 	/* test FFT*/
+	const auto hammingWindow = [](double x) { return 0.54 - 0.46 * std::cos(2 * M_PI * x); };
 	#define    N 256
 	static float x[N], y[N];
+	static constexpr FftPlan<N> fftPlan;
 
 	for(int32_t i = 0; i < N; i++){
 		x[i] = std::sin((1.0 * i * 100) / N * 2 * M_PI);
@@ -283,9 +311,7 @@ static void core1_main()
 		y[i] = 0;
 	}
 
-	if (fft(N, x, y)) {
-		printf("error\n");
-	}
+	fftPlan.forward(x, y);
 
 	for (int32_t i = 0; i < N / 2; i++){
 		double p = sqrt(x[i] * x[i] + y[i] * y[i]);
@@ -297,38 +323,47 @@ static void core1_main()
 	}
 #else
 	
-	static std::vector<float> x(BUFFER_SIZE);
-	static std::vector<float> y(BUFFER_SIZE);
+	int32_t blockNum = 0;
 	while(1) {
 		uint32_t t0 = to_ms_since_boot(get_absolute_time());
-		if (g_adcBuffer->getBufferSize() >= MIN_ADC_BUFFER_SIZE - 1) {		// do not use "MIN_ADC_BUFFER_SIZE" because the main thread may pop the buffer
-			auto& data = g_adcBuffer->getBuffer(1);							// do not use RP because the RP may be increased by main thread and overwritten by ADC
-			for (int32_t i = 0; i < x.size(); i++) {
-				x[i] = (data[i] / 256.0 - 0.5) * 2;	// -1 ~ +1
-				x[i] *= SCALE_FFT;
-				x[i] *= hammingWindow((double)(i) / x.size());
+		if (g_adcBuffer->getBufferSize() > 0) {		// core1 is the only reader of ADC buffers, so that STFT gets every sample
+			const uint8_t* data = g_adcBuffer->getBuffer(0);
+
+			uint8_t* waveBuffer = g_waveList.reservePtr(0);
+			if (waveBuffer) {
+				memcpy(waveBuffer, data, BUFFER_SIZE);
+				g_waveList.commit();
+			}
+
+			/* Every frame goes to the analyzer, and only the latest columns go to the display */
+			for (int32_t offset = 0; offset < BUFFER_SIZE; offset += HOP_SIZE) {
+				(void)g_stft.process(data + offset, HOP_SIZE, g_stftFrameList);
+				while (!g_stftFrameList.isUnderflow()) {
+					const StftFrame<BUFFER_SIZE>* frame = g_stftFrameList.referPtr(0);
+					g_spectrumAnalyzer.process(frame->magnitude, frame->sequence);
+					(void)g_stftFrameList.readPtr();
+				}
 			}
-			for (int32_t i = 0; i < y.size(); i++) y[i] = 0;
+			g_adcBuffer->deleteFront();
 
-			float* resultBuffer = g_fftResultList.writePtr();
-			if (!resultBuffer) {
-				// printf("core1_main: overflow\n");
-				resultBuffer = g_fftResultList.getLatestWritePtr();
+			SpectrumColumns<SPECTRUM_COLUMN_NUM>* columns = g_spectrumList.reservePtr(0);
+			if (columns) {
+				*columns = g_spectrumAnalyzer.getColumns();
+				g_spectrumList.commit();
 			}
-			
-			(void)fft(x.size(), x.data(), y.data());
-			for (int32_t i = 0; i < BUFFER_SIZE / 2; i++){
-				resultBuffer[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+
+			uint32_t t1 = to_ms_since_boot(get_absolute_time());
+			g_timeFFT = t1 - t0;
+
+			if (!g_multiCore && ++blockNum >= SINGLE_CORE_MAX_BLOCK_NUM) {
+				break;		// single core: the rest is processed in the next call
 			}
 		} else {
+			if (!g_multiCore) {
+				break;		// single core: no ADC buffer left, return to the main loop
+			}
 			sleep_ms(1);
 		}
-
-		uint32_t t1 = to_ms_since_boot(get_absolute_time());
-		g_timeFFT = t1 - t0;
-		if (!g_multiCore) {
-			break;
-		}
 	}
 #endif
 }
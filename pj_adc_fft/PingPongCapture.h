@@ -0,0 +1,117 @@
+#ifndef PING_PONG_CAPTURE_H_
+#define PING_PONG_CAPTURE_H_
+
+#include <cstdint>
+#include <vector>
+#include "RingBuffer.h"
+
+/*** Ping-pong capture
+ * Two DMA channels are chained to each other. When one channel finishes a buffer, the other channel starts immediately,
+ * so no sample is lost between buffers and the IRQ handler doesn't need to restart DMA. The IRQ handler does only bookkeeping:
+ *   - commits the buffer written by the finished channel to the ring buffer
+ *   - reserves the next free buffer and sets it as the write address of the finished channel (used when it's triggered again)
+ * If the ring buffer is full, the channel writes into a discard buffer instead (overrun). The data is dropped, but capture continues
+ * The IRQ handler must finish before the other channel finishes its buffer
+ ***/
+
+/* Hardware access used by PingPongCapture (pico DMA in AdcBuffer, or a simulation on PC) */
+class PingPongDma {
+public:
+	virtual ~PingPongDma() {}
+	/* channelIndex = 0 or 1. The address is used when the channel is triggered next time */
+	virtual void setWriteAddress(int32_t channelIndex, void* dst) = 0;
+	/* Trigger channel 0. After that, the channels trigger each other */
+	virtual void start() = 0;
+};
+
+template<class T>
+class PingPongCapture
+{
+public:
+	PingPongCapture()
+		: m_ringBuffer(nullptr)
+		, m_dma(nullptr)
+		, m_nextChannelIndex(0)
+		, m_reservedNum(0)
+		, m_overrunNum(0)
+	{
+		m_isReserved[0] = false;
+		m_isReserved[1] = false;
+	}
+
+	~PingPongCapture()
+	{
+	}
+
+	void initialize(RingBuffer<T>* ringBuffer, PingPongDma* dma)
+	{
+		m_ringBuffer = ringBuffer;
+		m_dma = dma;
+		m_discardBuffer.assign(m_ringBuffer->getDataSize(), T());
+		m_overrunNum = 0;
+	}
+
+	void finalize()
+	{
+		m_discardBuffer.clear();
+		m_discardBuffer.shrink_to_fit();
+	}
+
+	/* Buffers reserved but not committed at the last stop are just reused */
+	void start()
+	{
+		m_nextChannelIndex = 0;
+		m_reservedNum = 0;
+		m_dma->setWriteAddress(0, reserveBuffer(0));
+		m_dma->setWriteAddress(1, reserveBuffer(1));
+		m_dma->start();
+	}
+
+	/* Call from the IRQ handler when the channel of getNextChannelIndex() has finished */
+	void onBufferFinished()
+	{
+		const int32_t index = m_nextChannelIndex;
+		if (m_isReserved[index]) {
+			m_ringBuffer->commit();		// the finished buffer is always the oldest reserved one
+			m_reservedNum--;
+		}
+		m_dma->setWriteAddress(index, reserveBuffer(index));
+		m_nextChannelIndex ^= 1;
+	}
+
+	/* The channels finish alternately */
+	int32_t getNextChannelIndex()
+	{
+		return m_nextChannelIndex;
+	}
+
+	int32_t getOverrunNum()
+	{
+		return m_overrunNum;
+	}
+
+private:
+	T* reserveBuffer(int32_t channelIndex)
+	{
+		T* ptr = m_ringBuffer->reservePtr(m_reservedNum);
+		if (ptr == nullptr) {
+			m_isReserved[channelIndex] = false;
+			m_overrunNum++;
+			return m_discardBuffer.data();
+		}
+		m_isReserved[channelIndex] = true;
+		m_reservedNum++;
+		return ptr;
+	}
+
+private:
+	RingBuffer<T>* m_ringBuffer;
+	PingPongDma* m_dma;
+	std::vector<T> m_discardBuffer;
+	int32_t m_nextChannelIndex;
+	int32_t m_reservedNum;		// the number of buffers reserved in the ring buffer (0 - 2)
+	bool m_isReserved[2];		// false: the channel is writing into m_discardBuffer
+	int32_t m_overrunNum;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <cstdio>
 #include <cstdint>
 #include <vector>
+#include <algorithm>
+#include <atomic>
 
 /*** Buffer structure
  *   |------------------------------------------|
@@ -16,7 +18,12 @@
  ***/
 
 /*** Notice
- * Mutex is not implemented!!!
+ * Lock-free for single writer (e.g. DMA IRQ, core1) and single reader (e.g. core1, core0)
+ *   - Write functions (write, writePtr, reservePtr, commit, getLatestWritePtr) must be called only from the writer
+ *   - Read functions (readPtr, referPtr) must be called only from the reader
+ *   - WP is modified only by the writer, and RP only by the reader. The number of stored data is calculated from the accumulated counters,
+ *     each of which is updated only by its owner (release), so that the data is visible before it's counted
+ * writePtr() counts the buffer before it's filled. Use reservePtr(0) and commit() if the reader is on the other core
  ***/
 
 template<class T>
@@ -24,6 +31,13 @@ class RingBuffer
 {
 public:
 	RingBuffer() 
+		: m_buffer(nullptr)
+		, m_bufferSize(0)
+		, m_dataSize(0)
+		, m_wp(0)
+		, m_rp(0)
+		, m_accumulatedWriteNum(0)
+		, m_accumulatedReadNum(0)
 	{
 	};
 
@@ -31,124 +45,177 @@ public:
 	{
 	};
 
+	/* All buffers are allocated at once in a contiguous area */
 	void initialize(int32_t bufferSize, int32_t dataSize)
 	{
-		m_buffer.resize(bufferSize);
-		for (int i = 0; i < bufferSize; i++) {
-			m_buffer[i].resize(dataSize);
-		}
-
-		m_wp = 0;
-		m_rp = 0;
-		m_sotedDataNum = 0;
+		m_storage.assign(bufferSize * dataSize, T());
+		initializeWithStorage(m_storage.data(), bufferSize, dataSize);
 	}
 
 	void finalize()
 	{
-		for (int i = 0; i < m_buffer.size(); i++) {
-			m_buffer[i].clear();
-		}
-		m_buffer.clear();
+		if (m_storage.empty()) return;		// the storage is not owned (StaticRingBuffer)
+		m_storage.clear();
+		m_storage.shrink_to_fit();
+		m_buffer = nullptr;
 	}
 
 	void write(const std::vector<T>& data)
 	{
 		if (isOverflow()) return;
-		m_buffer[m_wp] = data;
+		std::copy(data.begin(), data.begin() + std::min((int32_t)data.size(), m_dataSize), bufferPtr(m_wp));
 		incrementWp();
 	}
 
 	T* writePtr()
 	{
 		if (isOverflow()) return NULL;
-		T* ptr = m_buffer[m_wp].data();
+		T* ptr = bufferPtr(m_wp);
 		incrementWp();
 		return ptr;
 	}
 
-
-	T* getLatestWritePtr()
+	/* For writers which fill a buffer asynchronously (e.g. DMA). A reserved buffer is not counted in stored data until it's committed */
+	/* next: 0 = the buffer to be committed next, 1 = the buffer after it. Returns NULL if the buffer is not free */
+	T* reservePtr(int32_t next)
 	{
-		int32_t previousWp = m_wp - 1;
-		if (previousWp < 0) previousWp += m_buffer.size();
-		T* ptr = m_buffer[previousWp].data();
-		return ptr;
+		if (getStoredDataNum() + next >= m_bufferSize) return NULL;
+		int32_t index = m_wp + next;
+		if (index >= m_bufferSize) index -= m_bufferSize;
+		return bufferPtr(index);
 	}
 
-	std::vector<T>& read()
+	/* Publish the buffer reserved at next = 0 */
+	void commit()
 	{
-		std::vector<T>& readData = m_buffer[m_rp];
-		incrementRp();
-		return readData;
+		incrementWp();
 	}
 
-	// do not update RP. 0 = current, 1 = next, 2 = next next (NOTE: underflow is not checked)
-	std::vector<T>& refer(int32_t next)
+
+	T* getLatestWritePtr()
 	{
-		int32_t index = m_rp + next;
-		if (index >= m_buffer.size()) index -= m_buffer.size();
-		std::vector<T>& readData = m_buffer[index];
-		return readData;
+		int32_t previousWp = m_wp - 1;
+		if (previousWp < 0) previousWp += m_bufferSize;
+		T* ptr = bufferPtr(previousWp);
+		return ptr;
 	}
 
 	T* readPtr()
 	{
-		std::vector<T>& readData = m_buffer[m_rp];
+		T* ptr = bufferPtr(m_rp);
 		incrementRp();
-		return readData.data();
+		return ptr;
 	}
 
 	// do not update RP. 0 = current, 1 = next, 2 = next next (NOTE: underflow is not checked)
 	T* referPtr(int32_t next)
 	{
 		int32_t index = m_rp + next;
-		if (index >= m_buffer.size()) index -= m_buffer.size();
-		std::vector<T>& readData = m_buffer[index];
-		return readData.data();
+		if (index >= m_bufferSize) index -= m_bufferSize;
+		return bufferPtr(index);
 	}
 
 	bool isOverflow()
 	{
-		if (m_wp == m_rp && m_sotedDataNum > 0) {
-			return true;
-		} else {
-			return false;
-		}
+		return getStoredDataNum() >= m_bufferSize;
 	}
 
 
 	bool isUnderflow()
 	{
-		return m_sotedDataNum == 0;
+		return getStoredDataNum() == 0;
 	}
 
 	int32_t getStoredDataNum()
 	{
-		return m_sotedDataNum;
+		/* unsigned subtraction works even after the counters wrap around */
+		return static_cast<int32_t>(m_accumulatedWriteNum.load(std::memory_order_acquire) - m_accumulatedReadNum.load(std::memory_order_acquire));
+	}
+
+	int32_t getDataSize()
+	{
+		return m_dataSize;
+	}
+
+protected:
+	/* storage must have bufferSize * dataSize elements */
+	void initializeWithStorage(T* storage, int32_t bufferSize, int32_t dataSize)
+	{
+		m_buffer = storage;
+		m_bufferSize = bufferSize;
+		m_dataSize = dataSize;
+
+		m_wp = 0;
+		m_rp = 0;
+		m_accumulatedWriteNum.store(0, std::memory_order_relaxed);
+		m_accumulatedReadNum.store(0, std::memory_order_relaxed);
 	}
 
 private:
+	T* bufferPtr(int32_t index)
+	{
+		return m_buffer + index * m_dataSize;
+	}
+
 	void incrementWp()
 	{
-		m_sotedDataNum++;
 		m_wp++;
-		if (m_wp >= m_buffer.size()) m_wp = 0;
+		if (m_wp >= m_bufferSize) m_wp = 0;
+		m_accumulatedWriteNum.store(m_accumulatedWriteNum.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 	}
 
 	void incrementRp()
 	{
 		if (!isUnderflow()) {
 			m_rp++;
-			if (m_rp >= m_buffer.size()) m_rp = 0;
-			m_sotedDataNum--;
+			if (m_rp >= m_bufferSize) m_rp = 0;
+			m_accumulatedReadNum.store(m_accumulatedReadNum.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 		}
 	}
 
 private:
-	std::vector<std::vector<T>> m_buffer;
-	int32_t m_wp;
-	int32_t m_rp;
-	int32_t m_sotedDataNum;
+	std::vector<T> m_storage;
+	T* m_buffer;
+	int32_t m_bufferSize;
+	int32_t m_dataSize;
+	int32_t m_wp;		// used only by the writer
+	int32_t m_rp;		// used only by the reader
+	std::atomic<uint32_t> m_accumulatedWriteNum;
+	std::atomic<uint32_t> m_accumulatedReadNum;
+};
+
+/*** Compile-time sized version
+ * All buffers are placed in an aligned array in the object itself (no heap allocation)
+ * It can be used as a DMA target when the object is placed in static memory
+ * The array is never replaced: initialize(bufferSize, dataSize) is not available and finalize() only empties the buffer. It can't be copied
+ ***/
+template<class T, size_t kBlocks, size_t kBlockSize>
+class StaticRingBuffer : public RingBuffer<T>
+{
+public:
+	StaticRingBuffer()
+	{
+		initialize();
+	}
+
+	StaticRingBuffer(const StaticRingBuffer&) = delete;
+	StaticRingBuffer& operator=(const StaticRingBuffer&) = delete;
+
+	/* dataSize: 1 - kBlockSize (the buffers are packed by dataSize) */
+	void initialize(int32_t dataSize = kBlockSize)
+	{
+		this->initializeWithStorage(m_staticStorage, kBlocks, std::min<int32_t>(dataSize, kBlockSize));
+	}
+
+	void initialize(int32_t bufferSize, int32_t dataSize) = delete;
+
+	void finalize()
+	{
+		initialize(this->getDataSize());
+	}
+
+private:
+	alignas(4) T m_staticStorage[kBlocks * kBlockSize];
 };
 
 #endif
@@ -0,0 +1,207 @@
+#ifndef SPECTRUM_ANALYZER_H_
+#define SPECTRUM_ANALYZER_H_
+
+#include <cstdint>
+#include <cstring>
+
+/*** Spectrum analyzer
+ * Analysis stage after STFT. It makes the columns to be displayed from every frame
+ *   - Exponential averaging of the power of each bin: average += (power - average) * averagingRate (1.0 = no averaging)
+ *   - Max-pooling: a column is the max of the averaged power of the bins in it. It's done before dB scaling, so log is calculated only per column
+ *   - dB scaling: [dbMin, dbMax] is mapped to [0, height] pixels. log2 is approximated from the bits of float (error < 0.015 dB)
+ *   - Peak-hold: the peak is held for peakHoldFrameNum frames, and then decays by peakDecayDb per frame
+ * Every frame must be given in order
+ ***/
+
+template<int32_t COLUMN_NUM>
+struct SpectrumColumns {
+	uint32_t sequence;			// sequence number of the last frame
+	int16_t level[COLUMN_NUM];	// height of the bar [pixel]
+	int16_t peak[COLUMN_NUM];	// height of the peak-hold marker [pixel]. level <= peak
+};
+
+template<int32_t BIN_NUM, int32_t COLUMN_NUM>
+class SpectrumAnalyzer
+{
+	static_assert(BIN_NUM >= COLUMN_NUM && BIN_NUM % COLUMN_NUM == 0, "BIN_NUM must be a multiple of COLUMN_NUM");
+
+public:
+	typedef SpectrumColumns<COLUMN_NUM> COLUMNS;
+	static constexpr int32_t BIN_NUM_PER_COLUMN = BIN_NUM / COLUMN_NUM;
+
+	enum {
+		RET_OK = 0,
+		RET_ERR = -1,
+	};
+
+	typedef struct CONFIG_ {
+		float averagingRate;		// 0 < rate <= 1. 1 = no averaging
+		int32_t peakHoldFrameNum;
+		float peakDecayDb;			// [dB / frame]
+		float dbMin;				// 0 pixel
+		float dbMax;				// height pixels
+		int32_t height;				// [pixel]
+	} CONFIG;
+
+public:
+	SpectrumAnalyzer()
+		: m_averagingRate(1.0f)
+		, m_peakHoldFrameNum(0)
+		, m_peakDecayDb(0)
+		, m_dbMin(0)
+		, m_pixelPerDb(1)
+		, m_height(0)
+		, m_frameNum(0)
+	{
+	}
+
+	~SpectrumAnalyzer() {}
+
+	int32_t initialize(const CONFIG& config)
+	{
+		if (!(config.averagingRate > 0 && config.averagingRate <= 1)) return RET_ERR;
+		if (!(config.dbMax > config.dbMin) || config.height <= 0 || config.height > INT16_MAX) return RET_ERR;
+		m_averagingRate = config.averagingRate;
+		m_peakHoldFrameNum = config.peakHoldFrameNum;
+		m_peakDecayDb = config.peakDecayDb;
+		m_dbMin = config.dbMin;
+		m_pixelPerDb = config.height / (config.dbMax - config.dbMin);
+		m_height = config.height;
+		reset();
+		return RET_OK;
+	}
+
+	void reset()
+	{
+		m_frameNum = 0;		// the averaged power and the peaks are restarted from the next frame
+		memset(&m_columns, 0, sizeof(m_columns));
+	}
+
+	/* magnitude[BIN_NUM] */
+	void process(const float magnitude[], uint32_t sequence)
+	{
+		if (m_frameNum == 0) {
+			for (int32_t i = 0; i < BIN_NUM; i++) m_power[i] = magnitude[i] * magnitude[i];
+		} else {
+			for (int32_t i = 0; i < BIN_NUM; i++) m_power[i] += (magnitude[i] * magnitude[i] - m_power[i]) * m_averagingRate;
+		}
+
+		for (int32_t c = 0; c < COLUMN_NUM; c++) {
+			const float* power = m_power + c * BIN_NUM_PER_COLUMN;
+			float maxPower = power[0];
+			for (int32_t i = 1; i < BIN_NUM_PER_COLUMN; i++) {
+				if (power[i] > maxPower) maxPower = power[i];
+			}
+			const float db = powerToDb(maxPower);
+
+			if (m_frameNum == 0 || db >= m_peakDb[c]) {
+				m_peakDb[c] = db;
+				m_peakHoldCount[c] = m_peakHoldFrameNum;
+			} else if (m_peakHoldCount[c] > 0) {
+				m_peakHoldCount[c]--;
+			} else {
+				m_peakDb[c] -= m_peakDecayDb;
+				if (m_peakDb[c] < db) m_peakDb[c] = db;
+			}
+
+			m_columns.level[c] = dbToHeight(db);
+			m_columns.peak[c] = dbToHeight(m_peakDb[c]);
+		}
+		m_columns.sequence = sequence;
+		m_frameNum++;
+	}
+
+	const COLUMNS& getColumns() const
+	{
+		return m_columns;
+	}
+
+	/* 10 * log10(power). 1 + log2(mantissa) is approximated by a quadratic */
+	static float powerToDb(float power)
+	{
+		if (!(power > 1e-30f)) return -300.0f;
+		uint32_t bits;
+		memcpy(&bits, &power, sizeof(bits));
+		const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 128;	// -1 for the quadratic
+		bits = (bits & 0x007FFFFF) | 0x3F800000;	// 1.0 <= mantissa < 2.0
+		float mantissa;
+		memcpy(&mantissa, &bits, sizeof(mantissa));
+		const float log2 = exponent + (-0.34484843f * mantissa + 2.02466578f) * mantissa - 0.67487759f;
+		return 3.01029996f * log2;
+	}
+
+private:
+	int16_t dbToHeight(float db) const
+	{
+		const float height = (db - m_dbMin) * m_pixelPerDb;
+		if (height <= 0) return 0;
+		if (height >= m_height) return static_cast<int16_t>(m_height);
+		return static_cast<int16_t>(height + 0.5f);
+	}
+
+private:
+	float m_averagingRate;
+	int32_t m_peakHoldFrameNum;
+	float m_peakDecayDb;
+	float m_dbMin;
+	float m_pixelPerDb;
+	int32_t m_height;
+	uint32_t m_frameNum;
+	float m_power[BIN_NUM];				// averaged power
+	float m_peakDb[COLUMN_NUM];
+	int32_t m_peakHoldCount[COLUMN_NUM];
+	COLUMNS m_columns;
+};
+
+
+/*** Drawing the columns
+ * Bars grow upward from the bottom, and the peak-hold marker is the 1 pixel row just above the peak height
+ * The area is (height + 1) rows including the marker: [bottom - height - 1, bottom)
+ * Only the pixels which differ from the previous columns are drawn (previous = nullptr to draw all):
+ *   - the difference of the bar (BAR or BG)
+ *   - the marker when it moves (or when it has been erased by the shrunk bar)
+ * drawRect(x, y, w, h, color) is called with color = SPECTRUM_COLOR_XXX. Returns the number of pixels drawn
+ ***/
+enum {
+	SPECTRUM_COLOR_BG = 0,
+	SPECTRUM_COLOR_BAR,
+	SPECTRUM_COLOR_PEAK,
+};
+
+template<int32_t COLUMN_NUM, class DRAW_RECT>
+int32_t drawSpectrumColumns(const SpectrumColumns<COLUMN_NUM>* previous, const SpectrumColumns<COLUMN_NUM>& latest, int32_t columnWidth, int32_t bottom, int32_t height, DRAW_RECT drawRect)
+{
+	int32_t pixelNum = 0;
+	auto draw = [&](int32_t x, int32_t y, int32_t h, int32_t color) {
+		if (h <= 0) return;
+		drawRect(x, y, columnWidth, h, color);
+		pixelNum += columnWidth * h;
+	};
+	for (int32_t c = 0; c < COLUMN_NUM; c++) {
+		const int32_t x = c * columnWidth;
+		const int32_t level = latest.level[c];
+		const int32_t peak = latest.peak[c];
+		if (previous == nullptr) {
+			draw(x, bottom - height - 1, height - level + 1, SPECTRUM_COLOR_BG);
+			draw(x, bottom - level, level, SPECTRUM_COLOR_BAR);
+			draw(x, bottom - peak - 1, 1, SPECTRUM_COLOR_PEAK);
+			continue;
+		}
+		const int32_t previousLevel = previous->level[c];
+		const int32_t previousPeak = previous->peak[c];
+		if (peak != previousPeak) {
+			draw(x, bottom - previousPeak - 1, 1, SPECTRUM_COLOR_BG);	// repainted below if it's in the new bar
+		}
+		if (level > previousLevel) {
+			draw(x, bottom - level, level - previousLevel, SPECTRUM_COLOR_BAR);
+		} else if (level < previousLevel) {
+			draw(x, bottom - previousLevel, previousLevel - level, SPECTRUM_COLOR_BG);
+		}
+		if (peak != previousPeak || peak < previousLevel) {
+			draw(x, bottom - peak - 1, 1, SPECTRUM_COLOR_PEAK);
+		}
+	}
+	return pixelNum;
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef STFT_H_
+#define STFT_H_
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <array>
+#include "RingBuffer.h"
+#include "FftPlanQ15.h"
+
+/*** Streaming STFT
+ * Consumes the samples from ADC continuously, and calculates the spectrum of the window of N samples at every hop
+ *   - hopSize = N / 2 for 50% overlap, N / 4 for 75% overlap. The frame rate is samplingRate / hopSize, independent of the ADC buffer size
+ *   - Every sample must be given to process() once and in order (e.g. every ADC buffer is read and then deleted)
+ *   - A frame is published to the ring buffer by reservePtr(0) and commit(), so the reader may be on the other core
+ *   - Every frame has a sequence number. If the ring buffer is full, the frame is dropped (not calculated) and the sequence number is skipped,
+ *     so the reader can tell a dropped frame from a duplicated one
+ *   - reset() discards the samples of the current window, but the sequence number and the sample index keep running,
+ *     so a frame after reset() is never taken for a duplicate of the one before
+ * The magnitude is the same scale as FftPlan::forward (divided by N), multiplied by gain
+ ***/
+
+template<int32_t N>
+struct StftFrame {
+	uint32_t sequence;		// 0, 1, 2, ... (counted from initialize(). reset() doesn't restart it)
+	uint32_t sampleIndex;	// index of the first sample of the window in the samples given to process() since initialize()
+	float magnitude[N / 2];
+};
+
+template<int32_t N>
+class Stft
+{
+public:
+	typedef StftFrame<N> FRAME;
+
+	enum {
+		RET_OK = 0,
+		RET_ERR = -1,
+	};
+
+	enum {
+		WINDOW_RECTANGULAR = 0,
+		WINDOW_HANN,
+		WINDOW_HAMMING,
+	};
+
+	typedef struct CONFIG_ {
+		int32_t hopSize;		// 1 - N
+		int32_t windowType;
+		float gain;
+	} CONFIG;
+
+public:
+	Stft()
+		: m_hopSize(N)
+		, m_window(nullptr)
+		, m_gain(1.0f)
+		, m_storedNum(0)
+		, m_inputNum(0)
+		, m_windowStart(0)
+		, m_sequence(0)
+		, m_droppedFrameNum(0)
+	{
+	}
+
+	~Stft() {}
+
+	int32_t initialize(const CONFIG& config)
+	{
+		if (config.hopSize < 1 || config.hopSize > N) return RET_ERR;
+		switch (config.windowType) {
+		case WINDOW_RECTANGULAR: m_window = nullptr; break;
+		case WINDOW_HANN: m_window = HANN_WINDOW.data(); break;
+		case WINDOW_HAMMING: m_window = HAMMING_WINDOW.data(); break;
+		default: return RET_ERR;
+		}
+		m_hopSize = config.hopSize;
+		m_gain = config.gain;
+		m_storedNum = 0;
+		m_inputNum = 0;
+		m_windowStart = 0;
+		m_sequence = 0;
+		m_droppedFrameNum = 0;
+		return RET_OK;
+	}
+
+	/* Discard the samples of the current window (e.g. after ADC is restarted). The next window starts at the next sample given */
+	void reset()
+	{
+		m_storedNum = 0;
+		m_windowStart = m_inputNum;
+	}
+
+	/* Returns the number of frames (including dropped ones) completed by the samples */
+	int32_t process(const uint8_t* data, int32_t num, RingBuffer<FRAME>& output)
+	{
+		int32_t frameNum = 0;
+		while (num > 0) {
+			const int32_t copyNum = (num < N - m_storedNum) ? num : N - m_storedNum;
+			memcpy(m_history + m_storedNum, data, copyNum);
+			m_storedNum += copyNum;
+			m_inputNum += copyNum;
+			data += copyNum;
+			num -= copyNum;
+			if (m_storedNum == N) {
+				calculateFrame(output);
+				frameNum++;
+				/* The next window starts hopSize samples later */
+				memmove(m_history, m_history + m_hopSize, N - m_hopSize);
+				m_storedNum = N - m_hopSize;
+				m_windowStart += m_hopSize;
+			}
+		}
+		return frameNum;
+	}
+
+	int32_t getHopSize()
+	{
+		return m_hopSize;
+	}
+
+	/* The number of frames completed so far (= the sequence number of the next frame) */
+	uint32_t getFrameNum()
+	{
+		return m_sequence;
+	}
+
+	uint32_t getDroppedFrameNum()
+	{
+		return m_droppedFrameNum;
+	}
+
+private:
+	void calculateFrame(RingBuffer<FRAME>& output)
+	{
+		const uint32_t sequence = m_sequence++;
+		FRAME* frame = output.reservePtr(0);
+		if (frame == nullptr) {
+			m_droppedFrameNum++;
+			return;
+		}
+
+		/* (data - 128) << 8 is -1 ~ +1 in Q15 */
+		if (m_window) {
+			for (int32_t i = 0; i < N; i++) m_x[i] = ((m_history[i] - 128) * m_window[i]) >> 7;
+		} else {
+			for (int32_t i = 0; i < N; i++) m_x[i] = (m_history[i] - 128) << 8;
+		}
+		const int32_t exponent = FFT_PLAN.forwardReal(m_x, m_y);
+		const float gain = std::ldexp(m_gain / N / 32768, exponent);
+		for (int32_t i = 0; i < N / 2; i++) {
+			frame->magnitude[i] = FFT_PLAN.magnitude(m_x[i], m_y[i]) * gain;
+		}
+		frame->sequence = sequence;
+		frame->sampleIndex = m_windowStart;
+		output.commit();
+	}
+
+private:
+	static constexpr FftPlanQ15<N> FFT_PLAN = FftPlanQ15<N>();
+	static constexpr std::array<int16_t, N> HANN_WINDOW = FftPlanTable::makeHannWindowQ15<N>();
+	static constexpr std::array<int16_t, N> HAMMING_WINDOW = FftPlanTable::makeHammingWindowQ15<N>();
+
+	int32_t m_hopSize;
+	const int16_t* m_window;	// nullptr for rectangular
+	float m_gain;
+	uint8_t m_history[N];		// samples of the current window. [0, m_storedNum) are valid
+	int32_t m_storedNum;
+	uint32_t m_inputNum;		// samples given to process() since initialize()
+	uint32_t m_windowStart;		// sample index of m_history[0]
+	uint32_t m_sequence;
+	uint32_t m_droppedFrameNum;
+	int16_t m_x[N];
+	int16_t m_y[N];
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "FftPlan.h"
+
+/*** FftPlan benchmark
+ * usec per forward transform of fft() of the baseline ( reference/fft.cpp ), FftPlan<N>::forward() and forwardReal(), N = 256 to 4096
+ *   - fft() and forward() transform the real input with y[] = 0 ( as core1_main did ), forwardReal() doesn't need y[]
+ *   - fft(): tables are made on the first call ( and whenever n changes ), so it's called once before the measurement
+ *   - The input is copied before each transform in all ( the transform is in place )
+ * The best of several runs is shown. The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t RUN_NUM = 10;
+static constexpr int32_t SAMPLE_NUM_PER_RUN = 4000000;
+
+/*** GLOBAL VARIABLE ***/
+static volatile float s_sink;
+
+/*** FUNCTION ***/
+int fft(int n, float x[], float y[]);
+
+template<class FUNC>
+static double measureUs(int32_t loopNum, FUNC func)
+{
+	double best = 1e30;
+	for (int32_t run = 0; run < RUN_NUM; run++) {
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int32_t loop = 0; loop < loopNum; loop++) func();
+		best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / loopNum);
+	}
+	return best;
+}
+
+template<int32_t N>
+static void bench()
+{
+	static constexpr FftPlan<N> plan;
+	const int32_t loopNum = SAMPLE_NUM_PER_RUN / N;
+	std::vector<float> x0(N), x(N), y(N);
+	for (int32_t i = 0; i < N; i++) x0[i] = std::sin(i * 0.1f);
+
+	fft(N, x.data(), y.data());
+	const double timeOriginal = measureUs(loopNum, [&]() {
+		std::copy(x0.begin(), x0.end(), x.begin());
+		std::fill(y.begin(), y.end(), 0.0f);
+		fft(N, x.data(), y.data());
+		s_sink = x[1];
+	});
+	const double timePlan = measureUs(loopNum, [&]() {
+		std::copy(x0.begin(), x0.end(), x.begin());
+		std::fill(y.begin(), y.end(), 0.0f);
+		plan.forward(x.data(), y.data());
+		s_sink = x[1];
+	});
+	const double timeReal = measureUs(loopNum, [&]() {
+		std::copy(x0.begin(), x0.end(), x.begin());
+		plan.forwardReal(x.data(), y.data());
+		s_sink = x[1];
+	});
+	printf("N = %4d: fft() %8.2f usec, forward %8.2f usec (x%.2f), forwardReal %8.2f usec (x%.2f), tables %d Byte in flash\n", N,
+		timeOriginal, timePlan, timeOriginal / timePlan, timeReal, timeOriginal / timeReal,
+		static_cast<int32_t>(N * 3 / 4 * sizeof(float) + N * sizeof(uint16_t)));
+}
+
+int main()
+{
+	bench<256>();
+	bench<512>();
+	bench<1024>();
+	bench<2048>();
+	bench<4096>();
+	return 0;
+}
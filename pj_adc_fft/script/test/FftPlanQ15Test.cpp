@@ -0,0 +1,199 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "FftPlan.h"
+#include "FftPlanQ15.h"
+
+/*** FftPlanQ15 accuracy harness
+ *   - SNR of forward() and forwardReal() against naive DFT ( long double ) for N = 64 to 4096
+ *     input: random full scale ( complex and real ), full scale tone between bins, and the ADC path of Stft ( 8-bit samples with noise, Hamming window )
+ *     SNR = 10 * log10( sum |DFT|^2 / sum |DFT - FFT * 2^exponent|^2 ) over the output bins. The worst of the trials is shown
+ *   - The display value of the ADC path ( magnitude * gain as Stft ) vs the float path ( FftPlan::forwardReal and sqrt ), N = 512
+ *   - Hamming and Hann window tables vs double, and sqrt32() vs sqrtl
+ *   - usage: FftPlanQ15Test [trial_num]
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr double PI = 3.14159265358979323846;
+/* The Q15 data has about 90 dB, and every stage loses about 3 dB at most ( block floating point ) */
+static constexpr double SNR_MIN_RANDOM = 55.0;
+static double snrMinTone(int32_t n)
+{
+	return 74.0 - 3.0 * std::log2(static_cast<double>(n));
+}
+
+/*** FUNCTION ***/
+template<int32_t N>
+class DftReference
+{
+public:
+	DftReference() : m_cos(N), m_sin(N)
+	{
+		for (int32_t i = 0; i < N; i++) {
+			m_cos[i] = std::cos(2 * PI * i / N);
+			m_sin[i] = std::sin(2 * PI * i / N);
+		}
+	}
+
+	/* SNR of (x + i * y) * 2^exponent, bins [0, binNum), against the DFT of (xIn + i * yIn) */
+	double snr(const std::vector<int16_t>& xIn, const std::vector<int16_t>& yIn, const int16_t x[], const int16_t y[], int32_t exponent, int32_t binNum) const
+	{
+		long double signal = 0;
+		long double noise = 0;
+		for (int32_t k = 0; k < binNum; k++) {
+			long double re = 0;
+			long double im = 0;
+			for (int32_t n = 0; n < N; n++) {
+				const int32_t index = static_cast<int32_t>((static_cast<int64_t>(k) * n) % N);
+				re += xIn[n] * m_cos[index] + yIn[n] * m_sin[index];
+				im += yIn[n] * m_cos[index] - xIn[n] * m_sin[index];
+			}
+			const long double dx = re - std::ldexp(static_cast<long double>(x[k]), exponent);
+			const long double dy = im - std::ldexp(static_cast<long double>(y[k]), exponent);
+			signal += re * re + im * im;
+			noise += dx * dx + dy * dy;
+		}
+		return (noise == 0) ? 999.0 : static_cast<double>(10 * std::log10(signal / noise));
+	}
+
+private:
+	std::vector<long double> m_cos;
+	std::vector<long double> m_sin;
+};
+
+/* 8-bit ADC samples of a tone with noise, windowed as Stft does */
+template<int32_t N>
+static void generateAdcInput(int32_t trial, std::mt19937& rng, std::vector<uint8_t>& data, std::vector<int16_t>& x)
+{
+	static constexpr std::array<int16_t, N> WINDOW = FftPlanTable::makeHammingWindowQ15<N>();
+	std::uniform_int_distribution<int32_t> noise(-3, 3);
+	const double frequency = N / 10 + trial * 1.7;
+	const double amplitude = 20 + (trial * 37) % 100;
+	for (int32_t n = 0; n < N; n++) {
+		const double value = std::round(128 + amplitude * std::sin(2 * PI * frequency * n / N) + noise(rng));
+		data[n] = static_cast<uint8_t>(std::min(255.0, std::max(0.0, value)));
+		x[n] = static_cast<int16_t>(((data[n] - 128) * WINDOW[n]) >> 7);
+	}
+}
+
+template<int32_t N>
+static int32_t testSnr(int32_t trialNum, std::mt19937& rng)
+{
+	static constexpr FftPlanQ15<N> plan;
+	static const DftReference<N> dft;
+	std::uniform_int_distribution<int32_t> full(-32768, 32767);
+	std::vector<int16_t> xIn(N), yIn(N), zero(N, 0), x(N), y(N);
+	std::vector<uint8_t> data(N);
+	double worstComplex = 999;
+	double worstReal = 999;
+	double worstTone = 999;
+	double worstAdc = 999;
+	for (int32_t trial = 0; trial < trialNum; trial++) {
+		for (int32_t n = 0; n < N; n++) {
+			xIn[n] = static_cast<int16_t>(full(rng));
+			yIn[n] = static_cast<int16_t>(full(rng));
+		}
+		x = xIn;
+		y = yIn;
+		int32_t exponent = plan.forward(x.data(), y.data());
+		worstComplex = std::min(worstComplex, dft.snr(xIn, yIn, x.data(), y.data(), exponent, N));
+
+		x = xIn;
+		exponent = plan.forwardReal(x.data(), y.data());
+		worstReal = std::min(worstReal, dft.snr(xIn, zero, x.data(), y.data(), exponent, N / 2 + 1));
+
+		for (int32_t n = 0; n < N; n++) xIn[n] = static_cast<int16_t>(std::lround(32767 * std::sin(2 * PI * (N / 8 + trial + 0.3) * n / N)));
+		x = xIn;
+		exponent = plan.forwardReal(x.data(), y.data());
+		worstTone = std::min(worstTone, dft.snr(xIn, zero, x.data(), y.data(), exponent, N / 2 + 1));
+
+		generateAdcInput<N>(trial, rng, data, xIn);
+		x = xIn;
+		exponent = plan.forwardReal(x.data(), y.data());
+		worstAdc = std::min(worstAdc, dft.snr(xIn, zero, x.data(), y.data(), exponent, N / 2 + 1));
+	}
+
+	const double snrMin = snrMinTone(N);
+	const bool ok = worstComplex >= SNR_MIN_RANDOM && worstReal >= SNR_MIN_RANDOM && worstTone >= snrMin && worstAdc >= snrMin;
+	printf("[%s] N = %4d: SNR [dB] random complex %.1f, random real %.1f, tone %.1f, ADC + window %.1f (min %.0f / %.0f)\n", ok ? "OK" : "NG", N,
+		worstComplex, worstReal, worstTone, worstAdc, SNR_MIN_RANDOM, snrMin);
+	return ok ? 0 : 1;
+}
+
+/* The value plotted by the display ( 0 - 1 is the height ) of the Q15 path and of the float path */
+static int32_t testDisplayValue(int32_t trialNum, std::mt19937& rng)
+{
+	constexpr int32_t N = 512;
+	constexpr int32_t HEIGHT = 240;
+	static constexpr FftPlanQ15<N> planQ15;
+	static constexpr FftPlan<N> plan;
+	constexpr float gain = 8.0f;
+	std::vector<uint8_t> data(N);
+	std::vector<int16_t> x(N), y(N);
+	std::vector<float> xFloat(N), yFloat(N);
+	double maxError = 0;
+	for (int32_t trial = 0; trial < trialNum * 40; trial++) {
+		generateAdcInput<N>(trial, rng, data, x);
+		for (int32_t n = 0; n < N; n++) {
+			xFloat[n] = (data[n] - 128) / 128.0f * gain * static_cast<float>(0.54 - 0.46 * std::cos(2 * PI * n / N));
+		}
+		const int32_t exponent = planQ15.forwardReal(x.data(), y.data());
+		plan.forwardReal(xFloat.data(), yFloat.data());
+		const float gainQ15 = std::ldexp(gain / N / 32768, exponent);
+		for (int32_t k = 0; k < N / 2; k++) {
+			const double valueQ15 = FftPlanQ15<N>::magnitude(x[k], y[k]) * gainQ15;
+			const double valueFloat = std::sqrt(xFloat[k] * xFloat[k] + yFloat[k] * yFloat[k]);
+			maxError = std::max(maxError, std::fabs(valueQ15 - valueFloat));
+		}
+	}
+	const bool ok = maxError * HEIGHT < 1.0;
+	printf("[%s] N = %4d: max |Q15 - float| of the display value = %.2e (%.2f px of %d px)\n", ok ? "OK" : "NG", N, maxError, maxError * HEIGHT, HEIGHT);
+	return ok ? 0 : 1;
+}
+
+static int32_t testTable()
+{
+	constexpr int32_t N = 512;
+	static constexpr std::array<int16_t, N> HAMMING = FftPlanTable::makeHammingWindowQ15<N>();
+	static constexpr std::array<int16_t, N> HANN = FftPlanTable::makeHannWindowQ15<N>();
+	double maxError = 0;
+	for (int32_t i = 0; i < N; i++) {
+		maxError = std::max(maxError, std::fabs(HAMMING[i] - std::min(32767.0, 32768 * (0.54 - 0.46 * std::cos(2 * PI * i / N)))));
+		maxError = std::max(maxError, std::fabs(HANN[i] - std::min(32767.0, 32768 * (0.5 - 0.5 * std::cos(2 * PI * i / N)))));
+	}
+
+	/* 1.0 is 32767 in the tables. All of 0 - 2^20, and random values up to 2^31 ( the max of x^2 + y^2 ) */
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<uint32_t> dist(0, 0x80000000u);
+	int32_t sqrtErrorNum = 0;
+	for (uint32_t i = 0; i < (1u << 21); i++) {
+		const uint32_t value = (i < (1u << 20)) ? i : dist(rng);
+		const long double diff = std::fabs(FftPlanQ15<8>::sqrt32(value) - std::sqrt(static_cast<long double>(value)));
+		if (diff > 0.5L + 1e-9L) sqrtErrorNum++;
+	}
+
+	const bool ok = maxError <= 0.5 && sqrtErrorNum == 0;
+	printf("[%s] window table max |error| = %.2f LSB, sqrt32 not rounded to the nearest = %d\n", ok ? "OK" : "NG", maxError, sqrtErrorNum);
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	const int32_t trialNum = (argc > 1) ? atoi(argv[1]) : 5;
+	std::mt19937 rng(1);
+	int32_t errorNum = 0;
+	errorNum += testTable();
+	errorNum += testSnr<64>(trialNum, rng);
+	errorNum += testSnr<256>(trialNum, rng);
+	errorNum += testSnr<512>(trialNum, rng);
+	errorNum += testSnr<1024>(trialNum, rng);
+	errorNum += testSnr<4096>(std::max(1, trialNum / 4), rng);
+	errorNum += testDisplayValue(trialNum, rng);
+	printf("%s\n", errorNum == 0 ? "PASSED" : "FAILED");
+	return errorNum == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "FftPlan.h"
+
+/*** FftPlan::forwardReal test
+ * forwardReal() vs the complex path ( forward() with y[] = 0 ) and vs naive DFT ( long double ), bins 0 to N / 2, N = 8 to 4096
+ *   - input: DC, Nyquist ( +1, -1, ... ), tones on a bin and between bins, 8-bit ADC samples ( as core1_main ) and random
+ *   - y[] is filled with NaN before forwardReal(), so the result is broken if y[] is read
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr double PI = 3.14159265358979323846;
+static constexpr int32_t INPUT_TYPE_NUM = 6;
+static constexpr int32_t RANDOM_TRIAL_NUM = 20;
+
+/*** FUNCTION ***/
+template<int32_t N>
+static void generateInput(int32_t trial, std::mt19937& rng, std::vector<float>& x)
+{
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::uniform_int_distribution<int32_t> adc(0, 255);
+	for (int32_t i = 0; i < N; i++) {
+		switch (std::min(trial, INPUT_TYPE_NUM - 1)) {
+		case 0: x[i] = 1.0f; break;
+		case 1: x[i] = (i % 2) ? -1.0f : 1.0f; break;
+		case 2: x[i] = static_cast<float>(std::sin(2 * PI * 5 * i / N)); break;
+		case 3: x[i] = static_cast<float>(std::cos(2 * PI * (N / 3 + 0.37) * i / N)); break;
+		case 4: x[i] = (adc(rng) - 128) / 128.0f; break;
+		default: x[i] = dist(rng); break;
+		}
+	}
+}
+
+template<int32_t N>
+static int32_t test(std::mt19937& rng)
+{
+	static constexpr FftPlan<N> plan;
+	std::vector<long double> cosTable(N), sinTable(N);
+	for (int32_t i = 0; i < N; i++) {
+		cosTable[i] = std::cos(2 * PI * i / N);
+		sinTable[i] = std::sin(2 * PI * i / N);
+	}
+
+	std::vector<float> input(N), x(N), y(N), xComplex(N), yComplex(N);
+	double maxDiff = 0;
+	double maxError = 0;
+	for (int32_t trial = 0; trial < INPUT_TYPE_NUM - 1 + RANDOM_TRIAL_NUM; trial++) {
+		generateInput<N>(trial, rng, input);
+		x = xComplex = input;
+		std::fill(y.begin(), y.end(), std::numeric_limits<float>::quiet_NaN());
+		std::fill(yComplex.begin(), yComplex.end(), 0.0f);
+		plan.forwardReal(x.data(), y.data());
+		plan.forward(xComplex.data(), yComplex.data());
+		for (int32_t k = 0; k <= N / 2; k++) {
+			long double re = 0;
+			long double im = 0;
+			for (int32_t n = 0; n < N; n++) {
+				const int32_t index = static_cast<int32_t>((static_cast<int64_t>(k) * n) % N);
+				re += input[n] * cosTable[index];
+				im -= input[n] * sinTable[index];
+			}
+			/* NaN fails the comparison below */
+			const double diff = std::hypot(x[k] - xComplex[k], y[k] - yComplex[k]);
+			const double error = static_cast<double>(std::hypot(x[k] - re / N, y[k] - im / N));
+			maxDiff = (diff <= maxDiff) ? maxDiff : diff;
+			maxError = (error <= maxError) ? maxError : error;
+		}
+	}
+
+	const bool ok = maxDiff < 1e-6 && maxError < 1e-6;
+	printf("[%s] N = %4d: max |real - complex| = %.2e, max |real - DFT| = %.2e\n", ok ? "OK" : "NG", N, maxDiff, maxError);
+	return ok ? 0 : 1;
+}
+
+int main()
+{
+	std::mt19937 rng(2);
+	int32_t errorNum = 0;
+	errorNum += test<8>(rng);
+	errorNum += test<16>(rng);
+	errorNum += test<64>(rng);
+	errorNum += test<256>(rng);
+	errorNum += test<512>(rng);
+	errorNum += test<1024>(rng);
+	errorNum += test<4096>(rng);
+	printf("%s\n", errorNum == 0 ? "PASSED" : "FAILED");
+	return errorNum == 0 ? 0 : 1;
+}
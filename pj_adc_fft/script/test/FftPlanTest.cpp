@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+#include "FftPlan.h"
+
+/*** FftPlan test
+ *   - forward() vs naive DFT ( long double, divided by N as forward() ) for N = 4 to 4096, random complex input in [-1, 1)
+ *   - inverse(forward(x)) == x
+ *   - Reentrancy: 2 threads use the same plan at the same time ( as core0 and core1 do ) with different data.
+ *     The results must be bit-exact with the ones calculated one by one
+ *   - usage: FftPlanTest [trial_num_of_reentrancy]
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr double PI = 3.14159265358979323846;
+
+/*** FUNCTION ***/
+template<int32_t N>
+static int32_t testAccuracy(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::vector<float> x(N), y(N), x0(N), y0(N);
+	for (int32_t i = 0; i < N; i++) {
+		x0[i] = x[i] = dist(rng);
+		y0[i] = y[i] = dist(rng);
+	}
+	static constexpr FftPlan<N> plan;
+	plan.forward(x.data(), y.data());
+
+	std::vector<long double> cosTable(N), sinTable(N);
+	for (int32_t i = 0; i < N; i++) {
+		cosTable[i] = std::cos(2 * PI * i / N);
+		sinTable[i] = std::sin(2 * PI * i / N);
+	}
+	double maxError = 0;
+	for (int32_t k = 0; k < N; k++) {
+		long double re = 0;
+		long double im = 0;
+		for (int32_t n = 0; n < N; n++) {
+			const int32_t index = static_cast<int32_t>((static_cast<int64_t>(k) * n) % N);
+			re += x0[n] * cosTable[index] + y0[n] * sinTable[index];
+			im += y0[n] * cosTable[index] - x0[n] * sinTable[index];
+		}
+		maxError = std::max(maxError, static_cast<double>(std::hypot(x[k] - re / N, y[k] - im / N)));
+	}
+
+	plan.inverse(x.data(), y.data());
+	double maxRoundTripError = 0;
+	for (int32_t i = 0; i < N; i++) {
+		maxRoundTripError = std::max(maxRoundTripError, static_cast<double>(std::hypot(x[i] - x0[i], y[i] - y0[i])));
+	}
+
+	/* float has 24 bits, and the error grows with log2(N) stages */
+	const double log2N = std::log2(static_cast<double>(N));
+	const bool ok = maxError < 1e-7 * log2N && maxRoundTripError < 2e-7 * log2N;
+	printf("[%s] N = %4d: max |error| vs DFT = %.2e, round trip = %.2e\n", ok ? "OK" : "NG", N, maxError, maxRoundTripError);
+	return ok ? 0 : 1;
+}
+
+template<int32_t N>
+static int32_t testReentrancy(int32_t trialNum)
+{
+	static constexpr FftPlan<N> plan;
+	constexpr int32_t THREAD_NUM = 2;
+	std::mt19937 rng(N);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::vector<float> input[THREAD_NUM];
+	std::vector<float> expectedX[THREAD_NUM], expectedY[THREAD_NUM];
+	for (int32_t t = 0; t < THREAD_NUM; t++) {
+		input[t].resize(N);
+		for (auto& value : input[t]) value = dist(rng);
+		expectedX[t] = input[t];
+		expectedY[t].assign(N, 0.0f);
+		plan.forward(expectedX[t].data(), expectedY[t].data());
+	}
+
+	int32_t mismatchNum[THREAD_NUM] = { 0 };
+	std::vector<std::thread> threadList;
+	for (int32_t t = 0; t < THREAD_NUM; t++) {
+		threadList.emplace_back([&, t]() {
+			std::vector<float> x(N), y(N);
+			for (int32_t trial = 0; trial < trialNum; trial++) {
+				x = input[t];
+				y.assign(N, 0.0f);
+				plan.forward(x.data(), y.data());
+				if (x != expectedX[t] || y != expectedY[t]) mismatchNum[t]++;
+				if (trial % 64 == 0) std::this_thread::yield();
+			}
+		});
+	}
+	for (auto& thread : threadList) thread.join();
+
+	const int32_t totalMismatchNum = mismatchNum[0] + mismatchNum[1];
+	printf("[%s] N = %4d: %d threads x %d transforms with one plan, mismatch = %d\n", totalMismatchNum == 0 ? "OK" : "NG", N, THREAD_NUM, trialNum, totalMismatchNum);
+	return totalMismatchNum;
+}
+
+int main(int argc, char* argv[])
+{
+	const int32_t trialNum = (argc > 1) ? atoi(argv[1]) : 2000;
+	std::mt19937 rng(1);
+	int32_t errorNum = 0;
+	errorNum += testAccuracy<4>(rng);
+	errorNum += testAccuracy<8>(rng);
+	errorNum += testAccuracy<16>(rng);
+	errorNum += testAccuracy<64>(rng);
+	errorNum += testAccuracy<256>(rng);
+	errorNum += testAccuracy<512>(rng);
+	errorNum += testAccuracy<1024>(rng);
+	errorNum += testAccuracy<2048>(rng);
+	errorNum += testAccuracy<4096>(rng);
+	errorNum += testReentrancy<512>(trialNum);
+	errorNum += testReentrancy<4096>(trialNum / 8);
+	printf("%s\n", errorNum == 0 ? "PASSED" : "FAILED");
+	return errorNum == 0 ? 0 : 1;
+}
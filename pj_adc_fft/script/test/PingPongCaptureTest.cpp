@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "PingPongCapture.h"
+
+/*** PingPongCapture test with a fake DMA
+ *   - FakeDma writes one sample (= the sample index) at a time into the buffer of the active channel, and switches to the other channel
+ *     at the end of the buffer as the chained DMA channels do. The finished channel raises its interrupt flag
+ *   - The IRQ handler runs with a random latency shorter than one buffer, and the reader reads at a random rate and sometimes stalls
+ *     so that the ring buffer overflows
+ *   - Checks: no gap inside a buffer, and the buffers skipped by the reader are exactly getOverrunNum()
+ *   - usage: PingPongCaptureTest [seed] [sample_num]
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t DATA_SIZE = 16;
+
+/*** CLASS ***/
+class FakeDma : public PingPongDma {
+public:
+	FakeDma() : m_dst{nullptr, nullptr}, m_current(nullptr), m_active(0), m_pos(0), m_isFinished{false, false} {}
+
+	void setWriteAddress(int32_t channelIndex, void* dst) override
+	{
+		m_dst[channelIndex] = static_cast<uint32_t*>(dst);
+	}
+
+	void start() override
+	{
+		m_active = 0;
+		m_pos = 0;
+		m_current = m_dst[0];
+	}
+
+	/* The write address is latched when the channel is triggered by the other one (= at the end of the other buffer) */
+	void transfer(uint32_t sample)
+	{
+		m_current[m_pos++] = sample;
+		if (m_pos == DATA_SIZE) {
+			m_isFinished[m_active] = true;
+			m_active ^= 1;
+			m_current = m_dst[m_active];
+			m_pos = 0;
+		}
+	}
+
+	bool isPending()
+	{
+		return m_isFinished[0] || m_isFinished[1];
+	}
+
+	bool isFinished(int32_t channelIndex)
+	{
+		return m_isFinished[channelIndex];
+	}
+
+	void clearInterrupt(int32_t channelIndex)
+	{
+		m_isFinished[channelIndex] = false;
+	}
+
+private:
+	uint32_t* m_dst[2];
+	uint32_t* m_current;
+	int32_t m_active;
+	int32_t m_pos;
+	bool m_isFinished[2];
+};
+
+/*** FUNCTION ***/
+
+int main(int argc, char* argv[])
+{
+	const uint32_t seed = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 1;
+	const uint32_t sampleNum = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], NULL, 10)) : 2000000;
+	srand(seed);
+
+	static StaticRingBuffer<uint32_t, 8, DATA_SIZE> ring;
+	FakeDma dma;
+	PingPongCapture<uint32_t> capture;
+	capture.initialize(&ring, &dma);
+	capture.start();
+
+	uint32_t expectedSample = 0;
+	int32_t droppedNum = 0;
+	int32_t readNum = 0;
+	int32_t errorNum = 0;
+	int32_t irqDelay = -1;
+	for (uint32_t sample = 0; sample < sampleNum; sample++) {
+		dma.transfer(sample);
+
+		/* IRQ */
+		if (dma.isPending() && irqDelay < 0) irqDelay = rand() % (DATA_SIZE - 1);
+		if (irqDelay >= 0 && irqDelay-- == 0) {
+			while (dma.isFinished(capture.getNextChannelIndex())) {
+				dma.clearInterrupt(capture.getNextChannelIndex());
+				capture.onBufferFinished();
+			}
+			irqDelay = -1;
+		}
+
+		/* Reader. It stalls in one third of the time (except the last 20%) */
+		const bool isStalled = (sample < sampleNum / 5 * 4) && ((sample / 20000) % 3 == 0);
+		const int32_t burst = isStalled ? 0 : 1 + rand() % 3;
+		for (int32_t k = 0; k < burst && !ring.isUnderflow() && rand() % 4 == 0; k++) {
+			const uint32_t* buffer = ring.readPtr();
+			readNum++;
+			if (buffer[0] != expectedSample) {
+				if (buffer[0] < expectedSample || (buffer[0] - expectedSample) % DATA_SIZE != 0) errorNum++;
+				droppedNum += (buffer[0] - expectedSample) / DATA_SIZE;
+			}
+			for (int32_t i = 0; i < DATA_SIZE; i++) {
+				if (buffer[i] != buffer[0] + i) errorNum++;
+			}
+			expectedSample = buffer[0] + DATA_SIZE;
+		}
+	}
+
+	/* The reader doesn't stall at the end, so every overrun is seen as skipped buffers */
+	const int32_t overrunNum = capture.getOverrunNum();
+	const bool ok = errorNum == 0 && overrunNum > 0 && droppedNum == overrunNum;
+	printf("read = %d, dropped = %d, overrun = %d, error = %d\n", readNum, droppedNum, overrunNum, errorNum);
+	printf("%s\n", ok ? "PASSED" : "FAILED");
+	return ok ? 0 : 1;
+}
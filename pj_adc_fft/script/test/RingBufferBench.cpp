@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <chrono>
+
+#include "RingBuffer.h"
+#include "reference/LegacyRingBuffer.h"
+
+/*** RingBuffer benchmark
+ * Compares the ring buffers in the ADC capture configuration ( 4 x 512 uint8_t buffers )
+ *   - LegacyRingBuffer: the one before ( vector of vectors, reference/LegacyRingBuffer.h )
+ *   - RingBuffer: one contiguous allocation on heap
+ *   - StaticRingBuffer: compile-time size, no heap
+ * nsec per operation of each path ( write = writePtr + 1 Byte store, refer = referPtr + load, read = readPtr + load ), and RAM
+ * A buffer can't be written ( read ) repeatedly without reading ( writing ) it, so write and read are measured as a pair
+ * The legacy one has no reservePtr/commit ( 0 is printed )
+ * The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t BUFFER_NUM = 4;
+static constexpr int32_t BUFFER_SIZE = 512;
+static constexpr int32_t LOOP_NUM = 2000000;
+
+/*** GLOBAL VARIABLE ***/
+static volatile uint32_t s_sink;
+
+/*** FUNCTION ***/
+static double elapsedNs(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<bool HAS_RESERVE, class RING>
+static void benchSingleThread(const char* name, RING& ring)
+{
+	/* Each path is timed over the whole loop, so that the timer overhead is negligible */
+	uint32_t sum = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int32_t loop = 0; loop < LOOP_NUM; loop++) {
+		ring.writePtr()[0] = static_cast<uint8_t>(loop);
+		sum += ring.readPtr()[0];
+	}
+	const double timeWriteRead = elapsedNs(t0);
+
+	double timeCommitRead = 0;
+	if constexpr (HAS_RESERVE) {
+		t0 = std::chrono::steady_clock::now();
+		for (int32_t loop = 0; loop < LOOP_NUM; loop++) {
+			ring.reservePtr(0)[0] = static_cast<uint8_t>(loop);
+			ring.commit();
+			sum += ring.readPtr()[0];
+		}
+		timeCommitRead = elapsedNs(t0);
+	}
+
+	for (int32_t i = 0; i < BUFFER_NUM; i++) memset(ring.writePtr(), i, BUFFER_SIZE);
+	t0 = std::chrono::steady_clock::now();
+	for (int32_t loop = 0; loop < LOOP_NUM; loop++) {
+		sum += ring.referPtr(loop & (BUFFER_NUM - 1))[loop & (BUFFER_SIZE - 1)];
+	}
+	const double timeRefer = elapsedNs(t0);
+	while (!ring.isUnderflow()) ring.readPtr();
+
+	s_sink = sum;
+	printf("%-20s write + read %6.2f nsec, reserve + commit + read %6.2f nsec, refer %6.2f nsec\n", name,
+		timeWriteRead / LOOP_NUM, timeCommitRead / LOOP_NUM, timeRefer / LOOP_NUM);
+}
+
+int main()
+{
+	static LegacyRingBuffer<uint8_t> legacyRing;
+	static RingBuffer<uint8_t> ring;
+	static StaticRingBuffer<uint8_t, BUFFER_NUM, BUFFER_SIZE> staticRing;
+	legacyRing.initialize(BUFFER_NUM, BUFFER_SIZE);
+	ring.initialize(BUFFER_NUM, BUFFER_SIZE);
+
+	printf("%d buffers x %d Byte, %d operations each\n", BUFFER_NUM, BUFFER_SIZE, LOOP_NUM);
+	benchSingleThread<false>("LegacyRingBuffer", legacyRing);
+	benchSingleThread<true>("RingBuffer", ring);
+	benchSingleThread<true>("StaticRingBuffer", staticRing);
+
+	/* heap = the data + the allocation of each vector (the legacy one has BUFFER_NUM + 1 allocations) */
+	printf("%-20s object %d Byte + heap %d Byte in %d allocations\n", "LegacyRingBuffer", static_cast<int32_t>(sizeof(legacyRing)),
+		static_cast<int32_t>(BUFFER_NUM * (BUFFER_SIZE + sizeof(std::vector<uint8_t>))), BUFFER_NUM + 1);
+	printf("%-20s object %d Byte + heap %d Byte in 1 allocation\n", "RingBuffer", static_cast<int32_t>(sizeof(ring)), BUFFER_NUM * BUFFER_SIZE);
+	printf("%-20s object %d Byte + heap 0 Byte\n", "StaticRingBuffer", static_cast<int32_t>(sizeof(staticRing)));
+	return 0;
+}
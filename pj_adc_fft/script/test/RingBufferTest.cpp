@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <type_traits>
+
+#include "RingBuffer.h"
+
+/*** RingBuffer test
+ *   - StaticRingBuffer: the buffers are in the object, initialize(dataSize) is clamped to kBlockSize and finalize() only empties it
+ *   - SPSC stress: a writer thread and a reader thread pass buffers filled with sequence numbers ( reservePtr/commit as DMA IRQ does )
+ *     the reader checks that no buffer is lost, duplicated or torn
+ *   - usage: RingBufferTest [buffer_num_to_pass]
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t DATA_SIZE = 64;
+
+/*** FUNCTION ***/
+static int32_t testStatic()
+{
+	using StaticRing = StaticRingBuffer<uint8_t, 4, DATA_SIZE>;
+	static_assert(!std::is_copy_constructible<StaticRing>::value && !std::is_copy_assignable<StaticRing>::value, "must not be copyable");
+	static StaticRing ring;
+	const uint8_t* objectBegin = reinterpret_cast<const uint8_t*>(&ring);
+	const uint8_t* objectEnd = objectBegin + sizeof(ring);
+
+	ring.initialize(DATA_SIZE * 2);
+	if (ring.getDataSize() != DATA_SIZE) {
+		printf("[NG] dataSize = %d (expected %d)\n", ring.getDataSize(), DATA_SIZE);
+		return 1;
+	}
+	ring.initialize(DATA_SIZE / 2);
+	for (int32_t i = 0; i < 4; i++) {
+		const uint8_t* ptr = ring.writePtr();
+		if (ptr == NULL || ptr < objectBegin || ptr + DATA_SIZE / 2 > objectEnd || reinterpret_cast<uintptr_t>(ptr) % 4 != 0) {
+			printf("[NG] buffer %d is not in the object\n", i);
+			return 1;
+		}
+	}
+	if (!ring.isOverflow()) {
+		printf("[NG] not overflow after 4 buffers\n");
+		return 1;
+	}
+
+	/* finalize() must leave a usable (empty) ring buffer, not a dangling one */
+	ring.finalize();
+	if (!ring.isUnderflow() || ring.getDataSize() != DATA_SIZE / 2 || ring.writePtr() == NULL || ring.getStoredDataNum() != 1) {
+		printf("[NG] static ring buffer after finalize\n");
+		return 1;
+	}
+	printf("[OK] StaticRingBuffer\n");
+	return 0;
+}
+
+template<class RING>
+static int32_t testSpsc(const char* name, RING& ring, uint32_t bufferNumToPass)
+{
+	std::thread writer([&]() {
+		for (uint32_t index = 0; index < bufferNumToPass; ) {
+			uint8_t* ptr = ring.reservePtr(0);
+			if (ptr == NULL) {
+				std::this_thread::yield();
+				continue;
+			}
+			for (int32_t i = 0; i < DATA_SIZE; i++) ptr[i] = static_cast<uint8_t>(index + i);
+			ring.commit();
+			index++;
+		}
+	});
+
+	uint64_t tornNum = 0;
+	for (uint32_t index = 0; index < bufferNumToPass; ) {
+		if (ring.isUnderflow()) {
+			std::this_thread::yield();
+			continue;
+		}
+		const uint8_t* ptr = ring.readPtr();
+		for (int32_t i = 0; i < DATA_SIZE; i++) {
+			if (ptr[i] != static_cast<uint8_t>(index + i)) {
+				tornNum++;
+				break;
+			}
+		}
+		index++;
+	}
+	writer.join();
+
+	const bool ok = tornNum == 0 && ring.isUnderflow();
+	printf("[%s] SPSC %s: %u buffers passed, torn or lost = %llu\n", ok ? "OK" : "NG", name, bufferNumToPass, static_cast<unsigned long long>(tornNum));
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	const uint32_t bufferNumToPass = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 1000000;
+	static RingBuffer<uint8_t> ring;
+	static StaticRingBuffer<uint8_t, 4, DATA_SIZE> staticRing;
+	ring.initialize(4, DATA_SIZE);
+
+	int32_t errorNum = 0;
+	errorNum += testStatic();
+	errorNum += testSpsc("RingBuffer", ring, bufferNumToPass);
+	errorNum += testSpsc("StaticRingBuffer", staticRing, bufferNumToPass);
+	ring.finalize();
+	printf("%s\n", errorNum == 0 ? "PASSED" : "FAILED");
+	return errorNum == 0 ? 0 : 1;
+}
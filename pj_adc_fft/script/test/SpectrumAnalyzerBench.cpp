@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "Stft.h"
+#include "SpectrumAnalyzer.h"
+
+/*** SpectrumAnalyzer measurement
+ * How much of the spectrum changes per frame, and how many pixels are sent to the display per frame, for a noisy signal
+ * ( a tone, another tone switched on and off, and gaussian noise ) through Stft ( N = 512, 75% overlap )
+ *   - Line plot: displayFft of the baseline. 256 raw magnitudes are plotted as a line ( y = 240 * (1 - 8 * magnitude) ), and every frame
+ *     the previous line is erased and the new one is drawn with drawLine ( 2 px wide )
+ *   - Columns: SpectrumAnalyzer ( 128 columns, -80 - 0 dB in 120 px, peak-hold ) and drawSpectrumColumns of the difference only,
+ *     without averaging ( averagingRate = 1.0 ) and with it ( 0.25, as Main.cpp )
+ * "changed" is the number of bins ( columns ) whose plotted height differs from the previous frame
+ * The time of SpectrumAnalyzer::process() is of the host. Only the ratio is meaningful for the device
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t N = 512;
+static constexpr int32_t HOP_SIZE = N / 4;
+static constexpr int32_t BIN_NUM = N / 2;
+static constexpr int32_t COLUMN_NUM = 128;
+static constexpr int32_t COLUMN_WIDTH = 2;
+static constexpr int32_t HEIGHT = 120;
+static constexpr int32_t SCREEN_HEIGHT = 240;
+static constexpr int32_t LINE_SIZE = 2;
+static constexpr float LINE_SCALE = 8.0f;
+static constexpr double SAMPLING_RATE = 10000;
+static constexpr double PI = 3.14159265358979323846;
+static constexpr int32_t FRAME_NUM = 800;
+typedef SpectrumAnalyzer<BIN_NUM, COLUMN_NUM> ANALYZER;
+
+/*** FUNCTION ***/
+static int32_t lineY(float magnitude)
+{
+	return static_cast<int32_t>(SCREEN_HEIGHT * (1 - LINE_SCALE * magnitude));
+}
+
+/* Pixels of drawLine(i - 1, y0, i, y1 + 1, 2, color) of the baseline ( |x0 - x1| = 1, so it's one rect clamped to the screen ) */
+static int32_t linePixelNum(int32_t y0, int32_t y1)
+{
+	y0 = std::min(SCREEN_HEIGHT, std::max(0, y0));
+	y1 = std::min(SCREEN_HEIGHT, std::max(0, y1));
+	return LINE_SIZE * std::abs(y1 - y0);
+}
+
+static void measure(float averagingRate, const std::vector<uint8_t>& signal)
+{
+	Stft<N> stft;
+	Stft<N>::CONFIG stftConfig = { HOP_SIZE, Stft<N>::WINDOW_HAMMING, 1.0f };
+	stft.initialize(stftConfig);
+	static ANALYZER analyzer;
+	ANALYZER::CONFIG analyzerConfig = { averagingRate, static_cast<int32_t>(SAMPLING_RATE / HOP_SIZE / 2), 0.5f, -80.0f, 0.0f, HEIGHT };
+	analyzer.initialize(analyzerConfig);
+	static RingBuffer<StftFrame<N>> frameList;
+	frameList.initialize(2, 1);
+
+	std::vector<float> previousMagnitude(BIN_NUM, 0.0f);
+	ANALYZER::COLUMNS previousColumns = {};
+	int64_t frameNum = 0;
+	int64_t binChangedNum = 0;
+	int64_t linePixelTotal = 0;
+	int64_t lineRectTotal = 0;
+	int64_t columnChangedNum = 0;
+	int64_t columnPixelTotal = 0;
+	int64_t columnRectTotal = 0;
+	int64_t fullPixelTotal = 0;
+	double processTime = 0;
+	for (size_t offset = 0; offset + HOP_SIZE <= signal.size(); offset += HOP_SIZE) {
+		stft.process(signal.data() + offset, HOP_SIZE, frameList);
+		while (!frameList.isUnderflow()) {
+			const StftFrame<N>* frame = frameList.referPtr(0);
+			const auto t0 = std::chrono::steady_clock::now();
+			analyzer.process(frame->magnitude, frame->sequence);
+			processTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+			const ANALYZER::COLUMNS& columns = analyzer.getColumns();
+			if (frame->sequence > 0) {
+				frameNum++;
+				for (int32_t i = 0; i < BIN_NUM; i++) {
+					if (lineY(frame->magnitude[i]) != lineY(previousMagnitude[i])) binChangedNum++;
+				}
+				for (int32_t i = 1; i < BIN_NUM; i++) {
+					linePixelTotal += linePixelNum(lineY(previousMagnitude[i - 1]), lineY(previousMagnitude[i]) + 1);
+					linePixelTotal += linePixelNum(lineY(frame->magnitude[i - 1]), lineY(frame->magnitude[i]) + 1);
+					lineRectTotal += 2;
+				}
+				for (int32_t c = 0; c < COLUMN_NUM; c++) {
+					if (columns.level[c] != previousColumns.level[c] || columns.peak[c] != previousColumns.peak[c]) columnChangedNum++;
+				}
+				columnPixelTotal += drawSpectrumColumns<COLUMN_NUM>(&previousColumns, columns, COLUMN_WIDTH, SCREEN_HEIGHT, HEIGHT,
+					[&](int32_t, int32_t, int32_t, int32_t, int32_t) { columnRectTotal++; });
+				fullPixelTotal += drawSpectrumColumns<COLUMN_NUM>(nullptr, columns, COLUMN_WIDTH, SCREEN_HEIGHT, HEIGHT,
+					[](int32_t, int32_t, int32_t, int32_t, int32_t) {});
+			}
+			std::copy(frame->magnitude, frame->magnitude + BIN_NUM, previousMagnitude.begin());
+			previousColumns = columns;
+			frameList.readPtr();
+		}
+	}
+
+	printf("averagingRate = %.2f (%lld frames), per frame:\n", averagingRate, static_cast<long long>(frameNum));
+	printf("  line plot: %5.1f / %d bins changed, %6lld px in %lld rects\n", static_cast<double>(binChangedNum) / frameNum, BIN_NUM,
+		static_cast<long long>(linePixelTotal / frameNum), static_cast<long long>(lineRectTotal / frameNum));
+	printf("  columns  : %5.1f / %d columns changed, %6lld px in %lld rects (all columns: %lld px), process() %.2f usec\n",
+		static_cast<double>(columnChangedNum) / frameNum, COLUMN_NUM, static_cast<long long>(columnPixelTotal / frameNum),
+		static_cast<long long>(columnRectTotal / frameNum), static_cast<long long>(fullPixelTotal / frameNum), processTime / (frameNum + 1));
+}
+
+int main()
+{
+	std::mt19937 rng(3);
+	std::normal_distribution<double> noise(0, 3);
+	std::vector<uint8_t> signal(FRAME_NUM * HOP_SIZE + N);
+	for (int32_t n = 0; n < static_cast<int32_t>(signal.size()); n++) {
+		const double value = 60 * std::sin(2 * PI * 1234.5 * n / SAMPLING_RATE) + 20 * std::sin(2 * PI * 3000 * n / SAMPLING_RATE) * ((n / 5000) % 2) + noise(rng);
+		signal[n] = static_cast<uint8_t>(std::min(255.0, std::max(0.0, std::round(128 + value))));
+	}
+	measure(1.0f, signal);
+	measure(0.25f, signal);
+	return 0;
+}
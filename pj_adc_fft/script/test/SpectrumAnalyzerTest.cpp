@@ -0,0 +1,211 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <functional>
+#include <algorithm>
+
+#include "Stft.h"
+#include "SpectrumAnalyzer.h"
+
+/*** SpectrumAnalyzer test with known signals
+ * The same pipeline as core1_main: 8-bit samples -> Stft ( N = 512, 75% overlap, Hamming ) -> SpectrumAnalyzer ( 128 columns, -80 - 0 dB in 120 px )
+ *   - powerToDb() vs 10 * log10
+ *   - Tone: the highest column is the one of the tone frequency, and its level is the dB of the tone
+ *   - Peak-hold: after the tone stops, the peak is held for peakHoldFrameNum frames, and then decays by peakDecayDb per frame
+ *   - reset(): the averaging and the peaks start again
+ *   - drawSpectrumColumns(): drawing only the difference makes the same screen as drawing all, for random updates
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t N = 512;
+static constexpr int32_t HOP_SIZE = N / 4;
+static constexpr int32_t COLUMN_NUM = 128;
+static constexpr int32_t COLUMN_WIDTH = 2;
+static constexpr int32_t HEIGHT = 120;
+static constexpr float DB_MIN = -80.0f;
+static constexpr float DB_MAX = 0.0f;
+static constexpr int32_t SCREEN_WIDTH = 320;
+static constexpr int32_t SCREEN_HEIGHT = 240;
+static constexpr double SAMPLING_RATE = 10000;
+static constexpr double PI = 3.14159265358979323846;
+typedef SpectrumAnalyzer<N / 2, COLUMN_NUM> ANALYZER;
+
+/*** GLOBAL VARIABLE ***/
+static int32_t s_errorNum = 0;
+
+/*** FUNCTION ***/
+#define CHECK(condition, ...) do { if (!(condition)) { s_errorNum++; printf("[NG] " __VA_ARGS__); printf("\n"); } } while (0)
+
+class Screen {
+public:
+	Screen() : m_pixel(SCREEN_WIDTH * SCREEN_HEIGHT, SPECTRUM_COLOR_BG) {}
+	void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t color)
+	{
+		for (int32_t j = y; j < y + h; j++) {
+			for (int32_t i = x; i < x + w; i++) m_pixel[j * SCREEN_WIDTH + i] = color;
+		}
+	}
+	bool operator==(const Screen& other) const { return m_pixel == other.m_pixel; }
+private:
+	std::vector<int32_t> m_pixel;
+};
+
+class Pipeline {
+public:
+	Pipeline(float averagingRate, int32_t peakHoldFrameNum, float peakDecayDb)
+	{
+		Stft<N>::CONFIG stftConfig = { HOP_SIZE, Stft<N>::WINDOW_HAMMING, 1.0f };
+		m_stft.initialize(stftConfig);
+		ANALYZER::CONFIG analyzerConfig = { averagingRate, peakHoldFrameNum, peakDecayDb, DB_MIN, DB_MAX, HEIGHT };
+		CHECK(m_analyzer.initialize(analyzerConfig) == ANALYZER::RET_OK, "initialize");
+		m_frameList.initialize(2, 1);
+	}
+
+	/* Calls onFrame(columns) for each frame */
+	void feed(const std::vector<uint8_t>& signal, std::function<void(const ANALYZER::COLUMNS&)> onFrame)
+	{
+		for (size_t offset = 0; offset + HOP_SIZE <= signal.size(); offset += HOP_SIZE) {
+			m_stft.process(signal.data() + offset, HOP_SIZE, m_frameList);
+			while (!m_frameList.isUnderflow()) {
+				const StftFrame<N>* frame = m_frameList.referPtr(0);
+				m_analyzer.process(frame->magnitude, frame->sequence);
+				onFrame(m_analyzer.getColumns());
+				m_frameList.readPtr();
+			}
+		}
+	}
+
+	ANALYZER& analyzer() { return m_analyzer; }
+
+private:
+	Stft<N> m_stft;
+	ANALYZER m_analyzer;
+	RingBuffer<StftFrame<N>> m_frameList;
+};
+
+static std::vector<uint8_t> generateSignal(int32_t sampleNum, std::function<double(int32_t)> func)
+{
+	std::vector<uint8_t> signal(sampleNum);
+	for (int32_t n = 0; n < sampleNum; n++) signal[n] = static_cast<uint8_t>(std::min(255.0, std::max(0.0, std::round(128 + func(n)))));
+	return signal;
+}
+
+static int32_t highestColumn(const ANALYZER::COLUMNS& columns)
+{
+	int32_t highest = 0;
+	for (int32_t c = 0; c < COLUMN_NUM; c++) {
+		if (columns.level[c] > columns.level[highest]) highest = c;
+	}
+	return highest;
+}
+
+static void testDb()
+{
+	double maxError = 0;
+	for (double power = 1e-12; power < 1e6; power *= 1.0137) {
+		maxError = std::max(maxError, std::fabs(ANALYZER::powerToDb(static_cast<float>(power)) - 10 * std::log10(static_cast<double>(static_cast<float>(power)))));
+	}
+	CHECK(maxError < 0.015 && ANALYZER::powerToDb(0) < -200, "powerToDb: max error %.4f dB", maxError);
+	printf("powerToDb: max error %.4f dB\n", maxError);
+}
+
+/* A tone on a bin with noise. The magnitude of the tone is amplitude / 128 * 0.54 / 2 ( Hamming window, one side ) */
+static void testTone()
+{
+	for (double amplitude : { 100.0, 10.0, 1.0 }) {
+		for (double frequency : { 1015.625, 3007.8125 }) {
+			Pipeline pipeline(0.25f, 10, 0.5f);
+			std::mt19937 rng(5);
+			std::uniform_real_distribution<double> noise(-0.5, 0.5);
+			ANALYZER::COLUMNS last = {};
+			pipeline.feed(generateSignal(N * 20, [&](int32_t n) { return amplitude * std::sin(2 * PI * frequency * n / SAMPLING_RATE) + noise(rng); }),
+				[&](const ANALYZER::COLUMNS& columns) { last = columns; });
+			const int32_t column = highestColumn(last);
+			const int32_t expectedColumn = static_cast<int32_t>(std::lround(frequency * N / SAMPLING_RATE)) / ANALYZER::BIN_NUM_PER_COLUMN;
+			const double expectedDb = 20 * std::log10(amplitude / 128 * 0.54 / 2);
+			const int32_t expectedLevel = static_cast<int32_t>(std::lround((expectedDb - DB_MIN) * HEIGHT / (DB_MAX - DB_MIN)));
+			CHECK(column == expectedColumn && std::abs(last.level[column] - expectedLevel) <= 1, "tone %.0f, %.1f Hz: column %d (expected %d), level %d px (expected %d px)",
+				amplitude, frequency, column, expectedColumn, last.level[column], expectedLevel);
+			printf("tone %5.1f, %7.1f Hz: column %3d (expected %3d), level %3d px (expected %3d px = %.1f dB)\n",
+				amplitude, frequency, column, expectedColumn, last.level[column], expectedLevel, expectedDb);
+		}
+	}
+}
+
+static void testPeakHold()
+{
+	constexpr int32_t HOLD_FRAME_NUM = 10;
+	constexpr float DECAY_DB = 0.5f;
+	Pipeline pipeline(1.0f, HOLD_FRAME_NUM, DECAY_DB);
+	ANALYZER::COLUMNS toneColumns = {};
+	pipeline.feed(generateSignal(N * 8, [](int32_t n) { return 100 * std::sin(2 * PI * 1015.625 * n / SAMPLING_RATE); }),
+		[&](const ANALYZER::COLUMNS& columns) { toneColumns = columns; });
+	const int32_t column = highestColumn(toneColumns);
+
+	/* Silence. The first windows still have a part of the tone ( lower than the peak ), and the peak is held from the first frame */
+	int32_t frameNum = 0;
+	int32_t firstDecayFrame = -1;
+	int32_t peakAt40 = 0;
+	int32_t levelAt40 = 0;
+	pipeline.feed(generateSignal(N * 16, [](int32_t) { return 0.0; }), [&](const ANALYZER::COLUMNS& columns) {
+		frameNum++;
+		if (firstDecayFrame < 0 && columns.peak[column] < toneColumns.peak[column]) firstDecayFrame = frameNum;
+		if (frameNum == 40) {
+			peakAt40 = columns.peak[column];
+			levelAt40 = columns.level[column];
+		}
+	});
+	const int32_t expectedFirstDecayFrame = HOLD_FRAME_NUM + 1;
+	const double expectedPeakAt40 = toneColumns.peak[column] - (40 - expectedFirstDecayFrame + 1) * DECAY_DB * HEIGHT / (DB_MAX - DB_MIN);
+	CHECK(firstDecayFrame == expectedFirstDecayFrame && std::fabs(peakAt40 - expectedPeakAt40) <= 1 && levelAt40 < peakAt40,
+		"peak-hold: decays from frame %d (expected %d), frame 40: %d px (expected %.1f px)", firstDecayFrame, expectedFirstDecayFrame, peakAt40, expectedPeakAt40);
+	printf("peak-hold: held for %d frames, then %d px at frame 40 (expected %.1f px), level %d px\n", firstDecayFrame - 1, peakAt40, expectedPeakAt40, levelAt40);
+
+	/* reset(): the peak of the tone is forgotten */
+	pipeline.analyzer().reset();
+	ANALYZER::COLUMNS afterReset = {};
+	pipeline.feed(generateSignal(HOP_SIZE, [](int32_t) { return 0.0; }), [&](const ANALYZER::COLUMNS& columns) { afterReset = columns; });
+	CHECK(afterReset.peak[column] == afterReset.level[column], "reset: peak %d px, level %d px", afterReset.peak[column], afterReset.level[column]);
+}
+
+static void testDrawDifference()
+{
+	constexpr int32_t BOTTOM = SCREEN_HEIGHT;
+	std::mt19937 rng(9);
+	std::uniform_int_distribution<int32_t> levelDist(0, HEIGHT);
+	Screen screen;
+	ANALYZER::COLUMNS previous = {};
+	ANALYZER::COLUMNS latest = {};
+	auto drawTo = [](Screen& target) {
+		return [&target](int32_t x, int32_t y, int32_t w, int32_t h, int32_t color) { target.drawRect(x, y, w, h, color); };
+	};
+	drawSpectrumColumns<COLUMN_NUM>(nullptr, previous, COLUMN_WIDTH, BOTTOM, HEIGHT, drawTo(screen));
+	int32_t mismatchNum = 0;
+	for (int32_t trial = 0; trial < 2000; trial++) {
+		for (int32_t c = 0; c < COLUMN_NUM; c++) {
+			const int32_t level = (trial % 3 == 0) ? levelDist(rng) : std::max(0, std::min(HEIGHT, previous.level[c] + levelDist(rng) % 7 - 3));
+			const int32_t peak = (rng() % 4 == 0) ? levelDist(rng) : previous.peak[c] - static_cast<int32_t>(rng() % 2);
+			latest.level[c] = static_cast<int16_t>(level);
+			latest.peak[c] = static_cast<int16_t>(std::min(HEIGHT, std::max(level, peak)));
+		}
+		drawSpectrumColumns<COLUMN_NUM>(&previous, latest, COLUMN_WIDTH, BOTTOM, HEIGHT, drawTo(screen));
+		Screen expected;
+		drawSpectrumColumns<COLUMN_NUM>(nullptr, latest, COLUMN_WIDTH, BOTTOM, HEIGHT, drawTo(expected));
+		if (!(screen == expected)) mismatchNum++;
+		previous = latest;
+	}
+	CHECK(mismatchNum == 0, "drawing the difference: %d / 2000 screens differ from drawing all", mismatchNum);
+	printf("drawing the difference: %d / 2000 screens differ from drawing all\n", mismatchNum);
+}
+
+int main()
+{
+	testDb();
+	testTone();
+	testPeakHold();
+	testDrawDifference();
+	printf("%s\n", s_errorNum == 0 ? "PASSED" : "FAILED");
+	return s_errorNum == 0 ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "Stft.h"
+
+/*** Stft driver
+ * Feeds synthetic tones ( 8-bit samples as ADC ) in chunks of random size, and checks the frames
+ *   - Tone: the peak is on the bin of the tone, and the magnitude is the same as the DFT of the window starting at sampleIndex
+ *     for 50% / 75% / 0% overlap, other hop sizes and every window type
+ *   - Frame count: ( sample_num - N ) / hopSize + 1 frames, with sequence 0, 1, 2, ... and sampleIndex = sequence * hopSize
+ *   - Drop: frames are dropped when the ring buffer is full, and their sequence numbers are skipped
+ *   - Reset: the window is discarded, and the sequence number and the sample index keep running
+ *   - Threads: a writer ( core1 ) and a reader ( core0 ). The reader never sees a duplicated frame, and sees every frame not dropped
+ ***/
+
+/*** CONST VALUE ***/
+static constexpr int32_t N = 512;
+static constexpr double SAMPLING_RATE = 10000;
+static constexpr double PI = 3.14159265358979323846;
+typedef Stft<N> STFT;
+
+/*** GLOBAL VARIABLE ***/
+static int32_t s_errorNum = 0;
+
+/*** FUNCTION ***/
+#define CHECK(condition, ...) do { if (!(condition)) { s_errorNum++; printf("[NG] " __VA_ARGS__); printf("\n"); } } while (0)
+
+static std::vector<uint8_t> generateTone(int32_t sampleNum, double frequency, double amplitude)
+{
+	std::vector<uint8_t> signal(sampleNum);
+	for (int32_t n = 0; n < sampleNum; n++) {
+		signal[n] = static_cast<uint8_t>(std::lround(128 + amplitude * std::sin(2 * PI * frequency * n / SAMPLING_RATE)));
+	}
+	return signal;
+}
+
+static double windowValue(int32_t windowType, int32_t n)
+{
+	switch (windowType) {
+	case STFT::WINDOW_HANN: return 0.5 - 0.5 * std::cos(2 * PI * n / N);
+	case STFT::WINDOW_HAMMING: return 0.54 - 0.46 * std::cos(2 * PI * n / N);
+	default: return 1.0;
+	}
+}
+
+/* Max |error| of the magnitude ( every 5 bins ) against the DFT of signal[sampleIndex, sampleIndex + N) */
+static double frameError(const STFT::FRAME& frame, const std::vector<uint8_t>& signal, int32_t windowType, float gain)
+{
+	double maxError = 0;
+	for (int32_t k = 0; k < N / 2; k += 5) {
+		double re = 0;
+		double im = 0;
+		for (int32_t n = 0; n < N; n++) {
+			const double value = (signal[frame.sampleIndex + n] - 128) / 128.0 * windowValue(windowType, n);
+			re += value * std::cos(2 * PI * k * n / N);
+			im -= value * std::sin(2 * PI * k * n / N);
+		}
+		maxError = std::max(maxError, std::fabs(gain * std::hypot(re, im) / N - frame.magnitude[k]));
+	}
+	return maxError;
+}
+
+static int32_t peakBin(const STFT::FRAME& frame)
+{
+	int32_t peak = 1;
+	for (int32_t k = 1; k < N / 2; k++) {
+		if (frame.magnitude[k] > frame.magnitude[peak]) peak = k;
+	}
+	return peak;
+}
+
+static void testTone(int32_t hopSize, int32_t windowType, double frequency)
+{
+	constexpr float GAIN = 8.0f;
+	STFT stft;
+	STFT::CONFIG config = { hopSize, windowType, GAIN };
+	CHECK(stft.initialize(config) == STFT::RET_OK, "initialize");
+	static RingBuffer<STFT::FRAME> ring;
+	ring.initialize(8, 1);		// a chunk makes 7 frames at most
+
+	const int32_t sampleNum = N * 40 + 77;
+	const std::vector<uint8_t> signal = generateTone(sampleNum, frequency, 100);
+	const int32_t expectedBin = static_cast<int32_t>(std::lround(frequency * N / SAMPLING_RATE));
+	std::mt19937 rng(hopSize + windowType);
+	std::uniform_int_distribution<int32_t> chunkDist(1, 700);
+	uint32_t expectedSequence = 0;
+	int32_t reportedFrameNum = 0;
+	double worstError = 0;
+	for (int32_t fedNum = 0; fedNum < sampleNum; ) {
+		const int32_t chunk = std::min(chunkDist(rng), sampleNum - fedNum);
+		reportedFrameNum += stft.process(signal.data() + fedNum, chunk, ring);
+		fedNum += chunk;
+		while (!ring.isUnderflow()) {
+			const STFT::FRAME* frame = ring.referPtr(0);
+			CHECK(frame->sequence == expectedSequence, "sequence %u (expected %u)", frame->sequence, expectedSequence);
+			CHECK(frame->sampleIndex == expectedSequence * hopSize, "sampleIndex %u (expected %u)", frame->sampleIndex, expectedSequence * hopSize);
+			const int32_t peak = peakBin(*frame);
+			CHECK(peak == expectedBin, "hop %d, window %d, %.1f Hz: peak bin %d (expected %d)", hopSize, windowType, frequency, peak, expectedBin);
+			if (expectedSequence % 7 == 3) {
+				const double error = frameError(*frame, signal, windowType, GAIN) / frame->magnitude[peak];
+				CHECK(error < 1e-3, "frame %u: error / peak = %.2e", frame->sequence, error);
+				worstError = std::max(worstError, error);
+			}
+			expectedSequence++;
+			ring.readPtr();
+		}
+	}
+
+	const uint32_t expectedFrameNum = (sampleNum - N) / hopSize + 1;
+	CHECK(expectedSequence == expectedFrameNum && reportedFrameNum == static_cast<int32_t>(expectedFrameNum) && stft.getFrameNum() == expectedFrameNum
+		&& stft.getDroppedFrameNum() == 0, "frames %u, reported %d (expected %u)", expectedSequence, reportedFrameNum, expectedFrameNum);
+	printf("hop %3d, window %d, %7.1f Hz: %3u frames, peak on bin %3d, error / peak <= %.1e\n", hopSize, windowType, frequency, expectedSequence, expectedBin, worstError);
+}
+
+static void testDropAndReset()
+{
+	STFT stft;
+	STFT::CONFIG config = { N / 2, STFT::WINDOW_HANN, 1.0f };
+	CHECK(stft.initialize(config) == STFT::RET_OK, "initialize");
+	static RingBuffer<STFT::FRAME> ring;
+	ring.initialize(3, 1);
+	const std::vector<uint8_t> signal = generateTone(N * 8, 1000, 50);
+
+	/* 7 frames into 3 slots */
+	const int32_t frameNum = stft.process(signal.data(), N * 4, ring);
+	CHECK(frameNum == 7 && stft.getDroppedFrameNum() == 4 && ring.getStoredDataNum() == 3, "drop: frames %d, dropped %u, stored %d",
+		frameNum, stft.getDroppedFrameNum(), ring.getStoredDataNum());
+	for (uint32_t sequence = 0; sequence < 3; sequence++) {
+		CHECK(ring.readPtr()->sequence == sequence, "drop: sequence of the stored frame");
+	}
+	stft.process(signal.data() + N * 4, N / 2, ring);
+	CHECK(ring.getStoredDataNum() == 1 && ring.referPtr(0)->sequence == 7 && ring.referPtr(0)->sampleIndex == 7 * N / 2, "drop: the next frame");
+	ring.readPtr();
+
+	/* reset() in the middle of a window: the samples fed so far are N * 4 + N / 2 + 100 */
+	stft.process(signal.data() + N * 4 + N / 2, 100, ring);
+	stft.reset();
+	const uint32_t resetIndex = N * 4 + N / 2 + 100;
+	CHECK(stft.process(signal.data() + resetIndex, N - 1, ring) == 0, "reset: the window must start again");
+	CHECK(stft.process(signal.data() + resetIndex + N - 1, 1, ring) == 1, "reset: a frame after N samples");
+	const STFT::FRAME* frame = ring.referPtr(0);
+	CHECK(frame->sequence == 8 && frame->sampleIndex == resetIndex, "reset: sequence %u (expected 8), sampleIndex %u (expected %u)",
+		frame->sequence, frame->sampleIndex, resetIndex);
+	CHECK(frameError(*frame, signal, STFT::WINDOW_HANN, 1.0f) < 1e-3 * frame->magnitude[peakBin(*frame)], "reset: the frame is not of the window at sampleIndex");
+	printf("drop: 7 frames into 3 slots, dropped %u. reset: the next frame is sequence %u at sample %u\n",
+		stft.getDroppedFrameNum(), frame->sequence, frame->sampleIndex);
+
+	STFT invalid;
+	STFT::CONFIG tooSmall = { 0, STFT::WINDOW_HANN, 1.0f };
+	STFT::CONFIG tooLarge = { N + 1, STFT::WINDOW_HANN, 1.0f };
+	STFT::CONFIG unknownWindow = { N / 2, 9, 1.0f };
+	CHECK(invalid.initialize(tooSmall) == STFT::RET_ERR && invalid.initialize(tooLarge) == STFT::RET_ERR && invalid.initialize(unknownWindow) == STFT::RET_ERR,
+		"invalid config is accepted");
+}
+
+/* The writer is paced by ADC ( one buffer at a time ), and the reader reads the frames on the other thread */
+static void testThreads()
+{
+	constexpr int32_t HOP_SIZE = N / 4;
+	static STFT stft;
+	STFT::CONFIG config = { HOP_SIZE, STFT::WINDOW_HAMMING, 8.0f };
+	stft.initialize(config);
+	static RingBuffer<STFT::FRAME> ring;
+	ring.initialize(4, 1);
+	const int32_t sampleNum = N * 3000;
+	std::vector<uint8_t> signal(sampleNum);
+	for (int32_t n = 0; n < sampleNum; n++) {
+		signal[n] = static_cast<uint8_t>(std::lround(128 + 100 * std::sin(2 * PI * ((n / N) % 200 * 20 + 100) * n / SAMPLING_RATE)));
+	}
+
+	std::atomic<bool> isDone(false);
+	uint32_t receivedNum = 0;
+	uint32_t gapNum = 0;
+	uint32_t lastSequence = UINT32_MAX;
+	bool isOrdered = true;
+	std::thread reader([&]() {
+		while (true) {
+			const bool isLast = isDone.load();
+			while (!ring.isUnderflow()) {
+				const STFT::FRAME* frame = ring.referPtr(0);
+				if (lastSequence != UINT32_MAX) {
+					if (frame->sequence <= lastSequence) isOrdered = false;
+					gapNum += frame->sequence - lastSequence - 1;
+				}
+				if (frame->sampleIndex != frame->sequence * HOP_SIZE) isOrdered = false;
+				lastSequence = frame->sequence;
+				receivedNum++;
+				ring.readPtr();
+			}
+			if (isLast) break;
+			std::this_thread::yield();
+		}
+	});
+	for (int32_t fedNum = 0; fedNum < sampleNum; fedNum += N) {
+		stft.process(signal.data() + fedNum, N, ring);
+		if ((fedNum / N) % 2) std::this_thread::yield();
+	}
+	isDone = true;
+	reader.join();
+
+	const uint32_t frameNum = stft.getFrameNum();
+	CHECK(isOrdered && receivedNum + stft.getDroppedFrameNum() == frameNum && gapNum + (frameNum - 1 - lastSequence) == stft.getDroppedFrameNum(),
+		"threads: received %u, dropped %u, frames %u, gaps %u", receivedNum, stft.getDroppedFrameNum(), frameNum, gapNum);
+	printf("threads: %u frames, received %u, dropped %u ( = gaps in the sequence ), no duplicate\n", frameNum, receivedNum, stft.getDroppedFrameNum());
+}
+
+int main()
+{
+	for (int32_t hopSize : { N / 2, N / 4 }) {
+		for (int32_t windowType : { STFT::WINDOW_RECTANGULAR, STFT::WINDOW_HANN, STFT::WINDOW_HAMMING }) {
+			for (double frequency : { 468.75, 1015.625, 3300.78125 }) testTone(hopSize, windowType, frequency);
+		}
+	}
+	testTone(N, STFT::WINDOW_HANN, 2000);
+	testTone(100, STFT::WINDOW_HAMMING, 1234.375);
+	testDropAndReset();
+	testThreads();
+	printf("%s\n", s_errorNum == 0 ? "PASSED" : "FAILED");
+	return s_errorNum == 0 ? 0 : 1;
+}
@@ -36,27 +36,84 @@ static void dma_handler() {
     AdcBuffer::irq_handler_static_();
 }
 
+void AdcDma::Initialize(enum dma_channel_transfer_size transfer_size, int32_t transfer_count) {
+    dma_channel_[0] = dma_claim_unused_channel(true);
+    dma_channel_[1] = dma_claim_unused_channel(true);
+
+    for (int32_t i = 0; i < 2; i++) {
+        dma_channel_config config = dma_channel_get_default_config(dma_channel_[i]);
+        // Reading from constant address, writing to incrementing addresses
+        channel_config_set_transfer_data_size(&config, transfer_size);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        // Pace transfers based on availability of ADC samples
+        channel_config_set_dreq(&config, DREQ_ADC);
+        // Trigger the other channel when finished
+        channel_config_set_chain_to(&config, dma_channel_[i ^ 1]);
+        dma_channel_configure(dma_channel_[i], &config,
+            nullptr,        // dst (set by SetWriteAddress)
+            &adc_hw->fifo,  // src
+            transfer_count, // transfer count (reloaded at every trigger)
+            false           // don't start yet
+        );
+    }
+}
+
+void AdcDma::Finalize() {
+    for (int32_t i = 0; i < 2; i++) {
+        if (dma_channel_[i] >= 0) {
+            dma_channel_unclaim(dma_channel_[i]);
+            dma_channel_[i] = -1;
+        }
+    }
+}
+
+void AdcDma::SetWriteAddress(int32_t channel_index, void* dst) {
+    dma_channel_set_write_addr(dma_channel_[channel_index], dst, false);
+}
+
+void AdcDma::Start() {
+    dma_hw->ints0 = (1u << dma_channel_[0]) | (1u << dma_channel_[1]);    // clear the interrupt requests left by the last abort
+    dma_channel_start(dma_channel_[0]);
+}
+
+void AdcDma::Abort() {
+    /* Abort both at once, otherwise the aborted channel may trigger the other by chain */
+    const uint32_t mask = (1u << dma_channel_[0]) | (1u << dma_channel_[1]);
+    dma_hw->abort = mask;
+    while (dma_hw->abort & mask) tight_loop_contents();
+}
+
 void AdcBuffer::IrqHandler() {
-    /* Clear the interrupt request. */
-    dma_hw->ints0 = 1u << dma_channel_;
     // PRINT_TIME();
     // PRINT("dma_handler\n");
-
-    /* Restart DMS */
-    uint8_t* p = adc_block_buffer_.WritePtr();
-    if (p == nullptr) {
-        // PRINT_E("AdcBuffer: overflow\n");
-        p = adc_block_buffer_.GetLatestWritePtr();
+    /* No need to restart DMA (the other channel is already running). Just commit the finished block and set the next block */
+    if (sample_bits_ == 12) {
+        HandleFinishedBlocks(capture16_, adc_block_buffer16_);
+    } else {
+        HandleFinishedBlocks(capture_, adc_block_buffer_);
     }
-    dma_channel_configure(dma_channel_, &dma_config_,
-        p,              // dst
-        &adc_hw->fifo,  // src
-        capture_depth_, // transfer count
-        true            // start immediately
-    );
+}
 
+template<class T>
+void AdcBuffer::HandleFinishedBlocks(PingPongCapture<T>& capture, const RingBlockBuffer<T>& ring_buffer) {
+    /* Both channels may have finished if the IRQ has been delayed. Handle them in the order of finish */
+    while (true) {
+        const uint32_t mask = 1u << dma_.dma_channel(capture.next_channel_index());
+        if ((dma_hw->ints0 & mask) == 0) break;
+        dma_hw->ints0 = mask;   // Clear the interrupt request
+        if (capture.OnBlockFinished(time_us_64())) {
+            UpdateMaxStoredDataNum(ring_buffer.stored_data_num());
+        } else {
+            CountOverrun();
+        }
+    }
 }
 
+void AdcBuffer::SetIrqEnabled(bool enabled) {
+    dma_channel_set_irq0_enabled(dma_.dma_channel(0), enabled);
+    dma_channel_set_irq0_enabled(dma_.dma_channel(1), enabled);
+}
 
 int32_t AdcBuffer::Initialize(const Config& config) {
     irq_handler_static_ = [this] { IrqHandler(); };
@@ -65,9 +122,20 @@ int32_t AdcBuffer::Initialize(const Config& config) {
     capture_channel_ = config.capture_channel;
     capture_depth_ = config.capture_depth;
     sampling_rate_ = config.sampling_rate;
+    sample_bits_ = config.sample_bits;
+    if (sample_bits_ != 8 && sample_bits_ != 12) {
+        PRINT_E("sample_bits must be 8 or 12: %d\n", sample_bits_);
+        return kRetErr;
+    }
 
     /* Reset buffer */
-    adc_block_buffer_.Initialize(buffer_num_, capture_depth_);
+    if (sample_bits_ == 12) {
+        adc_block_buffer16_.Initialize(buffer_num_, capture_depth_);
+        capture16_.Initialize(&adc_block_buffer16_, &dma_);
+    } else {
+        adc_block_buffer_.Initialize(buffer_num_, capture_depth_);
+        capture_.Initialize(&adc_block_buffer_, &dma_);
+    }
 
     /* Initialize ADC */
     adc_init();
@@ -76,48 +144,47 @@ int32_t AdcBuffer::Initialize(const Config& config) {
     adc_fifo_setup(
         true,    // Write each completed conversion to the sample FIFO
         true,    // Enable DMA data request (DREQ)
-        1,       // DREQ (and IRQ) asserted when at least 1 sample present
-        false,   // We won't see the ERR bit because of 8 bit reads; disable.
-        true     // Shift each sample to 8 bits when pushing to FIFO
+        1,       // DREQ asserted when at least 1 sample present (DMA moves each sample as soon as it arrives)
+        false,   // Don't put the ERR bit into FIFO (keep upper 4 bits zero for 12-bit samples)
+        sample_bits_ == 8   // Shift each sample to 8 bits when pushing to FIFO (keep full 12 bits otherwise)
     );
     adc_set_clkdiv(ADC_CLOCK / sampling_rate_);
 
-    /* Initialize DMA */
-    // Set up the DMA to start transferring data as soon as it appears in FIFO
-    dma_channel_ = dma_claim_unused_channel(true);
-    dma_config_ = dma_channel_get_default_config(dma_channel_);
+    /* Initialize DMA (byte transfer, or halfword transfer for 12-bit samples) */
+    dma_.Initialize(sample_bits_ == 12 ? DMA_SIZE_16 : DMA_SIZE_8, capture_depth_);
 
-    // Reading from constant address, writing to incrementing byte addresses
-    channel_config_set_transfer_data_size(&dma_config_, DMA_SIZE_8);
-    channel_config_set_read_increment(&dma_config_, false);
-    channel_config_set_write_increment(&dma_config_, true);
-
-    // Pace transfers based on availability of ADC samples
-    channel_config_set_dreq(&dma_config_, DREQ_ADC);
-
-    /* Initialize IRQ for DMA */
-    /* Manually call IRQ handler to config DMA */
-    dma_handler();
-
-    dma_channel_set_irq0_enabled(dma_channel_, true);
-    irq_set_exclusive_handler(DMA_IRQ_0 + dma_channel_, dma_handler);
-    irq_set_enabled(DMA_IRQ_0 + dma_channel_, true);
+    /* Initialize IRQ for DMA (both channels use DMA_IRQ_0) */
+    irq_set_exclusive_handler(DMA_IRQ_0, dma_handler);
+    irq_set_enabled(DMA_IRQ_0, true);
 
     return kRetOk;
 }
 
 int32_t AdcBuffer::Finalize(void) {
+    dma_.Finalize();
+    capture_.Finalize();
+    capture16_.Finalize();
+    adc_block_buffer_.Finalize();
+    adc_block_buffer16_.Finalize();
     return kRetOk;
 }
 
 int32_t AdcBuffer::Start(void) {
+    /* DMA waits for DREQ until ADC starts */
+    SetIrqEnabled(true);
+    if (sample_bits_ == 12) {
+        capture16_.Start();
+    } else {
+        capture_.Start();
+    }
     adc_run(true);
     return kRetOk;
 }
 
 int32_t AdcBuffer::Stop(void) {
-    dma_channel_wait_for_finish_blocking(dma_channel_);
     adc_run(false);
+    SetIrqEnabled(false);
+    dma_.Abort();
     adc_fifo_drain();
     return kRetOk;
 }
@@ -125,3 +192,7 @@ int32_t AdcBuffer::Stop(void) {
 RingBlockBuffer<uint8_t>& AdcBuffer::GetRingBlockBuffer(void) {
     return adc_block_buffer_;
 }
+
+RingBlockBuffer<uint16_t>& AdcBuffer::GetRingBlockBuffer16(void) {
+    return adc_block_buffer16_;
+}
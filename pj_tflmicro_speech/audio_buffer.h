@@ -17,6 +17,7 @@ limitations under the License.
 #define AUDIO_BUFFER_H_
 
 #include <cstdint>
+#include <algorithm>
 #include "ring_block_buffer.h"
 
 class AudioBuffer {
@@ -31,14 +32,41 @@ public:
         int32_t capture_channel;
         int32_t capture_depth;  /* = block size */
         int32_t sampling_rate;
+        int32_t sample_bits;    /* 8: uint8_t samples in GetRingBlockBuffer(), 12: uint16_t samples (0 - 4095) in GetRingBlockBuffer16() */
     } Config;
 
+    /* Counters to see how often audio is dropped. They are kept over Finalize/Initialize (cleared only by ResetStats) */
+    typedef struct {
+        uint32_t overrun_num;           /* blocks dropped because the ring block buffer was full (producer side) */
+        uint32_t underrun_num;          /* requests for audio which had not been captured yet (consumer side) */
+        uint32_t resync_num;            /* requests for audio which had already been discarded. The consumer needs to start over (consumer side) */
+        int32_t max_stored_data_num;    /* worst-case occupancy of the ring block buffer [blocks] */
+    } Stats;
+
 public:
+    AudioBuffer() : stats_() {}
+    virtual ~AudioBuffer() {}
+
     virtual int32_t Initialize(const Config& config) = 0;
     virtual int32_t Finalize(void) = 0;
     virtual int32_t Start(void) = 0;
     virtual int32_t Stop(void) = 0;
     virtual RingBlockBuffer<uint8_t>& GetRingBlockBuffer(void) = 0;
+    virtual RingBlockBuffer<uint16_t>& GetRingBlockBuffer16(void) = 0;
+
+    /* Each counter is updated only by one side, so they can be read without lock (a value may be one update old) */
+    const Stats& GetStats(void) const { return stats_; }
+    void ResetStats(void) { stats_ = Stats(); }
+    void CountUnderrun(void) { stats_.underrun_num++; }
+    void CountResync(void) { stats_.resync_num++; }
+
+protected:
+    /* Called by the producer */
+    void CountOverrun(void) { stats_.overrun_num++; }
+    void UpdateMaxStoredDataNum(int32_t stored_data_num) { stats_.max_stored_data_num = std::max(stats_.max_stored_data_num, stored_data_num); }
+
+private:
+    Stats stats_;
 };
 
 #endif  // AUDIO_BUFFER_H_
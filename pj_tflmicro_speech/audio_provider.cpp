@@ -19,12 +19,15 @@ limitations under the License.
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 
 #include "utility_macro.h"
+#include "sample_converter.h"
 
 #ifdef BUILD_ON_PC
 #include "test_buffer.h"
 #else
+#include "pico/stdlib.h"
 #include "adc_buffer.h"
 #endif
 
@@ -41,14 +44,17 @@ limitations under the License.
 
 /*** FUNCTION ***/
 int32_t AudioProvider::Initialize() {
-    time_ms_at_index0_ = 0;
-    valid_data_num_ = 0;
+    next_sample_index_ = 0;
+    oldest_sample_index_ = 0;
 
+    /* Reuse AudioBuffer at re-initialization to keep the stats */
+    if (!audio_buffer_) {
 #ifdef USE_TEST_BUFFER
-    audio_buffer_ = std::unique_ptr<AudioBuffer>(new TestBuffer());
+        audio_buffer_ = std::unique_ptr<AudioBuffer>(new TestBuffer());
 #else
-    audio_buffer_ = std::unique_ptr<AudioBuffer>(new AdcBuffer());
+        audio_buffer_ = std::unique_ptr<AudioBuffer>(new AdcBuffer());
 #endif
+    }
     if (!audio_buffer_) {
         PRINT_E("AudioBuffer null\n");
         return kRetErr;
@@ -59,6 +65,7 @@ int32_t AudioProvider::Initialize() {
     audio_buffer_config.capture_channel = 0;
     audio_buffer_config.capture_depth = kBlockSize;
     audio_buffer_config.sampling_rate = kSamplingRate;
+    audio_buffer_config.sample_bits = sample_bits_;
     if (audio_buffer_->Initialize(audio_buffer_config) != AudioBuffer::kRetOk) {
         PRINT_E("AudioBuffer Initialize\n");
         return kRetErr;
@@ -86,69 +93,148 @@ int32_t AudioProvider::Finalize() {
 int32_t AudioProvider::GetAudioSamples(
     int32_t start_time_ms, int32_t duration_time_ms,
     int32_t* audio_samples_size, int16_t** audio_samples) {
-    auto& ring_buffer = audio_buffer_->GetRingBlockBuffer();
-
-    int32_t time_ms_at_end = time_ms_at_index0_ + valid_data_num_ / kSamplePerMs;
-    if (start_time_ms < time_ms_at_index0_) {
-        /* target data is not recorded yet */
-    } else if (time_ms_at_index0_ <= start_time_ms && start_time_ms < time_ms_at_end) {
-        /* (a part of) target data is already stored in the local buffer */
-        /*   1. remove unnecessary data and move the target data to the beginning of the local buffer */
-        int32_t start_index_local_buffer = (start_time_ms - time_ms_at_index0_) * kSamplePerMs;
-        time_ms_at_index0_ = start_time_ms;
-        valid_data_num_ -= start_index_local_buffer;
-        memmove(&local_buffer_[0], &local_buffer_[start_index_local_buffer], valid_data_num_ * sizeof(int16_t));
-
-        /*   2. copy the rest data from the ring buffer with format conversion (if there is data in the ring buffer and if there is enough space in the local buffer */
-        // while (!ring_buffer.IsUnderflow() && valid_data_num_ <= kBlockSize) {
-        while (ring_buffer.stored_data_num() > 1 && valid_data_num_ <= kBlockSize) {        // don't use IsUnderflow because "stored_data_num==1" also means underflow (the data on WP is currently written by DMA)
-            const auto& block = ring_buffer.Read();
-            for (const auto& data : block) {
-                if (valid_data_num_ >= kBlockSize * 2) {
-                    PRINT("[AudioProvider::initialize] shouldn't reach here\n");
-                    break;
-                }
-                local_buffer_[valid_data_num_] = (static_cast<int16_t>(data) - 128) * 256;	// uint8_t (0 - 255) -> int16_t (-32768 - 32767)
-                //local_buffer_[valid_data_num_] = (static_cast<int16_t>(data) - 0) * 1;	// uint8_t (0 - 255) -> int16_t (-32768 - 32767)
-                valid_data_num_++;
-            }
+    /* 64-bit to avoid overflow. The result is exact as long as a sample falls on each msec (e.g. 16kHz) */
+    const int64_t start_sample_index = static_cast<int64_t>(start_time_ms) * kSamplingRate / 1000;
+    const int32_t sample_num = static_cast<int32_t>(static_cast<int64_t>(duration_time_ms) * kSamplingRate / 1000);
+    return GetAudioSamplesByIndex(start_sample_index, sample_num, audio_samples_size, audio_samples);
+}
+
+int32_t AudioProvider::GetAudioSamplesByIndex(
+    int64_t start_sample_index, int32_t sample_num,
+    int32_t* audio_samples_size, int16_t** audio_samples) {
+    *audio_samples_size = 0;
+    *audio_samples = nullptr;
+    if (start_sample_index >= oldest_sample_index_) {
+        if (sample_bits_ == 12) {
+            ReadBlocks(audio_buffer_->GetRingBlockBuffer16(), start_sample_index);
+        } else {
+            ReadBlocks(audio_buffer_->GetRingBlockBuffer(), start_sample_index);
         }
-    } else {
-        /* target data is not stored in the local buffer yet */
-        valid_data_num_ = 0;
-        // while (!ring_buffer.IsUnderflow() && valid_data_num_ <= kBlockSize) {
-        while (ring_buffer.stored_data_num() > 1 && valid_data_num_ <= kBlockSize) {        // don't use IsUnderflow because "stored_data_num==1" also means underflow (the data on WP is currently written by DMA)
-            int32_t time_rp_ms = ring_buffer.accumulated_read_data_num() * kDurationPerBlock;
-            const auto& block = ring_buffer.Read();
-            if (time_rp_ms <= start_time_ms && start_time_ms < time_rp_ms + kDurationPerBlock) {
-                for (const auto& data : block) {
-                    if (valid_data_num_ >= kBlockSize * 2) {
-                        PRINT("[AudioProvider::initialize] shouldn't reach here\n");
-                        break;
-                    }
-                    local_buffer_[valid_data_num_] = (static_cast<int16_t>(data) - 128) * 256;	// uint8_t (0 - 255) -> int16_t (-32768 - 32767)
-                    //local_buffer_[valid_data_num_] = (static_cast<int16_t>(data) - 0) * 1;	// uint8_t (0 - 255) -> int16_t (-32768 - 32767)
-                    valid_data_num_++;
-                }
-                time_ms_at_index0_ = time_rp_ms;
-                GetAudioSamples(start_time_ms, duration_time_ms, audio_samples_size, audio_samples);    // todo: better to avoid recursive call
-                break;
-            }
+    }
+    if (start_sample_index < oldest_sample_index_) {
+        /* target data is already discarded (or lost by overrun) */
+        PRINT_E("sample %lld is already discarded\n", static_cast<long long>(start_sample_index));
+        audio_buffer_->CountResync();
+        return kRetErr;
+    }
+
+    if (start_sample_index < next_sample_index_) {
+        *audio_samples_size = static_cast<int32_t>(std::min(next_sample_index_ - start_sample_index, static_cast<int64_t>(kMaxWindowSize)));
+        *audio_samples = &sample_ring_[start_sample_index & (kSampleRingSize - 1)];
+    }
+    if (*audio_samples_size < std::min(sample_num, kMaxWindowSize)) {
+        audio_buffer_->CountUnderrun();
+    }
+    return kRetOk;
+}
+
+template<class T>
+void AudioProvider::ReadBlocks(RingBlockBuffer<T>& ring_buffer, int64_t start_index) {
+    /* blocks in the ring block buffer are always complete (the block being written by DMA is only reserved, not committed yet) */
+    const int32_t stored_data_num = ring_buffer.stored_data_num();
+    if (start_index >= next_sample_index_ && stored_data_num > 0) {
+        /* skip blocks which end before the target data without conversion. The position is calculated from the stamp */
+        const int64_t block_num_to_skip = (start_index - static_cast<int64_t>(ring_buffer.ReferStamp(0).sample_index)) / kBlockSize;
+        int32_t pos = static_cast<int32_t>(std::max(static_cast<int64_t>(0), std::min(block_num_to_skip, static_cast<int64_t>(stored_data_num))));
+        /* if some blocks have been dropped, the blocks after them start later than calculated. Step back to the block containing the target */
+        while (pos > 0 && static_cast<int64_t>(ring_buffer.ReferStamp(pos - 1).sample_index) + kBlockSize > start_index) pos--;
+        for (int32_t i = 0; i < pos; i++) {
+            (void)ring_buffer.ReadPtr();
         }
     }
 
-    *audio_samples_size = valid_data_num_;
-    *audio_samples = local_buffer_;
+    /* convert blocks until the window is filled or the ring block buffer becomes empty */
+    while (next_sample_index_ < start_index + kMaxWindowSize && ring_buffer.stored_data_num() > 0) {
+        const int64_t block_sample_index = static_cast<int64_t>(ring_buffer.ReferStamp(0).sample_index);
+        if (block_sample_index != next_sample_index_) {
+            /* the block is not contiguous with the stored samples (skipped or dropped blocks). Start over from the block */
+            next_sample_index_ = block_sample_index;
+            oldest_sample_index_ = next_sample_index_;
+        }
+        StoreBlock(ring_buffer.ReadPtr());
+    }
+}
 
-    return kRetOk;
+template<class T>
+void AudioProvider::StoreBlock(const T* block) {
+    /* a block is split into two parts when it straddles the end of sample_ring_ */
+    for (int32_t stored_num = 0; stored_num < kBlockSize; ) {
+        const int32_t pos = static_cast<int32_t>((next_sample_index_ + stored_num) & (kSampleRingSize - 1));
+        const int32_t num = std::min(kBlockSize - stored_num, kSampleRingSize - pos);
+        ConvertSamples(block + stored_num, &sample_ring_[pos], num);
+        if (pos < kMaxWindowSize) {
+            memcpy(&sample_ring_[kSampleRingSize + pos], &sample_ring_[pos], std::min(num, kMaxWindowSize - pos) * sizeof(int16_t));
+        }
+        stored_num += num;
+    }
+    next_sample_index_ += kBlockSize;
+    oldest_sample_index_ = std::max(oldest_sample_index_, next_sample_index_ - kSampleRingSize);
+}
+
+void AudioProvider::ConvertSamples(const uint8_t* src, int16_t* dst, int32_t num) {
+    SampleConverter::ConvertU8ToS16(src, dst, num);     // uint8_t (0 - 255) -> int16_t (-32768 - 32767)
+}
+
+void AudioProvider::ConvertSamples(const uint16_t* src, int16_t* dst, int32_t num) {
+    SampleConverter::ConvertU12ToS16(src, dst, num);    // uint16_t (0 - 4095) -> int16_t (-32768 - 32752)
 }
 
 int32_t AudioProvider::GetLatestAudioTimestamp() {
-    auto& ring_buffer = audio_buffer_->GetRingBlockBuffer();
-    int32_t time_wp_ms = ring_buffer.accumulated_stored_data_num() - 1;     // need -1, because the data on WP is currently written by DMA
-    time_wp_ms -= 1;    // use the beginning time of the block (to work with feature_privider logic to calculate slices_needed)
-    time_wp_ms *= kDurationPerBlock;
-    return time_wp_ms;
+    /* the beginning time of the latest window (to work with feature_privider logic to calculate slices_needed) */
+    const int64_t window_start_index = GetLatestSampleIndex() - kWindowSampleNum;
+    if (window_start_index < 0) return -1;
+    return static_cast<int32_t>(window_start_index * 1000 / kSamplingRate);
+}
+
+int64_t AudioProvider::GetLatestSampleIndex() {
+    if (sample_bits_ == 12) {
+        return GetLatestSampleIndex(audio_buffer_->GetRingBlockBuffer16());
+    } else {
+        return GetLatestSampleIndex(audio_buffer_->GetRingBlockBuffer());
+    }
+}
+
+template<class T>
+int64_t AudioProvider::GetLatestSampleIndex(RingBlockBuffer<T>& ring_buffer) {
+    /* the newest block is not overwritten until it's read, and only this consumer reads it */
+    const int32_t stored_data_num = ring_buffer.stored_data_num();
+    if (stored_data_num == 0) return next_sample_index_;
+    return static_cast<int64_t>(ring_buffer.ReferStamp(stored_data_num - 1).sample_index) + kBlockSize;
+}
+
+const AudioBuffer::Stats& AudioProvider::GetStats() const {
+    return audio_buffer_->GetStats();
+}
+
+void AudioProvider::ResetStats() {
+    audio_buffer_->ResetStats();
+}
+
+void AudioProvider::PrintStats() {
+    const AudioBuffer::Stats& stats = audio_buffer_->GetStats();
+    PRINT("overrun = %u, underrun = %u, resync = %u, max occupancy = %d / %d blocks\n",
+        static_cast<unsigned int>(stats.overrun_num), static_cast<unsigned int>(stats.underrun_num), static_cast<unsigned int>(stats.resync_num),
+        stats.max_stored_data_num, kBufferSize);
+}
+
+void AudioProvider::HandleStatsCommand(int32_t current_time) {
+    /* the time goes back to 0 after re-initialization */
+    if (current_time < stats_previous_time_) stats_previous_time_ = current_time;
+#ifdef BUILD_ON_PC
+    if (current_time - stats_previous_time_ < kStatsIntervalMs) return;
+    stats_previous_time_ = current_time;
+    PrintStats();
+#else
+    /* getchar_timeout_us takes the stdio lock (and USB stdio task), so it's not called in every loop */
+    if (current_time - stats_previous_time_ < kStatsPollIntervalMs) return;
+    stats_previous_time_ = current_time;
+    const int32_t key = getchar_timeout_us(0);
+    if (key == 's') {
+        PrintStats();
+    } else if (key == 'r') {
+        ResetStats();
+    }
+#endif
 }
 
 void AudioProvider::DebugWriteData(int32_t updated_time_duration) {
@@ -170,11 +256,11 @@ void testAudioProvider(void) {
 
         audio_provider.GetLatestAudioTimestamp();
         audio_provider.GetAudioSamples(start_time, 30, &audio_samples_size, &audio_samples);
-        PRINT("%d: %d\n", start_time, audio_samples[0]);
         if (audio_samples_size < 512) {
             PRINT_E("audio_samples_size = %d\n", audio_samples_size);
             //HALT();
         } else {
+            PRINT("%d: %d\n", start_time, audio_samples[0]);
             for (int32_t i = 0; i < 512; i++) {
                 int16_t expected_value = (start_time * 16 + i) % 16000;
                 expected_value = (expected_value - 128) * 256;
@@ -32,35 +32,76 @@ public:
 
 private:
     static constexpr int32_t kSamplingRate = 16000;
-    static constexpr int32_t kBlockSize = 512;
-    static constexpr int32_t kBufferSize = 10;
-    static constexpr int32_t kSamplePerMs = kSamplingRate / 1000;           // 16 sample = 1msec
-    static constexpr int32_t kDurationPerBlock = kBlockSize / kSamplePerMs; // 32msec
+    static constexpr int32_t kBlockSize = 512;                              // any size (not need to be integer msec)
+    static constexpr int32_t kBufferSize = 16;                             // 2^x (RingBlockBuffer uses mask to calculate index). 8 KB of blocks (16 KB in 12-bit mode)
+    static constexpr int32_t kWindowSampleNum = 512;                        // samples needed after the latest timestamp (= kMaxAudioSampleSize of FeatureProvider)
+    static constexpr int32_t kSampleRingSize = 2048;                        // 2^x
+    static constexpr int32_t kMaxWindowSize = 1024;                         // max samples returned at once (= size of the mirrored guard region)
+    static_assert((kSampleRingSize & (kSampleRingSize - 1)) == 0, "kSampleRingSize must be 2^x");
+    static_assert(kMaxWindowSize + kBlockSize <= kSampleRingSize, "kSampleRingSize is too small");
+    static constexpr int32_t kStatsIntervalMs = 10 * 1000;                  // stats are printed periodically on PC
+    static constexpr int32_t kStatsPollIntervalMs = 200;                    // stdio is polled for a stats command at most once in this period
 
 public:
-    AudioProvider()
-        : audio_buffer_(nullptr)
-        , time_ms_at_index0_(0)
-        , valid_data_num_(0) {
-        memset(local_buffer_, 0, sizeof(local_buffer_));
+    /* sample_bits: 8 or 12 (ADC resolution to be captured) */
+    explicit AudioProvider(int32_t sample_bits = 8)
+        : sample_bits_(sample_bits)
+        , audio_buffer_(nullptr)
+        , next_sample_index_(0)
+        , oldest_sample_index_(0)
+        , stats_previous_time_(0) {
+        memset(sample_ring_, 0, sizeof(sample_ring_));
     }
     ~AudioProvider() {}
 
     int32_t Initialize();
     int32_t Finalize();
+    /* Returns a view of the audio samples from start_time_ms. No copy is made, so the view is valid until the next call */
+    /* audio_samples_size is the number of contiguous samples available from start_time_ms (max = kMaxWindowSize) */
     int32_t GetAudioSamples(
         int32_t start_time_ms,
         int32_t duration_time_ms,
         int32_t* audio_samples_size,
         int16_t** audio_samples);
+    /* The same as GetAudioSamples, but audio is addressed by sample index (0 = the first sample after Initialize) */
+    int32_t GetAudioSamplesByIndex(
+        int64_t start_sample_index,
+        int32_t sample_num,
+        int32_t* audio_samples_size,
+        int16_t** audio_samples);
+    /* The latest time from which kWindowSampleNum samples are available */
     int32_t GetLatestAudioTimestamp();
+    /* The index next to the latest captured sample */
+    int64_t GetLatestSampleIndex();
+    /* Overrun / underrun / resync counters of the capture pipeline (see AudioBuffer::Stats) */
+    const AudioBuffer::Stats& GetStats() const;
+    void ResetStats();
+    void PrintStats();
+    /* Call this in the main loop. Type "s" to show the stats and "r" to reset them over stdio. They are shown periodically on PC */
+    void HandleStatsCommand(int32_t current_time);
     void DebugWriteData(int32_t updated_time_duration);
 
 private:
+    template<class T>
+    void ReadBlocks(RingBlockBuffer<T>& ring_buffer, int64_t start_index);
+    template<class T>
+    int64_t GetLatestSampleIndex(RingBlockBuffer<T>& ring_buffer);
+    template<class T>
+    void StoreBlock(const T* block);
+    static void ConvertSamples(const uint8_t* src, int16_t* dst, int32_t num);
+    static void ConvertSamples(const uint16_t* src, int16_t* dst, int32_t num);
+
+private:
+    int32_t sample_bits_;
     std::unique_ptr<AudioBuffer> audio_buffer_;
-    int16_t local_buffer_[kBlockSize * 2];
-    int32_t time_ms_at_index0_;
-    int32_t valid_data_num_;
+
+    /* Samples are converted to int16_t only once when they are moved from the ring block buffer */
+    /* [kSampleRingSize, kSampleRingSize + kMaxWindowSize) mirrors [0, kMaxWindowSize), so that any window can be referred without wrap around */
+    alignas(4) int16_t sample_ring_[kSampleRingSize + kMaxWindowSize];
+
+    int64_t next_sample_index_;     // sample index (from the start of capture) to be stored next
+    int64_t oldest_sample_index_;   // the oldest sample index available in sample_ring_
+    int32_t stats_previous_time_;   // the time when stats were printed (PC) or stdio was polled (device) last
 };
 
 #endif  // AUDIO_PROVIDER_H_
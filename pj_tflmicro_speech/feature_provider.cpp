@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "feature_provider.h"
 
+#include <cstring>
+
 #include "micro_features/micro_features_generator.h"
 #include "micro_features/micro_model_settings.h"
 
@@ -26,9 +28,24 @@ limitations under the License.
 static int16_t s_audio[16000];
 #endif
 
-FeatureProvider::FeatureProvider(int feature_size, int8_t* feature_data)
+namespace {
+constexpr int kSliceStrideSamples =
+    kFeatureSliceStrideMs * kAudioSampleFrequency / 1000;
+
+// Position of the slice for the time step in the ring of slices. The step can
+// be negative on the first run.
+int SliceRingIndex(int step) {
+  const int index = step % kFeatureSliceCount;
+  return (index < 0) ? (index + kFeatureSliceCount) : index;
+}
+}  // namespace
+
+FeatureProvider::FeatureProvider(int feature_size, int8_t* feature_data,
+                                 bool is_circular)
     : feature_size_(feature_size),
       feature_data_(feature_data),
+      is_circular_(is_circular),
+      oldest_slice_(0),
       is_first_run_(true) {
   // Initialize the feature data to default values.
   for (int n = 0; n < feature_size_; ++n) {
@@ -57,7 +74,8 @@ TfLiteStatus FeatureProvider::PopulateFeatureData(
   int slices_needed = current_step - last_step;
   // If this is the first call, make sure we don't use any cached information.
   if (is_first_run_) {
-    TfLiteStatus init_status = InitializeMicroFeatures(error_reporter);
+    TfLiteStatus init_status = generator_.Initialize(
+        error_reporter, generator_arena_, sizeof(generator_arena_));
     if (init_status != kTfLiteOk) {
       return init_status;
     }
@@ -66,11 +84,19 @@ TfLiteStatus FeatureProvider::PopulateFeatureData(
   }
   if (slices_needed > kFeatureSliceCount) {
     slices_needed = kFeatureSliceCount;
+    // The new slices don't follow the last one, so the overlap kept in the
+    // window is not theirs.
+    generator_.ResetWindow();
   }
   *how_many_new_slices = slices_needed;
 
   const int slices_to_keep = kFeatureSliceCount - slices_needed;
   const int slices_to_drop = kFeatureSliceCount - slices_to_keep;
+  // In circular mode, the slices are kept where they are. Only the new slices
+  // are written over the oldest ones.
+  if (is_circular_) {
+    oldest_slice_ = SliceRingIndex(current_step + 1);
+  }
   // If we can avoid recalculating some slices, just move the existing data
   // up in the spectrogram, to perform something like this:
   // last time = 80ms          current time = 120ms
@@ -83,7 +109,7 @@ TfLiteStatus FeatureProvider::PopulateFeatureData(
   // +-----------+   --        +-----------+
   // | data@80ms | --          |  <empty>  |
   // +-----------+             +-----------+
-  if (slices_to_keep > 0) {
+  if (slices_to_keep > 0 && !is_circular_) {
     for (int dest_slice = 0; dest_slice < slices_to_keep; ++dest_slice) {
       int8_t* dest_slice_data =
           feature_data_ + (dest_slice * kFeatureSliceSize);
@@ -104,37 +130,58 @@ TfLiteStatus FeatureProvider::PopulateFeatureData(
 
   // Any slices that need to be filled in with feature data have their
   // appropriate audio data pulled, and features calculated for that slice.
-  if (slices_needed > 0) {
-    for (int new_slice = slices_to_keep; new_slice < kFeatureSliceCount;
-         ++new_slice) {
-      const int new_step = (current_step - kFeatureSliceCount + 1) + new_slice;
-      const int32_t slice_start_ms = (new_step * kFeatureSliceStrideMs);
-      int16_t* audio_samples = nullptr;
-      int32_t audio_samples_size = 0;
-      // TODO(petewarden): Fix bug that leads to non-zero slice_start_ms
-      audio_provider->GetAudioSamples((slice_start_ms > 0 ? slice_start_ms : 0),
-                      kFeatureSliceDurationMs, &audio_samples_size,
-                      &audio_samples);
-      if (audio_samples_size < kMaxAudioSampleSize) {
-        TF_LITE_REPORT_ERROR(error_reporter,
-                             "Audio data size %d too small, want %d",
-                             audio_samples_size, kMaxAudioSampleSize);
-        return kTfLiteError;
-      }
+  // The consecutive slices in the same contiguous audio span are calculated in
+  // one batch.
+  int new_slice = slices_to_keep;
+  while (new_slice < kFeatureSliceCount) {
+    const int new_step = (current_step - kFeatureSliceCount + 1) + new_slice;
+    const int32_t slice_start_ms = (new_step * kFeatureSliceStrideMs);
+    const int new_slice_index =
+        is_circular_ ? SliceRingIndex(new_step) : new_slice;
+    // The rows of a batch must be contiguous in feature_data_.
+    int max_slices = kFeatureSliceCount - new_slice;
+    if (new_slice_index + max_slices > kFeatureSliceCount) {
+      max_slices = kFeatureSliceCount - new_slice_index;
+    }
+    // TODO(petewarden): Fix bug that leads to non-zero slice_start_ms
+    // The slices before time 0 all start at 0, so they don't make a span.
+    if (slice_start_ms < 0) {
+      max_slices = 1;
+    }
+    int16_t* audio_samples = nullptr;
+    int32_t audio_samples_size = 0;
+    audio_provider->GetAudioSamples((slice_start_ms > 0 ? slice_start_ms : 0),
+                    kFeatureSliceDurationMs, &audio_samples_size,
+                    &audio_samples);
+    if (audio_samples_size < kMaxAudioSampleSize) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Audio data size %d too small, want %d",
+                           audio_samples_size, kMaxAudioSampleSize);
+      return kTfLiteError;
+    }
+    // Each slice needs kMaxAudioSampleSize samples from its start.
+    const int slices_in_span =
+        (audio_samples_size - kMaxAudioSampleSize) / kSliceStrideSamples + 1;
+    if (max_slices > slices_in_span) {
+      max_slices = slices_in_span;
+    }
 
-#ifdef DEBUG_RECORD
-      memcpy(&s_audio[new_slice * 20 * 16], audio_samples, 30 * 16 * sizeof(int16_t));
-#endif
+    int8_t* new_slice_data =
+        feature_data_ + (new_slice_index * kFeatureSliceSize);
+    int num_slices = 0;
+    TfLiteStatus generate_status = generator_.GenerateBatch(
+        error_reporter, audio_samples, audio_samples_size, new_slice_data,
+        max_slices, &num_slices);
+    if (generate_status != kTfLiteOk || num_slices == 0) {
+      return kTfLiteError;
+    }
 
-      int8_t* new_slice_data = feature_data_ + (new_slice * kFeatureSliceSize);
-      size_t num_samples_read;
-      TfLiteStatus generate_status = GenerateMicroFeatures(
-          error_reporter, audio_samples, audio_samples_size, kFeatureSliceSize,
-          new_slice_data, &num_samples_read);
-      if (generate_status != kTfLiteOk) {
-        return generate_status;
-      }
+#ifdef DEBUG_RECORD
+    for (int i = 0; i < num_slices; i++) {
+      memcpy(&s_audio[(new_slice + i) * 20 * 16], audio_samples + i * 20 * 16, 30 * 16 * sizeof(int16_t));
     }
+#endif
+    new_slice += num_slices;
   }
 
 #ifdef DEBUG_RECORD
@@ -149,3 +196,21 @@ TfLiteStatus FeatureProvider::PopulateFeatureData(
 
   return kTfLiteOk;
 }
+
+void FeatureProvider::CopyFeatureData(int8_t* dst) const {
+  const int first_part_size =
+      (kFeatureSliceCount - oldest_slice_) * kFeatureSliceSize;
+  memcpy(dst, feature_data_ + (oldest_slice_ * kFeatureSliceSize),
+         first_part_size);
+  if (oldest_slice_ > 0) {
+    memcpy(dst + first_part_size, feature_data_,
+           oldest_slice_ * kFeatureSliceSize);
+  }
+}
+
+const int8_t* FeatureProvider::GetSliceData(int slice_index) const {
+  const int index = is_circular_
+                        ? SliceRingIndex(oldest_slice_ + slice_index)
+                        : slice_index;
+  return feature_data_ + (index * kFeatureSliceSize);
+}
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 
 #include "audio_provider.h"
+#include "micro_features/micro_features_generator.h"
 
 // Binds itself to an area of memory intended to hold the input features for an
 // audio-recognition neural network model, and fills that data area with the
@@ -34,7 +35,12 @@ class FeatureProvider {
   // remain accessible for the lifetime of the provider object, since subsequent
   // calls will fill it with feature data. The provider does no memory
   // management of this data.
-  FeatureProvider(int feature_size, int8_t* feature_data);
+  // If is_circular is true, the slices are not scrolled on each update. Instead,
+  // each new slice is written into a ring of slices indexed by its time step,
+  // so the memory is not in time order. Use CopyFeatureData() or GetSliceData()
+  // to read it.
+  FeatureProvider(int feature_size, int8_t* feature_data,
+                  bool is_circular = false);
   ~FeatureProvider();
 
   // Fills the feature data with information from audio inputs, and returns how
@@ -43,12 +49,28 @@ class FeatureProvider {
                                    int32_t last_time_in_ms, int32_t time_in_ms,
                                    int32_t* how_many_new_slices);
 
+  // Copies the spectrogram in time order (the oldest slice first) into dst,
+  // which must hold feature_size bytes. This takes at most two memcpys.
+  void CopyFeatureData(int8_t* dst) const;
+
+  // Returns the slice_index-th oldest slice (0 = the oldest).
+  const int8_t* GetSliceData(int slice_index) const;
+
  private:
   int feature_size_;
   int8_t* feature_data_;
+  bool is_circular_;
+  // Ring position of the oldest slice. Always 0 when is_circular_ is false.
+  int oldest_slice_;
+
   // Make sure we don't try to use cached information if this is the first call
   // into the provider.
   bool is_first_run_;
+
+  // Each provider has its own frontend state, in its own arena.
+  MicroFeaturesGenerator generator_;
+  alignas(kFrontendArenaAlignment)
+      uint8_t generator_arena_[MicroFeaturesGenerator::kArenaSize];
 };
 
 #endif  // TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_FEATURE_PROVIDER_H_
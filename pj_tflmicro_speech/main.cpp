@@ -103,7 +103,7 @@ int main(void) {
 
     /* Create feature provider */
     static int8_t feature_buffer[kFeatureElementCount];
-    static FeatureProvider feature_provider(kFeatureElementCount, feature_buffer);
+    static FeatureProvider feature_provider(kFeatureElementCount, feature_buffer, true);    // circular mode (slices are not scrolled)
     static AudioProvider audio_provider;
     audio_provider.Initialize();
     int32_t previous_time = 0;
@@ -116,6 +116,7 @@ int main(void) {
         /* Generate feature */
         audio_provider.DebugWriteData(32);
         const int32_t current_time = audio_provider.GetLatestAudioTimestamp();
+        audio_provider.HandleStatsCommand(current_time);
         if (current_time < 0 || current_time == previous_time) continue;
 
         int32_t how_many_new_slices = 0;
@@ -128,12 +129,10 @@ int main(void) {
         previous_time = current_time;
         if (how_many_new_slices == 0) continue;
 
-        /* Copy the generated feature data to input tensor buffer*/
-        for (int32_t i = 0; i < kFeatureElementCount; i++) {
-            //input->data.int8[i] = g_yes_micro_f2e59fea_nohash_1_data[i];
-            //input->data.int8[i] = g_no_micro_f9643d42_nohash_4_data[i];
-            input->data.int8[i] = feature_buffer[i];
-        }
+        /* Copy the generated feature data to input tensor buffer in time order */
+        //memcpy(input->data.int8, g_yes_micro_f2e59fea_nohash_1_data, kFeatureElementCount);
+        //memcpy(input->data.int8, g_no_micro_f9643d42_nohash_4_data, kFeatureElementCount);
+        feature_provider.CopyFeatureData(input->data.int8);
 
         /* Run inference */
         TfLiteStatus invoke_status = interpreter->Invoke();
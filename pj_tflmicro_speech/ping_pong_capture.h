@@ -0,0 +1,120 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef PING_PONG_CAPTURE_H_
+#define PING_PONG_CAPTURE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "ring_block_buffer.h"
+
+/*** Ping-pong capture
+ * Two DMA channels are chained to each other. When one channel finishes a block, the other channel starts immediately,
+ * so no sample is lost between blocks and the IRQ handler doesn't need to restart DMA. The IRQ handler does only bookkeeping:
+ *   - commits the block written by the finished channel to the ring block buffer
+ *   - reserves the next free block and sets it as the write address of the finished channel (used when it's triggered again)
+ * If the ring block buffer is full, the channel writes into a discard block instead (overrun). The block is dropped, but capture continues
+ * The IRQ handler must finish before the other channel finishes its block
+ ***/
+
+/* Hardware access used by PingPongCapture (pico DMA in AdcBuffer, or a simulation on PC) */
+class PingPongDma {
+public:
+    virtual ~PingPongDma() {}
+    /* channel_index = 0 or 1. The address is used when the channel is triggered next time */
+    virtual void SetWriteAddress(int32_t channel_index, void* dst) = 0;
+    /* Trigger channel 0. After that, the channels trigger each other */
+    virtual void Start() = 0;
+};
+
+template<class T>
+class PingPongCapture
+{
+public:
+    PingPongCapture()
+        : ring_buffer_(nullptr)
+        , dma_(nullptr)
+        , next_channel_index_(0)
+        , reserved_num_(0) {
+        is_reserved_[0] = false;
+        is_reserved_[1] = false;
+    }
+
+    ~PingPongCapture() {}
+
+    void Initialize(RingBlockBuffer<T>* ring_buffer, PingPongDma* dma) {
+        ring_buffer_ = ring_buffer;
+        dma_ = dma;
+        discard_block_.assign(ring_buffer_->block_size(), T());
+    }
+
+    void Finalize() {
+        discard_block_.clear();
+        discard_block_.shrink_to_fit();
+    }
+
+    /* Blocks reserved but not committed at the last stop are just reused */
+    void Start() {
+        next_channel_index_ = 0;
+        reserved_num_ = 0;
+        dma_->SetWriteAddress(0, ReserveBlock(0));
+        dma_->SetWriteAddress(1, ReserveBlock(1));
+        dma_->Start();
+    }
+
+    /* Call from the IRQ handler when the channel of next_channel_index() has finished */
+    /* time_us is stamped on the block. Returns false if the finished block has been written into the discard block (overrun) */
+    bool OnBlockFinished(uint64_t time_us) {
+        const int32_t index = next_channel_index_;
+        const bool is_committed = is_reserved_[index];
+        if (is_committed) {
+            ring_buffer_->Commit(time_us);  // the finished block is always the oldest reserved one
+            reserved_num_--;
+        } else {
+            ring_buffer_->Drop();           // keep counting sample index
+        }
+        dma_->SetWriteAddress(index, ReserveBlock(index));
+        next_channel_index_ ^= 1;
+        return is_committed;
+    }
+
+    /* The channels finish alternately */
+    int32_t next_channel_index() const {
+        return next_channel_index_;
+    }
+
+private:
+    T* ReserveBlock(int32_t channel_index) {
+        T* ptr = ring_buffer_->ReservePtr(reserved_num_);
+        if (ptr == nullptr) {
+            is_reserved_[channel_index] = false;
+            return discard_block_.data();
+        }
+        is_reserved_[channel_index] = true;
+        reserved_num_++;
+        return ptr;
+    }
+
+private:
+    RingBlockBuffer<T>* ring_buffer_;
+    PingPongDma* dma_;
+    std::vector<T> discard_block_;
+    int32_t next_channel_index_;
+    int32_t reserved_num_;          // the number of blocks reserved in the ring block buffer (0 - 2)
+    bool is_reserved_[2];           // false: the channel is writing into discard_block_
+};
+
+#endif  // PING_PONG_CAPTURE_H_
@@ -0,0 +1,257 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "sample_converter.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(SAMPLE_CONVERTER_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(SAMPLE_CONVERTER_USE_NEON)
+#include <arm_neon.h>
+#endif
+
+/*** MACRO ***/
+/* SWAR path assumes the order of bytes in a word */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#define SAMPLE_CONVERTER_NO_SWAR
+#endif
+
+/* SWAR path accesses int16_t / uint8_t arrays as words */
+#if defined(__GNUC__)
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+#else
+typedef uint32_t word_t;
+#endif
+
+/*** FUNCTION ***/
+namespace SampleConverter {
+
+void ConvertU8ToS16(const uint8_t* src, int16_t* dst, int32_t num) {
+#if defined(SAMPLE_CONVERTER_HAS_SIMD)
+    ConvertU8ToS16Simd(src, dst, num);
+#else
+    ConvertU8ToS16Swar(src, dst, num);
+#endif
+}
+
+void ConvertS16ToU8(const int16_t* src, uint8_t* dst, int32_t num) {
+#if defined(SAMPLE_CONVERTER_HAS_SIMD)
+    ConvertS16ToU8Simd(src, dst, num);
+#else
+    ConvertS16ToU8Reference(src, dst, num);
+#endif
+}
+
+void ConvertU12ToS16(const uint16_t* src, int16_t* dst, int32_t num) {
+#if defined(SAMPLE_CONVERTER_HAS_SIMD)
+    ConvertU12ToS16Simd(src, dst, num);
+#else
+    ConvertU12ToS16Swar(src, dst, num);
+#endif
+}
+
+void ConvertS16ToU12(const int16_t* src, uint16_t* dst, int32_t num) {
+#if defined(SAMPLE_CONVERTER_HAS_SIMD)
+    ConvertS16ToU12Simd(src, dst, num);
+#else
+    ConvertS16ToU12Reference(src, dst, num);
+#endif
+}
+
+void ConvertU8ToS16Reference(const uint8_t* src, int16_t* dst, int32_t num) {
+    for (int32_t i = 0; i < num; i++) {
+        dst[i] = (static_cast<int16_t>(src[i]) - 128) * 256;
+    }
+}
+
+void ConvertS16ToU8Reference(const int16_t* src, uint8_t* dst, int32_t num) {
+    for (int32_t i = 0; i < num; i++) {
+        dst[i] = static_cast<uint8_t>(src[i] / 256 + 128);
+    }
+}
+
+void ConvertU12ToS16Reference(const uint16_t* src, int16_t* dst, int32_t num) {
+    for (int32_t i = 0; i < num; i++) {
+        dst[i] = (static_cast<int16_t>(src[i] & 0x0FFF) - 2048) * 16;
+    }
+}
+
+void ConvertS16ToU12Reference(const int16_t* src, uint16_t* dst, int32_t num) {
+    for (int32_t i = 0; i < num; i++) {
+        dst[i] = static_cast<uint16_t>(src[i] / 16 + 2048);
+    }
+}
+
+/* (x - 128) * 256 = (x ^ 0x80) << 8 as int16_t. 4 samples are converted with two 32-bit words: */
+/*   src word = | b3 | b2 | b1 | b0 |  ->  dst words = | b1' | 0 | b0' | 0 |, | b3' | 0 | b2' | 0 |  (b' = b ^ 0x80) */
+void ConvertU8ToS16Swar(const uint8_t* src, int16_t* dst, int32_t num) {
+    int32_t i = 0;
+#ifndef SAMPLE_CONVERTER_NO_SWAR
+    /* process one by one until src is aligned. SWAR is available only when dst is aligned at the same time */
+    while (i < num && (reinterpret_cast<uintptr_t>(src + i) & 3) != 0) {
+        dst[i] = (static_cast<int16_t>(src[i]) - 128) * 256;
+        i++;
+    }
+    if ((reinterpret_cast<uintptr_t>(dst + i) & 3) == 0) {
+        const word_t* src32 = reinterpret_cast<const word_t*>(src + i);
+        word_t* dst32 = reinterpret_cast<word_t*>(dst + i);
+        const int32_t word_num = (num - i) / 4;
+        for (int32_t w = 0; w < word_num; w++) {
+            const uint32_t x = src32[w] ^ 0x80808080;
+            dst32[2 * w + 0] = ((x << 8) & 0x0000FF00) | ((x << 16) & 0xFF000000);
+            dst32[2 * w + 1] = ((x >> 8) & 0x0000FF00) | (x & 0xFF000000);
+        }
+        i += word_num * 4;
+    }
+#endif
+    for (; i < num; i++) {
+        dst[i] = (static_cast<int16_t>(src[i]) - 128) * 256;
+    }
+}
+
+/* (x - 2048) * 16 = (x ^ 0x800) << 4 as int16_t, and x ^ 0x800 < 0x1000. So 2 samples in a word are converted at once */
+/* The upper 4 bits are ignored in all backends (ERR bit of ADC FIFO) */
+void ConvertU12ToS16Swar(const uint16_t* src, int16_t* dst, int32_t num) {
+    int32_t i = 0;
+#ifndef SAMPLE_CONVERTER_NO_SWAR
+    /* src and dst have the same alignment in most cases (both are arrays of 16-bit) */
+    if ((reinterpret_cast<uintptr_t>(src) & 3) == (reinterpret_cast<uintptr_t>(dst) & 3)) {
+        if (num > 0 && (reinterpret_cast<uintptr_t>(src) & 3) != 0) {
+            dst[0] = (static_cast<int16_t>(src[0] & 0x0FFF) - 2048) * 16;
+            i++;
+        }
+        const word_t* src32 = reinterpret_cast<const word_t*>(src + i);
+        word_t* dst32 = reinterpret_cast<word_t*>(dst + i);
+        const int32_t word_num = (num - i) / 2;
+        for (int32_t w = 0; w < word_num; w++) {
+            dst32[w] = ((src32[w] & 0x0FFF0FFF) ^ 0x08000800) << 4;
+        }
+        i += word_num * 2;
+    }
+#endif
+    for (; i < num; i++) {
+        dst[i] = (static_cast<int16_t>(src[i] & 0x0FFF) - 2048) * 16;
+    }
+}
+
+#if defined(SAMPLE_CONVERTER_USE_SSE2)
+void ConvertU8ToS16Simd(const uint8_t* src, int16_t* dst, int32_t num) {
+    const __m128i kZero = _mm_setzero_si128();
+    const __m128i kSignFlip = _mm_set1_epi8(static_cast<char>(0x80));
+    int32_t i = 0;
+    for (; i + 16 <= num; i += 16) {
+        const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), kSignFlip);
+        /* interleave with zero as the lower byte: (x ^ 0x80) << 8 */
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 0), _mm_unpacklo_epi8(kZero, x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(kZero, x));
+    }
+    ConvertU8ToS16Reference(src + i, dst + i, num - i);
+}
+
+void ConvertS16ToU8Simd(const int16_t* src, uint8_t* dst, int32_t num) {
+    const __m128i kRoundBias = _mm_set1_epi16(255);
+    const __m128i kSignFlip = _mm_set1_epi8(static_cast<char>(0x80));
+    int32_t i = 0;
+    for (; i + 16 <= num; i += 16) {
+        __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 0));
+        __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        /* x / 256 (toward zero) = (x + (x < 0 ? 255 : 0)) >> 8 */
+        x0 = _mm_srai_epi16(_mm_add_epi16(x0, _mm_and_si128(_mm_srai_epi16(x0, 15), kRoundBias)), 8);
+        x1 = _mm_srai_epi16(_mm_add_epi16(x1, _mm_and_si128(_mm_srai_epi16(x1, 15), kRoundBias)), 8);
+        /* int8_t (-128 - 127) + 128 = int8_t ^ 0x80 */
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(_mm_packs_epi16(x0, x1), kSignFlip));
+    }
+    ConvertS16ToU8Reference(src + i, dst + i, num - i);
+}
+
+void ConvertU12ToS16Simd(const uint16_t* src, int16_t* dst, int32_t num) {
+    const __m128i kMask = _mm_set1_epi16(0x0FFF);
+    const __m128i kOffset = _mm_set1_epi16(0x800);
+    int32_t i = 0;
+    for (; i + 8 <= num; i += 8) {
+        const __m128i x = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), kMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_slli_epi16(_mm_xor_si128(x, kOffset), 4));
+    }
+    ConvertU12ToS16Reference(src + i, dst + i, num - i);
+}
+
+void ConvertS16ToU12Simd(const int16_t* src, uint16_t* dst, int32_t num) {
+    const __m128i kRoundBias = _mm_set1_epi16(15);
+    const __m128i kOffset = _mm_set1_epi16(2048);
+    int32_t i = 0;
+    for (; i + 8 <= num; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        /* x / 16 (toward zero) = (x + (x < 0 ? 15 : 0)) >> 4 */
+        x = _mm_srai_epi16(_mm_add_epi16(x, _mm_and_si128(_mm_srai_epi16(x, 15), kRoundBias)), 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi16(x, kOffset));
+    }
+    ConvertS16ToU12Reference(src + i, dst + i, num - i);
+}
+#elif defined(SAMPLE_CONVERTER_USE_NEON)
+void ConvertU8ToS16Simd(const uint8_t* src, int16_t* dst, int32_t num) {
+    const uint8x16_t kSignFlip = vdupq_n_u8(0x80);
+    int32_t i = 0;
+    for (; i + 16 <= num; i += 16) {
+        const int8x16_t x = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(src + i), kSignFlip));
+        vst1q_s16(dst + i + 0, vshll_n_s8(vget_low_s8(x), 8));
+        vst1q_s16(dst + i + 8, vshll_n_s8(vget_high_s8(x), 8));
+    }
+    ConvertU8ToS16Reference(src + i, dst + i, num - i);
+}
+
+void ConvertS16ToU8Simd(const int16_t* src, uint8_t* dst, int32_t num) {
+    const int16x8_t kRoundBias = vdupq_n_s16(255);
+    const uint8x16_t kSignFlip = vdupq_n_u8(0x80);
+    int32_t i = 0;
+    for (; i + 16 <= num; i += 16) {
+        int16x8_t x0 = vld1q_s16(src + i + 0);
+        int16x8_t x1 = vld1q_s16(src + i + 8);
+        /* x / 256 (toward zero) = (x + (x < 0 ? 255 : 0)) >> 8 */
+        x0 = vshrq_n_s16(vaddq_s16(x0, vandq_s16(vshrq_n_s16(x0, 15), kRoundBias)), 8);
+        x1 = vshrq_n_s16(vaddq_s16(x1, vandq_s16(vshrq_n_s16(x1, 15), kRoundBias)), 8);
+        const uint8x16_t q = vreinterpretq_u8_s8(vcombine_s8(vmovn_s16(x0), vmovn_s16(x1)));
+        vst1q_u8(dst + i, veorq_u8(q, kSignFlip));
+    }
+    ConvertS16ToU8Reference(src + i, dst + i, num - i);
+}
+
+void ConvertU12ToS16Simd(const uint16_t* src, int16_t* dst, int32_t num) {
+    const uint16x8_t kMask = vdupq_n_u16(0x0FFF);
+    const uint16x8_t kOffset = vdupq_n_u16(0x800);
+    int32_t i = 0;
+    for (; i + 8 <= num; i += 8) {
+        const uint16x8_t x = veorq_u16(vandq_u16(vld1q_u16(src + i), kMask), kOffset);
+        vst1q_s16(dst + i, vreinterpretq_s16_u16(vshlq_n_u16(x, 4)));
+    }
+    ConvertU12ToS16Reference(src + i, dst + i, num - i);
+}
+
+void ConvertS16ToU12Simd(const int16_t* src, uint16_t* dst, int32_t num) {
+    const int16x8_t kRoundBias = vdupq_n_s16(15);
+    const int16x8_t kOffset = vdupq_n_s16(2048);
+    int32_t i = 0;
+    for (; i + 8 <= num; i += 8) {
+        int16x8_t x = vld1q_s16(src + i);
+        /* x / 16 (toward zero) = (x + (x < 0 ? 15 : 0)) >> 4 */
+        x = vshrq_n_s16(vaddq_s16(x, vandq_s16(vshrq_n_s16(x, 15), kRoundBias)), 4);
+        vst1q_u16(dst + i, vreinterpretq_u16_s16(vaddq_s16(x, kOffset)));
+    }
+    ConvertS16ToU12Reference(src + i, dst + i, num - i);
+}
+#endif
+
+}
@@ -0,0 +1,65 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SAMPLE_CONVERTER_H_
+#define SAMPLE_CONVERTER_H_
+
+#include <cstdint>
+
+/*** Audio sample format conversion
+ *   - U8ToS16: uint8_t (0 - 255) -> int16_t (-32768 - 32767) = (x - 128) * 256
+ *   - S16ToU8: int16_t -> uint8_t = x / 256 + 128 (truncated toward zero, the same as C division)
+ *   - U12ToS16: uint16_t (0 - 4095, 12-bit ADC) -> int16_t (-32768 - 32752) = (x - 2048) * 16. The upper 4 bits are ignored
+ *   - S16ToU12: int16_t -> uint16_t (0 - 4095) = x / 16 + 2048 (truncated toward zero)
+ * Backends (selected at compile time):
+ *   - SIMD     : SSE2 or NEON (host build)
+ *   - SWAR     : word-at-a-time with 32-bit registers (Cortex-M0+). U8ToS16 and U12ToS16 only
+ *   - Reference: one sample at a time
+ * Convert* uses the best backend available. The backend functions are exposed for testing
+ ***/
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLE_CONVERTER_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SAMPLE_CONVERTER_USE_NEON
+#endif
+
+#if defined(SAMPLE_CONVERTER_USE_SSE2) || defined(SAMPLE_CONVERTER_USE_NEON)
+#define SAMPLE_CONVERTER_HAS_SIMD
+#endif
+
+namespace SampleConverter {
+
+void ConvertU8ToS16(const uint8_t* src, int16_t* dst, int32_t num);
+void ConvertS16ToU8(const int16_t* src, uint8_t* dst, int32_t num);
+void ConvertU12ToS16(const uint16_t* src, int16_t* dst, int32_t num);
+void ConvertS16ToU12(const int16_t* src, uint16_t* dst, int32_t num);
+
+void ConvertU8ToS16Reference(const uint8_t* src, int16_t* dst, int32_t num);
+void ConvertU8ToS16Swar(const uint8_t* src, int16_t* dst, int32_t num);
+void ConvertS16ToU8Reference(const int16_t* src, uint8_t* dst, int32_t num);
+void ConvertU12ToS16Reference(const uint16_t* src, int16_t* dst, int32_t num);
+void ConvertU12ToS16Swar(const uint16_t* src, int16_t* dst, int32_t num);
+void ConvertS16ToU12Reference(const int16_t* src, uint16_t* dst, int32_t num);
+#ifdef SAMPLE_CONVERTER_HAS_SIMD
+void ConvertU8ToS16Simd(const uint8_t* src, int16_t* dst, int32_t num);
+void ConvertS16ToU8Simd(const int16_t* src, uint8_t* dst, int32_t num);
+void ConvertU12ToS16Simd(const uint16_t* src, int16_t* dst, int32_t num);
+void ConvertS16ToU12Simd(const int16_t* src, uint16_t* dst, int32_t num);
+#endif
+
+}
+
+#endif  // SAMPLE_CONVERTER_H_
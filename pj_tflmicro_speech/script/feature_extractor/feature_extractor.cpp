@@ -0,0 +1,337 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** Offline feature extractor
+ * Converts WAV files into the int8 features of the model, with the same frontend ( FrontendState ), configuration and quantization as the device
+ *   - usage: feature_extractor [-o features.bin] [-j threads] [-s slice_count] [-l list.txt] (wav file | directory) ...
+ *     - directories are searched recursively for *.wav. list.txt has one path per line
+ *   - WAV: 16 kHz, PCM 16-bit or 8-bit. Only the first channel is used. 8-bit samples are converted in the same way as ADC samples
+ *   - each clip is processed from the reset state ( the same as the first slices after MicroFeaturesGenerator::Initialize )
+ *   - each clip makes slice_count slices ( kFeatureSliceCount by default ). A shorter clip is padded with silence, and a longer clip is truncated
+ *     ( the same as input_data.py in the training pipeline )
+ *   - files are distributed over the threads ( all cores by default ). Each thread has its own FrontendState
+ ***/
+
+/*** Output file ( little endian )
+ *   | offset          | type                                      | content                                                  |
+ *   |-----------------|-------------------------------------------|----------------------------------------------------------|
+ *   | 0               | FileHeader                                | 64 Byte                                                  |
+ *   | slice_num_offset| int32_t[clip_num]                         | the number of slices made from the audio of each clip    |
+ *   |                 |                                           | ( less than slice_count if padded. -1 if the clip failed)|
+ *   | feature_offset  | int8_t[clip_num][slice_count][slice_size] | features. zero for a failed clip                         |
+ *   | name_offset     | char[name_size]                           | path of each clip, terminated by '\n'                    |
+ * The offsets are multiples of 64, so the features can be memory-mapped as an array directly. e.g. numpy:
+ *   np.memmap(path, dtype=np.int8, mode="r", offset=feature_offset, shape=(clip_num, slice_count, slice_size))
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_util.h"
+#include "micro_features/micro_features_frontend.h"
+#include "micro_features/micro_model_settings.h"
+#include "sample_converter.h"
+
+namespace {
+
+constexpr char kMagic[8] = { 'M', 'I', 'C', 'R', 'O', 'F', 'E', 'A' };
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kAlignment = 64;
+
+/* The host is assumed to be little endian */
+typedef struct {
+    char     magic[8];          // "MICROFEA"
+    uint32_t version;
+    uint32_t clip_num;
+    uint32_t slice_count;       // slices per clip
+    uint32_t slice_size;        // kFeatureSliceSize
+    uint64_t slice_num_offset;
+    uint64_t feature_offset;
+    uint64_t name_offset;
+    uint64_t name_size;
+    uint8_t  reserved[8];
+} FileHeader;
+static_assert(sizeof(FileHeader) == 64, "FileHeader must be 64 Byte");
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint32_t ReadU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+/* Reads the first channel of a 16 kHz PCM (8-bit or 16-bit) WAV file. Returns false with the reason in error */
+bool ReadWav(const std::string& path, std::vector<int16_t>& samples, std::string& error) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        error = "cannot open";
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    uint16_t format = 0;
+    uint16_t channel_num = 0;
+    uint32_t sample_rate = 0;
+    uint16_t bits_per_sample = 0;
+    const uint8_t* pcm = nullptr;
+    size_t pcm_size = 0;
+    size_t pos = 12;
+    while (pos + 8 <= data.size()) {
+        const uint8_t* chunk = data.data() + pos;
+        const size_t chunk_size = std::min<size_t>(ReadU32(chunk + 4), data.size() - pos - 8);
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+            format = ReadU16(chunk + 8);
+            channel_num = ReadU16(chunk + 10);
+            sample_rate = ReadU32(chunk + 12);
+            bits_per_sample = ReadU16(chunk + 22);
+            if (format == 0xFFFE && chunk_size >= 26) {
+                format = ReadU16(chunk + 32);   // WAVE_FORMAT_EXTENSIBLE: the head of SubFormat
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            pcm = chunk + 8;
+            pcm_size = chunk_size;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    if (format != 1 || channel_num == 0 || (bits_per_sample != 8 && bits_per_sample != 16)) {
+        error = "not 8-bit or 16-bit PCM";
+        return false;
+    }
+    if (sample_rate != kAudioSampleFrequency) {
+        error = "sample rate is " + std::to_string(sample_rate) + " Hz ( " + std::to_string(kAudioSampleFrequency) + " Hz is required )";
+        return false;
+    }
+    if (pcm == nullptr) {
+        error = "no data chunk";
+        return false;
+    }
+
+    const size_t frame_size = channel_num * bits_per_sample / 8;
+    const size_t sample_num = pcm_size / frame_size;
+    samples.resize(sample_num);
+    if (bits_per_sample == 16) {
+        for (size_t i = 0; i < sample_num; i++) {
+            samples[i] = static_cast<int16_t>(ReadU16(pcm + i * frame_size));
+        }
+    } else {
+        std::vector<uint8_t> first_channel(sample_num);
+        for (size_t i = 0; i < sample_num; i++) {
+            first_channel[i] = pcm[i * frame_size];
+        }
+        SampleConverter::ConvertU8ToS16(first_channel.data(), samples.data(), static_cast<int32_t>(sample_num));
+    }
+    return true;
+}
+
+/* Runs the frontend over the whole clip. Returns the number of slices made from the audio of the clip */
+int32_t ExtractFeatures(FrontendState* state, std::vector<int16_t>& samples, int32_t slice_count, int8_t* features) {
+    const int32_t window_size = kAudioSampleFrequency * kFeatureSliceDurationMs / 1000;
+    const int32_t window_step = kAudioSampleFrequency * kFeatureSliceStrideMs / 1000;
+    const size_t required_sample_num = static_cast<size_t>(slice_count - 1) * window_step + window_size;
+    const int32_t slice_num = (samples.size() < static_cast<size_t>(window_size)) ? 0 : static_cast<int32_t>((samples.size() - window_size) / window_step + 1);
+    samples.resize(required_sample_num, 0);     // pad with silence, or truncate
+
+    FrontendReset(state);
+    const int16_t* input = samples.data();
+    size_t remaining = samples.size();
+    int32_t slice_index = 0;
+    while (slice_index < slice_count && remaining > 0) {
+        size_t num_samples_read;
+        FrontendOutput frontend_output = FrontendProcessSamples(state, input, remaining, &num_samples_read);
+        input += num_samples_read;
+        remaining -= num_samples_read;
+        if (frontend_output.size > 0) {
+            QuantizeMicroFeatures(frontend_output, features + slice_index * kFeatureSliceSize);
+            slice_index++;
+        }
+    }
+    return std::min(slice_num, slice_count);
+}
+
+void CollectWavFiles(const std::string& path, std::vector<std::string>& file_list) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        file_list.push_back(path);
+        return;
+    }
+    std::vector<std::string> found;
+    for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+        if (!entry.is_regular_file()) continue;
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".wav") found.push_back(entry.path().string());
+    }
+    std::sort(found.begin(), found.end());     // the order doesn't depend on the file system
+    file_list.insert(file_list.end(), found.begin(), found.end());
+}
+
+void PrintUsage(const char* name) {
+    printf("usage: %s [-o features.bin] [-j threads] [-s slice_count] [-l list.txt] (wav file | directory) ...\n", name);
+    printf("  -o: output file ( default: features.bin )\n");
+    printf("  -j: the number of threads ( default: the number of cores )\n");
+    printf("  -s: slices per clip ( default: %d )\n", kFeatureSliceCount);
+    printf("  -l: text file listing wav files, one per line\n");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output_path = "features.bin";
+    int32_t thread_num = static_cast<int32_t>(std::thread::hardware_concurrency());
+    int32_t slice_count = kFeatureSliceCount;
+    std::vector<std::string> file_list;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if ((arg == "-o" || arg == "-j" || arg == "-s" || arg == "-l") && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (arg == "-o") {
+                output_path = value;
+            } else if (arg == "-j") {
+                thread_num = atoi(value.c_str());
+            } else if (arg == "-s") {
+                slice_count = atoi(value.c_str());
+            } else {
+                std::ifstream ifs(value);
+                if (!ifs) {
+                    fprintf(stderr, "cannot open %s\n", value.c_str());
+                    return 1;
+                }
+                std::string line;
+                while (std::getline(ifs, line)) {
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (!line.empty()) CollectWavFiles(line, file_list);
+                }
+            }
+        } else if (arg == "-h" || arg[0] == '-') {
+            PrintUsage(argv[0]);
+            return (arg == "-h") ? 0 : 1;
+        } else {
+            CollectWavFiles(arg, file_list);
+        }
+    }
+    if (file_list.empty() || slice_count <= 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    thread_num = std::max(1, std::min(thread_num, static_cast<int32_t>(file_list.size())));
+
+    const size_t clip_num = file_list.size();
+    const size_t clip_size = static_cast<size_t>(slice_count) * kFeatureSliceSize;
+    std::vector<int8_t> features(clip_num * clip_size, 0);
+    std::vector<int32_t> slice_num_list(clip_num, -1);
+    std::vector<std::string> error_list(clip_num);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::atomic<size_t> next_clip(0);
+    std::atomic<bool> is_init_failed(false);
+    auto worker = [&]() {
+        FrontendConfig config;
+        FillMicroFeaturesFrontendConfig(&config);
+        FrontendState state;
+        if (!FrontendPopulateState(&config, &state, kAudioSampleFrequency)) {
+            is_init_failed = true;
+            return;
+        }
+        std::vector<int16_t> samples;
+        for (size_t clip = next_clip++; clip < clip_num; clip = next_clip++) {
+            if (!ReadWav(file_list[clip], samples, error_list[clip])) continue;
+            slice_num_list[clip] = ExtractFeatures(&state, samples, slice_count, features.data() + clip * clip_size);
+        }
+        FrontendFreeStateContents(&state);
+    };
+    std::vector<std::thread> thread_list;
+    for (int32_t i = 0; i < thread_num; i++) {
+        thread_list.emplace_back(worker);
+    }
+    for (auto& t : thread_list) {
+        t.join();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    if (is_init_failed) {
+        fprintf(stderr, "FrontendPopulateState() failed\n");
+        return 1;
+    }
+
+    size_t failed_num = 0;
+    std::string names;
+    for (size_t clip = 0; clip < clip_num; clip++) {
+        if (slice_num_list[clip] < 0) {
+            fprintf(stderr, "%s: %s\n", file_list[clip].c_str(), error_list[clip].c_str());
+            failed_num++;
+        }
+        names += file_list[clip] + '\n';
+    }
+
+    FileHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.clip_num = static_cast<uint32_t>(clip_num);
+    header.slice_count = static_cast<uint32_t>(slice_count);
+    header.slice_size = kFeatureSliceSize;
+    header.slice_num_offset = AlignUp(sizeof(FileHeader));
+    header.feature_offset = AlignUp(header.slice_num_offset + clip_num * sizeof(int32_t));
+    header.name_offset = AlignUp(header.feature_offset + features.size());
+    header.name_size = names.size();
+
+    FILE* fp = fopen(output_path.c_str(), "wb");
+    if (fp == nullptr) {
+        fprintf(stderr, "cannot open %s\n", output_path.c_str());
+        return 1;
+    }
+    uint64_t position = 0;
+    auto write_at = [fp, &position](uint64_t offset, const void* data, size_t size) {
+        static const char kPadding[kAlignment] = {};
+        const size_t padding_size = static_cast<size_t>(offset - position);
+        position = offset + size;
+        return fwrite(kPadding, 1, padding_size, fp) == padding_size && fwrite(data, 1, size, fp) == size;
+    };
+    bool is_written = write_at(0, &header, sizeof(header));
+    is_written &= write_at(header.slice_num_offset, slice_num_list.data(), clip_num * sizeof(int32_t));
+    is_written &= write_at(header.feature_offset, features.data(), features.size());
+    is_written &= write_at(header.name_offset, names.data(), names.size());
+    is_written &= (fclose(fp) == 0);
+    if (!is_written) {
+        fprintf(stderr, "cannot write %s\n", output_path.c_str());
+        return 1;
+    }
+
+    const double elapsed = std::chrono::duration<double>(t1 - t0).count();
+    printf("%zu clips ( %zu failed ) with %d threads in %.3lf sec -> %s\n", clip_num, failed_num, thread_num, elapsed, output_path.c_str());
+    return (failed_num > 0) ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** fft_fixed::RealFft benchmark
+ * nsec per frame of kiss_fftr and fft_fixed::RealFft for the frontend input ( 15/16 of the samples, shifted, zero padded )
+ *   - kiss_fftr: input preparation ( as FftCompute ) + kiss_fftr
+ *   - RealFft: the preparation is done while loading the input
+ * The best of several runs is shown. The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_fixed.h"
+#include "kiss_fft.h"
+#include "tools/kiss_fftr.h"
+
+namespace {
+
+constexpr int32_t kRunNum = 20;
+constexpr int32_t kLoopNum = 20000;
+
+volatile int32_t s_sink;
+
+template<class FUNC>
+double MeasureNs(FUNC func)
+{
+    double best = 1e30;
+    for (int32_t run = 0; run < kRunNum; run++) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int32_t loop = 0; loop < kLoopNum; loop++) func();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / kLoopNum);
+    }
+    return best;
+}
+
+template<int kFftSize>
+void Bench()
+{
+    constexpr int32_t kInputSize = kFftSize * 15 / 16;
+    constexpr int32_t kShift = 3;
+    size_t cfg_size = 0;
+    kiss_fftr_alloc(kFftSize, 0, nullptr, &cfg_size);
+    std::vector<uint8_t> cfg_memory(cfg_size);
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(kFftSize, 0, cfg_memory.data(), &cfg_size);
+
+    std::vector<int16_t> input(kFftSize);
+    std::vector<int16_t> buffer(kFftSize);
+    std::vector<complex_int16_t> output(kFftSize / 2 + 1);
+    for (int32_t i = 0; i < kFftSize; i++) input[i] = static_cast<int16_t>(1000 * sin(i * 0.1));
+
+    const double time_kiss = MeasureNs([&]() {
+        int32_t i = 0;
+        for (; i < kInputSize; i++) buffer[i] = static_cast<int16_t>(static_cast<uint16_t>(input[i]) << kShift);
+        for (; i < kFftSize; i++) buffer[i] = 0;
+        kiss_fftr(cfg, buffer.data(), reinterpret_cast<kiss_fft_cpx*>(output.data()));
+        s_sink = output[5].real;
+    });
+    const double time_fixed = MeasureNs([&]() {
+        fft_fixed::RealFft<kFftSize>::Compute(input.data(), kInputSize, kShift, output.data());
+        s_sink = output[5].real;
+    });
+    printf("N = %4d: kiss_fftr %7.0f nsec, RealFft %7.0f nsec (x%.2f), kiss_fftr config %d Byte\n",
+        kFftSize, time_kiss, time_fixed, time_kiss / time_fixed, static_cast<int32_t>(cfg_size));
+}
+
+}
+
+int main()
+{
+    Bench<256>();
+    Bench<512>();
+    Bench<1024>();
+    return 0;
+}
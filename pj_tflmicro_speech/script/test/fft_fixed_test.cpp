@@ -0,0 +1,112 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** fft_fixed::RealFft golden test
+ * The output must be bit-exact with kiss_fftr ( FIXED_POINT=16 ) for the same input, as FftCompute prepares it
+ *   - input: constant full scale, impulse, zero, random full scale, random small, alternating +-full scale and sine
+ *   - input_size ( the rest is zero padded ) and input_scale_shift are random
+ *   - usage: fft_fixed_test [trial_num_of_512]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_fixed.h"
+#include "kiss_fft.h"
+#include "tools/kiss_fftr.h"
+
+namespace {
+
+/* The same preparation as FftCompute */
+void PrepareInput(const int16_t* input, int32_t input_size, int32_t shift, int16_t* buffer, int32_t fft_size)
+{
+    int32_t i = 0;
+    for (; i < input_size; i++) buffer[i] = static_cast<int16_t>(static_cast<uint16_t>(input[i]) << shift);
+    for (; i < fft_size; i++) buffer[i] = 0;
+}
+
+void GenerateInput(int32_t trial, std::mt19937& rng, std::vector<int16_t>& input)
+{
+    std::uniform_int_distribution<int32_t> full(-32768, 32767);
+    std::uniform_int_distribution<int32_t> small(-512, 511);
+    const int32_t n = static_cast<int32_t>(input.size());
+    for (int32_t i = 0; i < n; i++) {
+        switch (trial) {
+        case 0: input[i] = -32768; continue;
+        case 1: input[i] = 32767; continue;
+        case 2: input[i] = (i == 0) ? 32767 : 0; continue;
+        case 3: input[i] = 0; continue;
+        default: break;
+        }
+        switch (trial % 4) {
+        case 0: input[i] = static_cast<int16_t>(full(rng)); break;
+        case 1: input[i] = static_cast<int16_t>(small(rng) * 64); break;
+        case 2: input[i] = (i % 2) ? 32767 : -32768; break;
+        default: input[i] = static_cast<int16_t>(20000 * sin(i * 0.37 * (trial % 13 + 1))); break;
+        }
+    }
+}
+
+template<int kFftSize>
+int32_t Check(int32_t trial_num, std::mt19937& rng)
+{
+    size_t cfg_size = 0;
+    kiss_fftr_alloc(kFftSize, 0, nullptr, &cfg_size);
+    std::vector<uint8_t> cfg_memory(cfg_size);
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(kFftSize, 0, cfg_memory.data(), &cfg_size);
+
+    std::vector<int16_t> input(kFftSize);
+    std::vector<int16_t> buffer(kFftSize);
+    std::vector<complex_int16_t> expected(kFftSize / 2 + 1);
+    std::vector<complex_int16_t> output(kFftSize / 2 + 1);
+    std::uniform_int_distribution<int32_t> input_size_dist(0, kFftSize);
+    std::uniform_int_distribution<int32_t> shift_dist(0, 15);
+    int32_t mismatch_num = 0;
+    for (int32_t trial = 0; trial < trial_num; trial++) {
+        GenerateInput(trial, rng, input);
+        /* The frontend uses 480 samples in 512 */
+        const int32_t input_size = (trial < 8 || trial % 3 == 0) ? kFftSize * 15 / 16 : input_size_dist(rng);
+        const int32_t shift = (trial < 8 || trial % 5 == 0) ? 0 : shift_dist(rng);
+        PrepareInput(input.data(), input_size, shift, buffer.data(), kFftSize);
+        kiss_fftr(cfg, buffer.data(), reinterpret_cast<kiss_fft_cpx*>(expected.data()));
+        fft_fixed::RealFft<kFftSize>::Compute(input.data(), input_size, shift, output.data());
+        if (memcmp(expected.data(), output.data(), sizeof(complex_int16_t) * expected.size()) != 0) mismatch_num++;
+    }
+    printf("[%s] N = %4d: %d / %d mismatch\n", mismatch_num == 0 ? "OK" : "NG", kFftSize, mismatch_num, trial_num);
+    return mismatch_num;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int32_t trial_num = (argc > 1) ? atoi(argv[1]) : 20000;
+    std::mt19937 rng(1234);
+    int32_t error_num = 0;
+    error_num += Check<8>(trial_num / 10, rng);
+    error_num += Check<16>(trial_num / 10, rng);
+    error_num += Check<64>(trial_num / 10, rng);
+    error_num += Check<128>(trial_num / 10, rng);
+    error_num += Check<256>(trial_num / 4, rng);
+    error_num += Check<512>(trial_num, rng);
+    error_num += Check<1024>(trial_num / 4, rng);
+    printf("%s\n", error_num == 0 ? "PASSED" : "FAILED");
+    return error_num == 0 ? 0 : 1;
+}
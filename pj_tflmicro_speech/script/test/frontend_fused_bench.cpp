@@ -0,0 +1,99 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** Fused frontend benchmark
+ * nsec per frame ( 320 new samples = 20 msec ) of the whole frontend: FrontendProcessSamples vs FrontendProcessSamplesReference
+ * Each frame is timed alone, and the minimum of each frame over the runs is used. The call order is alternated every frame
+ * The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "micro_features/micro_features_frontend.h"
+#include "micro_features/micro_model_settings.h"
+#include "test_audio.h"
+
+namespace {
+
+constexpr int32_t kFrameNum = 800;
+constexpr int32_t kRunNum = 20;
+constexpr int32_t kStepSize = kAudioSampleFrequency * 20 / 1000;
+
+double ProcessNs(FrontendOutput (*process)(FrontendState*, const int16_t*, size_t, size_t*), FrontendState* state, const int16_t* samples)
+{
+    size_t read = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    const FrontendOutput output = process(state, samples, kStepSize, &read);
+    const double time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    return (output.size > 0) ? time : -1;
+}
+
+}
+
+int main()
+{
+    FrontendConfig config;
+    FillMicroFeaturesFrontendConfig(&config);
+    FrontendState state_fused;
+    FrontendState state_reference;
+    if (!FrontendPopulateState(&config, &state_fused, kAudioSampleFrequency) || !FrontendPopulateState(&config, &state_reference, kAudioSampleFrequency)) {
+        printf("FrontendPopulateState failed\n");
+        return 1;
+    }
+    std::mt19937 rng(7);
+    const std::vector<int16_t> audio = GenerateTestAudio(kAudioSampleFrequency + kStepSize * (kFrameNum + 1), kAudioSampleFrequency, rng);
+
+    std::vector<double> time_fused(kFrameNum, 1e30);
+    std::vector<double> time_reference(kFrameNum, 1e30);
+    for (int32_t run = 0; run < kRunNum; run++) {
+        FrontendReset(&state_fused);
+        FrontendReset(&state_reference);
+        /* The first call only fills the window */
+        for (int32_t frame = -1; frame < kFrameNum; frame++) {
+            const int16_t* samples = audio.data() + kAudioSampleFrequency + kStepSize * (frame + 1);
+            double t_fused;
+            double t_reference;
+            if (frame & 1) {
+                t_reference = ProcessNs(FrontendProcessSamplesReference, &state_reference, samples);
+                t_fused = ProcessNs(FrontendProcessSamples, &state_fused, samples);
+            } else {
+                t_fused = ProcessNs(FrontendProcessSamples, &state_fused, samples);
+                t_reference = ProcessNs(FrontendProcessSamplesReference, &state_reference, samples);
+            }
+            if (frame < 0) continue;
+            if (t_fused < 0 || t_reference < 0) {
+                printf("no output\n");
+                return 1;
+            }
+            time_fused[frame] = std::min(time_fused[frame], t_fused);
+            time_reference[frame] = std::min(time_reference[frame], t_reference);
+        }
+    }
+    double sum_fused = 0;
+    double sum_reference = 0;
+    for (int32_t frame = 0; frame < kFrameNum; frame++) {
+        sum_fused += time_fused[frame];
+        sum_reference += time_reference[frame];
+    }
+    printf("per frame: reference %.0f nsec, fused %.0f nsec (%+.1f%%)\n",
+        sum_reference / kFrameNum, sum_fused / kFrameNum, 100 * (sum_fused / sum_reference - 1));
+    FrontendFreeStateContents(&state_fused);
+    FrontendFreeStateContents(&state_reference);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** Fused frontend differential test
+ * FrontendProcessSamples ( energy fused into the FFT ) and FrontendProcessSamplesReference ( separate passes ) run on separate states
+ * with the same audio in random chunk sizes. The number of samples consumed and every frame must be identical
+ *   - audio: silence, quiet noise, noise, full scale sweep, Nyquist, clipping noise, impulses and tone with noise ( 0.5 sec each, repeated )
+ *   - usage: frontend_fused_test [audio_sec]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "micro_features/micro_features_frontend.h"
+#include "micro_features/micro_model_settings.h"
+#include "test_audio.h"
+
+int main(int argc, char* argv[])
+{
+    const int32_t audio_sec = (argc > 1) ? atoi(argv[1]) : 120;
+    FrontendConfig config;
+    FillMicroFeaturesFrontendConfig(&config);
+    FrontendState state_fused;
+    FrontendState state_reference;
+    if (!FrontendPopulateState(&config, &state_fused, kAudioSampleFrequency) || !FrontendPopulateState(&config, &state_reference, kAudioSampleFrequency)) {
+        printf("FrontendPopulateState failed\n");
+        return 1;
+    }
+
+    std::mt19937 rng(7);
+    const std::vector<int16_t> audio = GenerateTestAudio(kAudioSampleFrequency * audio_sec, kAudioSampleFrequency, rng);
+    int32_t frame_num = 0;
+    int32_t mismatch_num = 0;
+    for (size_t pos = 0; pos < audio.size(); ) {
+        const size_t size = std::min<size_t>(audio.size() - pos, 1 + rng() % 700);
+        size_t read_fused = 0;
+        size_t read_reference = 0;
+        const FrontendOutput output_fused = FrontendProcessSamples(&state_fused, audio.data() + pos, size, &read_fused);
+        const FrontendOutput output_reference = FrontendProcessSamplesReference(&state_reference, audio.data() + pos, size, &read_reference);
+        if (read_fused != read_reference || output_fused.size != output_reference.size) {
+            printf("[NG] different read size or output size at %zu\n", pos);
+            mismatch_num++;
+            break;
+        }
+        if (output_fused.size > 0) {
+            frame_num++;
+            if (memcmp(output_fused.values, output_reference.values, output_fused.size * sizeof(uint16_t)) != 0) mismatch_num++;
+        }
+        pos += read_fused;
+    }
+    FrontendFreeStateContents(&state_fused);
+    FrontendFreeStateContents(&state_reference);
+
+    printf("%d frames, %d mismatch\n", frame_num, mismatch_num);
+    printf("%s\n", (mismatch_num == 0 && frame_num > 0) ? "PASSED" : "FAILED");
+    return (mismatch_num == 0 && frame_num > 0) ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** Integer math benchmark
+ * nsec per frame ( 40 channels ) of FilterbankSqrt and LogScaleApply: the reference ( reference/integer_math_reference.h ) vs integer_math.h
+ * The inputs are in the range seen in the frontend ( filterbank output 2^20 - 2^44, log input 2^3 - 2^24 )
+ * The best of the runs is shown. The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/integer_math.h"
+#include "reference/integer_math_reference.h"
+
+namespace {
+
+constexpr int32_t kFrameNum = 256;
+constexpr int32_t kChannelNum = 40;
+constexpr int32_t kRunNum = 300;
+
+volatile uint32_t s_sink;
+
+}
+
+int main()
+{
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> work(kFrameNum * kChannelNum);
+    for (auto& w : work) w = rng() >> (20 + rng() % 24);
+    std::vector<uint32_t> signal(kFrameNum * kChannelNum);
+    for (auto& s : signal) s = static_cast<uint32_t>(rng() >> (40 + rng() % 22)) | 2;
+
+    double time_sqrt[2] = { 1e30, 1e30 };
+    double time_log[2] = { 1e30, 1e30 };
+    for (int32_t run = 0; run < kRunNum; run++) {
+        for (int32_t order = 0; order < 2; order++) {
+            const int32_t is_reference = (run + order) & 1;
+            uint32_t sum = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (const auto w : work) sum += is_reference ? reference::Sqrt64(w) : IntegerSqrt64(w);
+            auto t1 = std::chrono::steady_clock::now();
+            for (const auto s : signal) sum += is_reference ? reference::Log(s << 2, 6) : IntegerLog(s << 2, 6);
+            auto t2 = std::chrono::steady_clock::now();
+            s_sink = sum;
+            time_sqrt[is_reference] = std::min(time_sqrt[is_reference], std::chrono::duration<double, std::nano>(t1 - t0).count() / kFrameNum);
+            time_log[is_reference] = std::min(time_log[is_reference], std::chrono::duration<double, std::nano>(t2 - t1).count() / kFrameNum);
+        }
+    }
+    printf("sqrt x %d: reference %.0f nsec, integer_math %.0f nsec (x%.2f)\n", kChannelNum, time_sqrt[1], time_sqrt[0], time_sqrt[1] / time_sqrt[0]);
+    printf("log  x %d: reference %.0f nsec, integer_math %.0f nsec (x%.2f)\n", kChannelNum, time_log[1], time_log[0], time_log[1] / time_log[0]);
+    return 0;
+}
@@ -0,0 +1,186 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** Integer math test
+ * integer_math.h must be bit-exact with the square root and the log before it ( reference/integer_math_reference.h )
+ *   - IntegerCountLeadingZeros32, IntegerSqrt32, IntegerLog ( scale_shift = 6 as the frontend ):
+ *     all values below 2^22, every 65521st value up to 2^32, and the values around squares and powers of 2
+ *     ( all 2^32 values with --exhaustive, which takes minutes )
+ *   - IntegerLog with scale_shift 0 - 15, IntegerSqrt64 with random values and the values around squares and 2^32
+ *   - FilterbankSqrt and LogScaleApply ( unrolled by 4 ) for 1 - 43 channels
+ * integer_math_m0_test is the same test built with __ARM_ARCH_6M__, which uses the table CLZ and the bit-by-bit 64-bit root
+ *   - usage: integer_math_test [--exhaustive]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/integer_math.h"
+#include "reference/integer_math_reference.h"
+
+namespace {
+
+constexpr uint32_t kFrontendLogScaleShift = 6;
+
+int32_t CheckSqrt64(uint64_t value)
+{
+    return (IntegerSqrt64(value) != reference::Sqrt64(value)) ? 1 : 0;
+}
+
+/* Returns the number of mismatches of clz, sqrt32 and log for value */
+int64_t Check32(uint32_t value)
+{
+    int64_t error_num = 0;
+    if (value != 0 && IntegerCountLeadingZeros32(value) != 32 - MostSignificantBit32(value)) error_num++;
+    if (IntegerSqrt32(value) != reference::Sqrt32(value)) error_num++;
+    if (value >= 2 && IntegerLog(value, kFrontendLogScaleShift) != reference::Log(value, kFrontendLogScaleShift)) error_num++;
+    return error_num;
+}
+
+int64_t Test32(bool is_exhaustive)
+{
+    std::atomic<int64_t> error_num(0);
+    if (is_exhaustive) {
+        const uint32_t thread_num = std::max(1U, std::thread::hardware_concurrency());
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < thread_num; t++) {
+            threads.emplace_back([&, t]() {
+                int64_t error_num_local = 0;
+                for (uint64_t value = t; value <= 0xFFFFFFFFULL; value += thread_num) error_num_local += Check32(static_cast<uint32_t>(value));
+                error_num += error_num_local;
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    } else {
+        int64_t error_num_local = 0;
+        for (uint32_t value = 0; value < (1U << 22); value++) error_num_local += Check32(value);
+        for (uint64_t value = 1U << 22; value <= 0xFFFFFFFFULL; value += 65521) error_num_local += Check32(static_cast<uint32_t>(value));
+        for (uint64_t root = 1U << 11; root <= 0xFFFF; root++) {
+            for (int64_t d = -2; d <= 2; d++) {
+                error_num_local += Check32(static_cast<uint32_t>(root * root + d));
+                error_num_local += Check32(static_cast<uint32_t>(root * root + root + d));
+            }
+        }
+        for (int32_t bit = 22; bit < 32; bit++) {
+            for (int64_t d = -3; d <= 3; d++) error_num_local += Check32(static_cast<uint32_t>((1ULL << bit) + d));
+        }
+        error_num_local += Check32(0xFFFFFFFFU);
+        error_num = error_num_local;
+    }
+    printf("[%s] clz, sqrt32, log (%s): %lld mismatch\n", error_num == 0 ? "OK" : "NG",
+        is_exhaustive ? "all 2^32 values" : "sampled", static_cast<long long>(error_num.load()));
+    return error_num;
+}
+
+int64_t TestLogScaleShift()
+{
+    int64_t error_num = 0;
+    for (uint32_t scale_shift = 0; scale_shift <= 15; scale_shift++) {
+        for (uint64_t value = 2; value <= 0xFFFFFFFFULL; value += 9973) {
+            if (IntegerLog(static_cast<uint32_t>(value), scale_shift) != reference::Log(static_cast<uint32_t>(value), scale_shift)) error_num++;
+        }
+    }
+    printf("[%s] log with scale_shift 0 - 15: %lld mismatch\n", error_num == 0 ? "OK" : "NG", static_cast<long long>(error_num));
+    return error_num;
+}
+
+int64_t TestSqrt64()
+{
+    std::mt19937_64 rng(7);
+    int64_t error_num = 0;
+    int64_t checked_num = 0;
+    for (int32_t i = 0; i < 2000000; i++) {
+        error_num += CheckSqrt64(rng() >> (rng() % 64));
+        checked_num++;
+    }
+    for (int32_t i = 0; i < 200000; i++) {
+        const uint64_t root = (rng() >> (rng() % 33)) & 0xFFFFFFFFULL;
+        for (int64_t d = -2; d <= 2; d++) {
+            error_num += CheckSqrt64(root * root + d);
+            error_num += CheckSqrt64(root * root + root + d);
+            checked_num += 2;
+        }
+    }
+    for (uint64_t d = 0; d < 100000; d++) {
+        error_num += CheckSqrt64(0xFFFFFFFFFFFFFFFFULL - d);
+        error_num += CheckSqrt64(0x100000000ULL + d);
+        error_num += CheckSqrt64(0x100000000ULL - 1 - d);
+        checked_num += 3;
+    }
+    for (int32_t bit = 32; bit < 64; bit++) {
+        for (int64_t d = -3; d <= 3; d++) {
+            error_num += CheckSqrt64((1ULL << bit) + d);
+            checked_num++;
+        }
+    }
+    printf("[%s] sqrt64: %lld mismatch in %lld values\n", error_num == 0 ? "OK" : "NG", static_cast<long long>(error_num), static_cast<long long>(checked_num));
+    return error_num;
+}
+
+int64_t TestApply()
+{
+    std::mt19937_64 rng(3);
+    int64_t error_num = 0;
+    for (int32_t num_channels = 1; num_channels <= 43; num_channels++) {
+        for (int32_t trial = 0; trial < 200; trial++) {
+            /* FilterbankSqrt reads work[1 .. num_channels] and writes the output over work */
+            std::vector<uint64_t> work(num_channels + 1);
+            for (auto& w : work) w = rng() >> (rng() % 64);
+            std::vector<uint64_t> work_reference = work;
+            FilterbankState state = {};
+            FilterbankState state_reference = {};
+            state.num_channels = num_channels;
+            state.work = work.data();
+            state_reference.num_channels = num_channels;
+            state_reference.work = work_reference.data();
+            const int32_t scale_down_shift = trial % 8;
+            uint32_t* signal = FilterbankSqrt(&state, scale_down_shift);
+            uint32_t* signal_reference = reference::FilterbankSqrt(&state_reference, scale_down_shift);
+            if (memcmp(signal, signal_reference, num_channels * sizeof(uint32_t)) != 0) error_num++;
+
+            LogScaleState log_state = { trial % 5 != 0, static_cast<int>(trial % 16) };
+            const int32_t correction_bits = trial % 7 - 3;
+            const uint16_t* output = LogScaleApply(&log_state, signal, num_channels, correction_bits);
+            const uint16_t* output_reference = reference::LogScaleApply(&log_state, signal_reference, num_channels, correction_bits);
+            if (memcmp(output, output_reference, num_channels * sizeof(uint16_t)) != 0) error_num++;
+        }
+    }
+    printf("[%s] FilterbankSqrt and LogScaleApply: %lld mismatch\n", error_num == 0 ? "OK" : "NG", static_cast<long long>(error_num));
+    return error_num;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const bool is_exhaustive = (argc > 1) && strcmp(argv[1], "--exhaustive") == 0;
+#if defined(__ARM_ARCH_6M__)
+    printf("__ARM_ARCH_6M__: table CLZ, bit-by-bit 64-bit square root\n");
+#else
+    printf("CLZ by CountLeadingZeros32, 64-bit square root by Newton step\n");
+#endif
+    int64_t error_num = 0;
+    error_num += Test32(is_exhaustive);
+    error_num += TestLogScaleShift();
+    error_num += TestSqrt64();
+    error_num += TestApply();
+    printf("%s\n", error_num == 0 ? "PASSED" : "FAILED");
+    return error_num == 0 ? 0 : 1;
+}
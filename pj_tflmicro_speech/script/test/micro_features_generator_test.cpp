@@ -0,0 +1,173 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** MicroFeaturesGenerator test
+ *   - Arena: the smallest arena FrontendPopulateStateInArena succeeds with is kArenaSize ( calculated from the configuration ),
+ *     the bytes in use after it are kMicroFeaturesArenaUsed, and Initialize refuses a smaller arena
+ *   - Instances: 8 generators run on 8 threads at the same time. Each has its own audio and feeds it in chunks of varying size
+ *     with GenerateBatch. The features must be the same as the ones of one generator converting the whole audio at once
+ *   - usage: micro_features_generator_test [run_num]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "micro_features/micro_features_frontend.h"
+#include "micro_features/micro_features_generator.h"
+#include "micro_features/micro_model_settings.h"
+#include "test_audio.h"
+
+namespace {
+
+constexpr int32_t kInstanceNum = 8;
+constexpr int32_t kAudioSampleNum = kAudioSampleFrequency * 4;
+constexpr int32_t kWindowSize = kFeatureSliceDurationMs * kAudioSampleFrequency / 1000;
+constexpr int32_t kWindowStep = kFeatureSliceStrideMs * kAudioSampleFrequency / 1000;
+
+bool PopulatesIn(size_t arena_size, size_t* arena_used)
+{
+    std::vector<uint64_t> arena_memory(arena_size / sizeof(uint64_t) + 1);
+    FrontendArena arena;
+    FrontendArenaInit(&arena, arena_memory.data(), arena_size);
+    FrontendConfig config;
+    FillMicroFeaturesFrontendConfig(&config);
+    FrontendState state;
+    const bool ok = FrontendPopulateStateInArena(&config, &state, kAudioSampleFrequency, &arena) != 0;
+    *arena_used = arena.used;
+    return ok;
+}
+
+int32_t TestArena()
+{
+    /* The smallest arena ( in units of the alignment ) */
+    size_t low = 0;
+    size_t high = MicroFeaturesGenerator::kArenaSize * 2;
+    size_t arena_used = 0;
+    while (high - low > kFrontendArenaAlignment) {
+        const size_t middle = (low + high) / 2 / kFrontendArenaAlignment * kFrontendArenaAlignment;
+        if (PopulatesIn(middle, &arena_used)) {
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+    PopulatesIn(high, &arena_used);
+    int32_t error_num = 0;
+    if (high != MicroFeaturesGenerator::kArenaSize || arena_used != kMicroFeaturesArenaUsed) error_num++;
+    printf("[%s] arena: peak %d (kArenaSize %d), in use %d (kMicroFeaturesArenaUsed %d)\n", error_num == 0 ? "OK" : "NG",
+        static_cast<int32_t>(high), static_cast<int32_t>(MicroFeaturesGenerator::kArenaSize),
+        static_cast<int32_t>(arena_used), static_cast<int32_t>(kMicroFeaturesArenaUsed));
+
+    tflite::ErrorReporter error_reporter;
+    MicroFeaturesGenerator generator;
+    alignas(kFrontendArenaAlignment) static uint8_t arena[MicroFeaturesGenerator::kArenaSize];
+    if (generator.Initialize(&error_reporter, arena, sizeof(arena) - kFrontendArenaAlignment) == kTfLiteOk) {
+        printf("[NG] Initialize accepts a smaller arena\n");
+        error_num++;
+    }
+    if (generator.Initialize(&error_reporter, arena, sizeof(arena)) != kTfLiteOk || generator.arena_used() != kMicroFeaturesArenaUsed) {
+        printf("[NG] Initialize with kArenaSize\n");
+        error_num++;
+    }
+    return error_num;
+}
+
+/* Converts the whole audio at once */
+std::vector<int8_t> GenerateAll(const std::vector<int16_t>& audio)
+{
+    tflite::ErrorReporter error_reporter;
+    MicroFeaturesGenerator generator;
+    alignas(kFrontendArenaAlignment) uint8_t arena[MicroFeaturesGenerator::kArenaSize];
+    generator.Initialize(&error_reporter, arena, sizeof(arena));
+    const int32_t max_slices = (static_cast<int32_t>(audio.size()) - kWindowSize) / kWindowStep + 1;
+    std::vector<int8_t> features(max_slices * kFeatureSliceSize);
+    int num_slices = 0;
+    generator.GenerateBatch(&error_reporter, audio.data(), static_cast<int>(audio.size()), features.data(), max_slices, &num_slices);
+    features.resize(num_slices * kFeatureSliceSize);
+    return features;
+}
+
+/* Feeds the audio in chunks of 1 - 7 slices ( and a part of the next one ) */
+std::vector<int8_t> GenerateInChunks(const std::vector<int16_t>& audio, uint32_t seed)
+{
+    tflite::ErrorReporter error_reporter;
+    MicroFeaturesGenerator generator;
+    alignas(kFrontendArenaAlignment) uint8_t arena[MicroFeaturesGenerator::kArenaSize];
+    generator.Initialize(&error_reporter, arena, sizeof(arena));
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int32_t> slice_num_dist(1, 7);
+    std::uniform_int_distribution<int32_t> extra_dist(0, kWindowStep - 1);
+    std::vector<int8_t> features;
+    std::vector<int8_t> chunk_features;
+    const int32_t sample_num = static_cast<int32_t>(audio.size());
+    int32_t slice_start = 0;
+    while (slice_start + kWindowSize <= sample_num) {
+        const int32_t max_slices = slice_num_dist(rng);
+        const int32_t chunk_size = std::min(sample_num - slice_start, kWindowSize + (max_slices - 1) * kWindowStep + extra_dist(rng));
+        chunk_features.resize(max_slices * kFeatureSliceSize);
+        int num_slices = 0;
+        generator.GenerateBatch(&error_reporter, audio.data() + slice_start, chunk_size, chunk_features.data(), max_slices, &num_slices);
+        if (num_slices == 0) break;
+        features.insert(features.end(), chunk_features.begin(), chunk_features.begin() + num_slices * kFeatureSliceSize);
+        slice_start += num_slices * kWindowStep;
+    }
+    return features;
+}
+
+int32_t TestInstances(int32_t run_num)
+{
+    std::vector<std::vector<int16_t>> audio_list;
+    std::vector<std::vector<int8_t>> expected_list;
+    for (int32_t instance = 0; instance < kInstanceNum; instance++) {
+        std::mt19937 rng(100 + instance);
+        audio_list.push_back(GenerateTestAudio(kAudioSampleNum + instance * 1000, kAudioSampleFrequency, rng));
+        expected_list.push_back(GenerateAll(audio_list.back()));
+    }
+
+    int32_t mismatch_num = 0;
+    for (int32_t run = 0; run < run_num; run++) {
+        std::vector<std::vector<int8_t>> result_list(kInstanceNum);
+        std::vector<std::thread> thread_list;
+        for (int32_t instance = 0; instance < kInstanceNum; instance++) {
+            thread_list.emplace_back([&, instance]() {
+                result_list[instance] = GenerateInChunks(audio_list[instance], run * kInstanceNum + instance);
+            });
+        }
+        for (auto& thread : thread_list) thread.join();
+        for (int32_t instance = 0; instance < kInstanceNum; instance++) {
+            if (result_list[instance] != expected_list[instance]) mismatch_num++;
+        }
+    }
+    printf("[%s] %d instances x %d runs: %d mismatch (%d slices each)\n", mismatch_num == 0 ? "OK" : "NG",
+        kInstanceNum, run_num, mismatch_num, static_cast<int32_t>(expected_list[0].size() / kFeatureSliceSize));
+    return mismatch_num;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int32_t run_num = (argc > 1) ? atoi(argv[1]) : 10;
+    int32_t error_num = 0;
+    error_num += TestArena();
+    error_num += TestInstances(run_num);
+    printf("%s\n", error_num == 0 ? "PASSED" : "FAILED");
+    return error_num == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** NoiseReductionApply and PcanGainControlApply benchmark
+ * nsec per frame ( the frontend configuration, 40 channels ): the reference ( reference/noise_reduction_pcan_reference.h ) vs the kernels
+ * noise_reduction_pcan_bench uses the SIMD kernels if the host has them, and noise_reduction_pcan_scalar_bench the scalar ones
+ * The best of the runs is shown. The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/noise_reduction_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/pcan_gain_control_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/simd.h"
+#include "micro_features/micro_features_frontend.h"
+#include "reference/noise_reduction_pcan_reference.h"
+
+namespace {
+
+constexpr int32_t kFrameNum = 256;
+constexpr int32_t kRunNum = 200;
+constexpr int32_t kCorrectionBits = 3;
+
+double ElapsedNs(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main()
+{
+    FrontendConfig config;
+    FillMicroFeaturesFrontendConfig(&config);
+    const int32_t channel_num = config.filterbank.num_channels;
+    NoiseReductionState noise_reduction[2];
+    PcanGainControlState pcan[2];
+    for (int32_t i = 0; i < 2; i++) {
+        if (!NoiseReductionPopulateState(&config.noise_reduction, &noise_reduction[i], channel_num)
+            || !PcanGainControlPopulateState(&config.pcan_gain_control, &pcan[i], noise_reduction[i].estimate, channel_num, config.noise_reduction.smoothing_bits, kCorrectionBits)) {
+            printf("PopulateState failed\n");
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(5);
+    std::vector<std::vector<uint32_t>> frames(kFrameNum, std::vector<uint32_t>(channel_num));
+    for (auto& frame : frames) {
+        for (auto& value : frame) value = rng() >> (8 + rng() % 12);
+    }
+    /* Each kernel is timed over all frames: noise reduction in place, then PCAN on its output */
+    std::vector<std::vector<uint32_t>> signals;
+    double time_noise_reduction[2] = { 1e30, 1e30 };
+    double time_pcan[2] = { 1e30, 1e30 };
+    for (int32_t run = 0; run < kRunNum; run++) {
+        for (int32_t order = 0; order < 2; order++) {
+            const int32_t is_reference = (run + order) & 1;
+            signals = frames;
+            auto t0 = std::chrono::steady_clock::now();
+            for (auto& signal : signals) {
+                if (is_reference) {
+                    reference::NoiseReductionApply(&noise_reduction[1], signal.data());
+                } else {
+                    NoiseReductionApply(&noise_reduction[0], signal.data());
+                }
+            }
+            time_noise_reduction[is_reference] = std::min(time_noise_reduction[is_reference], ElapsedNs(t0) / kFrameNum);
+            t0 = std::chrono::steady_clock::now();
+            for (auto& signal : signals) {
+                if (is_reference) {
+                    reference::PcanGainControlApply(&pcan[1], signal.data());
+                } else {
+                    PcanGainControlApply(&pcan[0], signal.data());
+                }
+            }
+            time_pcan[is_reference] = std::min(time_pcan[is_reference], ElapsedNs(t0) / kFrameNum);
+        }
+    }
+#if defined(MICROFRONTEND_SIMD)
+    const char* kernel = "SIMD";
+#else
+    const char* kernel = "scalar";
+#endif
+    printf("noise reduction: reference %.0f nsec, %s %.0f nsec (x%.2f)\n", time_noise_reduction[1], kernel, time_noise_reduction[0], time_noise_reduction[1] / time_noise_reduction[0]);
+    printf("pcan           : reference %.0f nsec, %s %.0f nsec (x%.2f)\n", time_pcan[1], kernel, time_pcan[0], time_pcan[1] / time_pcan[0]);
+    for (int32_t i = 0; i < 2; i++) {
+        NoiseReductionFreeStateContents(&noise_reduction[i]);
+        PcanGainControlFreeStateContents(&pcan[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** NoiseReductionApply and PcanGainControlApply golden test
+ * The kernels must be bit-exact with the C code before them ( reference/noise_reduction_pcan_reference.h )
+ *   - configurations: the one of the frontend, and random ones ( 1 - 45 channels, smoothing up to 3.9, various gain_bits, strength and offset )
+ *     smoothing over 1.0 and snr_shift over 16 take the 64-bit fallback of the scalar kernels
+ *   - signals: random 32-bit values of various magnitudes. The noise estimate is compared as well
+ * noise_reduction_pcan_test uses the SIMD kernels if the host has them, and noise_reduction_pcan_scalar_test the scalar ones ( as the device )
+ *   - usage: noise_reduction_pcan_test [config_num] [frame_num]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <random>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/noise_reduction_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/pcan_gain_control_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/simd.h"
+#include "micro_features/micro_features_frontend.h"
+#include "reference/noise_reduction_pcan_reference.h"
+
+namespace {
+
+/* The correction bits of the frontend ( FrontendPopulateState ) for 512-point FFT */
+constexpr int32_t kCorrectionBits = 3;
+
+void GenerateConfig(int32_t config_index, std::mt19937& rng, NoiseReductionConfig& noise_reduction, PcanGainControlConfig& pcan, int32_t& channel_num)
+{
+    FrontendConfig frontend;
+    FillMicroFeaturesFrontendConfig(&frontend);
+    noise_reduction = frontend.noise_reduction;
+    pcan = frontend.pcan_gain_control;
+    pcan.enable_pcan = 1;
+    channel_num = frontend.filterbank.num_channels;
+    if (config_index == 0) return;
+
+    channel_num = 1 + rng() % 45;
+    noise_reduction.smoothing_bits = rng() % 16;
+    noise_reduction.even_smoothing = (rng() % 1000) / 1000.0f * ((config_index % 7 == 0) ? 3.9f : 1.0f);
+    noise_reduction.odd_smoothing = (rng() % 1000) / 1000.0f * ((config_index % 5 == 0) ? 3.9f : 1.0f);
+    noise_reduction.min_signal_remaining = (rng() % 1000) / 1000.0f * ((config_index % 3 == 0) ? 3.9f : 1.0f);
+    pcan.gain_bits = 14 + rng() % 10;
+    pcan.strength = 0.5f + (rng() % 50) / 100.0f;
+    pcan.offset = 1.0f + rng() % 200;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int32_t config_num = (argc > 1) ? atoi(argv[1]) : 100;
+    const int32_t frame_num = (argc > 2) ? atoi(argv[2]) : 2000;
+#if defined(MICROFRONTEND_SIMD)
+    printf("SIMD kernels\n");
+#else
+    printf("scalar kernels\n");
+#endif
+    std::mt19937 rng(5);
+    int64_t checked_num = 0;
+    int64_t mismatch_num = 0;
+    for (int32_t config_index = 0; config_index < config_num; config_index++) {
+        NoiseReductionConfig noise_reduction_config;
+        PcanGainControlConfig pcan_config;
+        int32_t channel_num;
+        GenerateConfig(config_index, rng, noise_reduction_config, pcan_config, channel_num);
+
+        NoiseReductionState noise_reduction;
+        NoiseReductionState noise_reduction_reference;
+        PcanGainControlState pcan;
+        PcanGainControlState pcan_reference;
+        if (!NoiseReductionPopulateState(&noise_reduction_config, &noise_reduction, channel_num)
+            || !NoiseReductionPopulateState(&noise_reduction_config, &noise_reduction_reference, channel_num)
+            || !PcanGainControlPopulateState(&pcan_config, &pcan, noise_reduction.estimate, channel_num, noise_reduction_config.smoothing_bits, kCorrectionBits)
+            || !PcanGainControlPopulateState(&pcan_config, &pcan_reference, noise_reduction_reference.estimate, channel_num, noise_reduction_config.smoothing_bits, kCorrectionBits)) {
+            printf("[NG] PopulateState failed\n");
+            return 1;
+        }
+        /* PCAN is not defined for a negative snr_shift ( the frontend doesn't use such a configuration ) */
+        const bool use_pcan = pcan.snr_shift >= 0;
+
+        std::vector<uint32_t> signal(channel_num);
+        std::vector<uint32_t> signal_reference(channel_num);
+        for (int32_t frame = 0; frame < frame_num; frame++) {
+            for (int32_t i = 0; i < channel_num; i++) {
+                uint32_t value = rng();
+                switch (frame % 4) {
+                case 0: value >>= rng() % 32; break;
+                case 1: value &= 0xFFFF; break;
+                case 2: value >>= 10; break;
+                default: break;
+                }
+                signal[i] = value;
+                signal_reference[i] = value;
+            }
+            checked_num++;
+            NoiseReductionApply(&noise_reduction, signal.data());
+            reference::NoiseReductionApply(&noise_reduction_reference, signal_reference.data());
+            if (memcmp(signal.data(), signal_reference.data(), channel_num * sizeof(uint32_t)) != 0
+                || memcmp(noise_reduction.estimate, noise_reduction_reference.estimate, channel_num * sizeof(uint32_t)) != 0) {
+                mismatch_num++;
+                continue;
+            }
+            if (!use_pcan) continue;
+            PcanGainControlApply(&pcan, signal.data());
+            reference::PcanGainControlApply(&pcan_reference, signal_reference.data());
+            if (memcmp(signal.data(), signal_reference.data(), channel_num * sizeof(uint32_t)) != 0) mismatch_num++;
+        }
+        NoiseReductionFreeStateContents(&noise_reduction);
+        NoiseReductionFreeStateContents(&noise_reduction_reference);
+        PcanGainControlFreeStateContents(&pcan);
+        PcanGainControlFreeStateContents(&pcan_reference);
+    }
+    printf("%lld frames in %d configurations, %lld mismatch\n", static_cast<long long>(checked_num), config_num, static_cast<long long>(mismatch_num));
+    printf("%s\n", mismatch_num == 0 ? "PASSED" : "FAILED");
+    return mismatch_num == 0 ? 0 : 1;
+}
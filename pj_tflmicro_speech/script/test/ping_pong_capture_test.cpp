@@ -0,0 +1,137 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** PingPongCapture test with a fake DMA
+ *   - FakeDma writes one sample (= the sample index) at a time into the block of the active channel, and switches to the other channel
+ *     at the end of the block as the chained DMA channels do. The finished channel raises its interrupt flag
+ *   - The IRQ handler runs with a random latency shorter than one block, and the consumer reads at a random rate and sometimes stalls
+ *     so that the ring block buffer overflows
+ *   - Checks: no gap inside a block, the stamp is the sample index of the first sample,
+ *     and the blocks skipped by the consumer are exactly the blocks reported as overrun
+ *   - usage: ping_pong_capture_test [seed] [sample_num]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ping_pong_capture.h"
+
+namespace {
+
+constexpr int32_t kBlockSize = 16;
+
+class FakeDma : public PingPongDma {
+public:
+    FakeDma() : dst_{nullptr, nullptr}, current_(nullptr), active_(0), pos_(0), is_finished_{false, false} {}
+
+    void SetWriteAddress(int32_t channel_index, void* dst) override {
+        dst_[channel_index] = static_cast<uint32_t*>(dst);
+    }
+
+    void Start() override {
+        active_ = 0;
+        pos_ = 0;
+        current_ = dst_[0];
+    }
+
+    /* The write address is latched when the channel is triggered by the other one (= at the end of the other block) */
+    void Transfer(uint32_t sample) {
+        current_[pos_++] = sample;
+        if (pos_ == kBlockSize) {
+            is_finished_[active_] = true;
+            active_ ^= 1;
+            current_ = dst_[active_];
+            pos_ = 0;
+        }
+    }
+
+    bool IsPending() const {
+        return is_finished_[0] || is_finished_[1];
+    }
+
+    bool IsFinished(int32_t channel_index) const {
+        return is_finished_[channel_index];
+    }
+
+    void ClearInterrupt(int32_t channel_index) {
+        is_finished_[channel_index] = false;
+    }
+
+private:
+    uint32_t* dst_[2];
+    uint32_t* current_;
+    int32_t active_;
+    int32_t pos_;
+    bool is_finished_[2];
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t seed = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 1;
+    const uint32_t sample_num = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], NULL, 10)) : 2000000;
+    srand(seed);
+
+    static StaticRingBlockBuffer<uint32_t, 8, kBlockSize> ring;
+    FakeDma dma;
+    PingPongCapture<uint32_t> capture;
+    capture.Initialize(&ring, &dma);
+    capture.Start();
+
+    uint32_t expected_sample = 0;
+    int32_t overrun_num = 0;
+    int32_t dropped_num = 0;
+    int32_t read_num = 0;
+    int32_t error_num = 0;
+    int32_t irq_delay = -1;
+    for (uint32_t sample = 0; sample < sample_num; sample++) {
+        dma.Transfer(sample);
+
+        /* IRQ */
+        if (dma.IsPending() && irq_delay < 0) irq_delay = rand() % (kBlockSize - 1);
+        if (irq_delay >= 0 && irq_delay-- == 0) {
+            while (dma.IsFinished(capture.next_channel_index())) {
+                dma.ClearInterrupt(capture.next_channel_index());
+                if (!capture.OnBlockFinished(sample)) overrun_num++;
+            }
+            irq_delay = -1;
+        }
+
+        /* Consumer. It stalls in one third of the time (except the last 20%) */
+        const bool is_stalled = (sample < sample_num / 5 * 4) && ((sample / 20000) % 3 == 0);
+        const int32_t burst = is_stalled ? 0 : 1 + rand() % 3;
+        for (int32_t k = 0; k < burst && !ring.IsUnderflow() && rand() % 4 == 0; k++) {
+            if (ring.ReferStamp(0).sample_index != ring.ReferPtr(0)[0]) error_num++;
+            const uint32_t* block = ring.ReadPtr();
+            read_num++;
+            if (block[0] != expected_sample) {
+                if (block[0] < expected_sample || (block[0] - expected_sample) % kBlockSize != 0) error_num++;
+                dropped_num += (block[0] - expected_sample) / kBlockSize;
+            }
+            for (int32_t i = 0; i < kBlockSize; i++) {
+                if (block[i] != block[0] + i) error_num++;
+            }
+            expected_sample = block[0] + kBlockSize;
+        }
+    }
+
+    /* The consumer doesn't stall at the end, so every overrun is seen as skipped blocks */
+    const bool ok = error_num == 0 && overrun_num > 0 && dropped_num == overrun_num;
+    printf("read = %d, dropped = %d, overrun = %d, error = %d\n", read_num, dropped_num, overrun_num, error_num);
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** RingBlockBuffer benchmark
+ * Compares the lock-free RingBlockBuffer with the one before ( reference/legacy_ring_block_buffer.h ) in the audio configuration ( 512 x uint8_t blocks )
+ * and the heap version with StaticRingBlockBuffer ( compile-time size )
+ *   - single thread: nsec per operation of each path ( write = WritePtr + 1 Byte store, refer = ReferPtr + load, read = ReadPtr + load )
+ *   - SPSC ( lock-free version only ): blocks per second passed from a producer thread to a consumer thread
+ * The numbers are of the host. Only the ratio is meaningful for the device
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "ring_block_buffer.h"
+#include "reference/legacy_ring_block_buffer.h"
+
+namespace {
+
+constexpr int32_t kBlockNum = 16;
+constexpr int32_t kBlockSize = 512;
+constexpr int32_t kLoopNum = 2000000;
+
+volatile uint32_t s_sink;
+
+double ElapsedNs(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Overhead of a pair of steady_clock::now() calls, subtracted from each measurement */
+double MeasureTimerOverheadNs()
+{
+    double time = 0;
+    for (int32_t loop = 0; loop < kLoopNum; loop++) {
+        const auto t0 = std::chrono::steady_clock::now();
+        time += ElapsedNs(t0);
+    }
+    return time / kLoopNum;
+}
+
+template<class RING>
+void BenchSingleThread(const char* name, RING& ring, double timer_overhead)
+{
+    /* Each measurement covers kBatchNum operations, and the ring goes between kBatchNum and 2 * kBatchNum blocks stored */
+    constexpr int32_t kBatchNum = kBlockNum / 2;
+    for (int32_t i = 0; i < kBatchNum; i++) memset(ring.WritePtr(), 0, kBlockSize);
+
+    double time_write = 0;
+    double time_refer = 0;
+    double time_read = 0;
+    uint32_t sum = 0;
+    for (int32_t loop = 0; loop < kLoopNum / kBatchNum; loop++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < kBatchNum; i++) ring.WritePtr()[i] = static_cast<uint8_t>(loop);
+        time_write += ElapsedNs(t0) - timer_overhead;
+
+        t0 = std::chrono::steady_clock::now();
+        for (int32_t pos = 0; pos < kBatchNum; pos++) sum += ring.ReferPtr(pos)[pos];
+        time_refer += ElapsedNs(t0) - timer_overhead;
+
+        t0 = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < kBatchNum; i++) sum += ring.ReadPtr()[i];
+        time_read += ElapsedNs(t0) - timer_overhead;
+    }
+    s_sink = sum;
+    const int32_t op_num = kLoopNum / kBatchNum * kBatchNum;
+    printf("%-24s write %6.2f nsec, refer %6.2f nsec, read %6.2f nsec\n", name,
+        time_write / op_num, time_refer / op_num, time_read / op_num);
+}
+
+void BenchSpsc()
+{
+    constexpr uint32_t kBlockNumToPass = 2000000;
+    RingBlockBuffer<uint8_t> ring;
+    ring.Initialize(kBlockNum, kBlockSize);
+    const auto t0 = std::chrono::steady_clock::now();
+    std::thread producer([&]() {
+        for (uint32_t block = 0; block < kBlockNumToPass; ) {
+            uint8_t* ptr = ring.ReservePtr(0);
+            if (ptr == NULL) {
+                std::this_thread::yield();
+                continue;
+            }
+            ptr[0] = static_cast<uint8_t>(block);
+            ring.Commit();
+            block++;
+        }
+    });
+    uint32_t sum = 0;
+    for (uint32_t block = 0; block < kBlockNumToPass; ) {
+        if (ring.IsUnderflow()) {
+            std::this_thread::yield();
+            continue;
+        }
+        sum += ring.ReadPtr()[0];
+        block++;
+    }
+    producer.join();
+    s_sink = sum;
+    const double sec = ElapsedNs(t0) * 1e-9;
+    printf("%-24s %.1f M blocks/sec\n", "SPSC (2 threads)", kBlockNumToPass / sec * 1e-6);
+}
+
+}
+
+int main()
+{
+    static LegacyRingBlockBuffer<uint8_t> legacy_ring;
+    static RingBlockBuffer<uint8_t> ring;
+    static StaticRingBlockBuffer<uint8_t, kBlockNum, kBlockSize> static_ring;
+    legacy_ring.Initialize(kBlockNum, kBlockSize);
+    ring.Initialize(kBlockNum, kBlockSize);
+    const double timer_overhead = MeasureTimerOverheadNs();
+    printf("%d blocks x %d Byte, %d operations each (timer overhead %.1f nsec is subtracted)\n", kBlockNum, kBlockSize, kLoopNum, timer_overhead);
+    BenchSingleThread("LegacyRingBlockBuffer", legacy_ring, timer_overhead);
+    BenchSingleThread("RingBlockBuffer", ring, timer_overhead);
+    BenchSingleThread("StaticRingBlockBuffer", static_ring, timer_overhead);
+    printf("%-24s object %d Byte + heap %d Byte\n", "RingBlockBuffer", static_cast<int32_t>(sizeof(ring)),
+        static_cast<int32_t>(kBlockNum * kBlockSize + kBlockNum * sizeof(BlockStamp)));
+    printf("%-24s object %d Byte + heap 0 Byte\n", "StaticRingBlockBuffer", static_cast<int32_t>(sizeof(static_ring)));
+    BenchSpsc();
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** RingBlockBuffer test
+ *   - capacity: the number of blocks is rounded up to 2^x, and all of them can be used
+ *   - StaticRingBlockBuffer: the blocks are in the object, and Initialize() empties it
+ *   - SPSC stress: a producer thread and a consumer thread pass blocks filled with sequence numbers
+ *     - the producer fills a reserved block and commits it ( as DMA does ), or uses Write
+ *     - the consumer checks that no block is lost, duplicated or torn, and that the stamps match
+ *   - usage: ring_block_buffer_test [block_num_to_pass]
+ ***/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <type_traits>
+
+#include "ring_block_buffer.h"
+
+namespace {
+
+constexpr int32_t kBlockSize = 64;
+
+int32_t TestCapacity()
+{
+    RingBlockBuffer<uint32_t> ring;
+    ring.Initialize(10, kBlockSize);
+    if (ring.block_num() != 16) {
+        printf("[NG] block_num = %d (expected 16)\n", ring.block_num());
+        return 1;
+    }
+    int32_t stored = 0;
+    while (ring.ReservePtr(0) != NULL) {
+        ring.Commit();
+        stored++;
+        if (stored > 100) break;
+    }
+    if (stored != 16 || !ring.IsOverflow() || ring.WritePtr() != NULL) {
+        printf("[NG] %d blocks stored before overflow (expected 16)\n", stored);
+        return 1;
+    }
+    while (!ring.IsUnderflow()) ring.ReadPtr();
+    if (ring.accumulated_stored_data_num() != 16 || ring.accumulated_read_data_num() != 16) {
+        printf("[NG] accumulated counters: %d %d\n", ring.accumulated_stored_data_num(), ring.accumulated_read_data_num());
+        return 1;
+    }
+    printf("[OK] capacity\n");
+    return 0;
+}
+
+int32_t TestStatic()
+{
+    using StaticRing = StaticRingBlockBuffer<uint16_t, 4, kBlockSize>;
+    static_assert(!std::is_copy_constructible<StaticRing>::value && !std::is_copy_assignable<StaticRing>::value, "must not be copyable");
+    static StaticRing ring;
+    const uint8_t* object_begin = reinterpret_cast<const uint8_t*>(&ring);
+    const uint8_t* object_end = object_begin + sizeof(ring);
+    for (int32_t i = 0; i < 4; i++) {
+        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(ring.ReservePtr(0));
+        if (ptr == NULL || ptr < object_begin || ptr + kBlockSize * sizeof(uint16_t) > object_end || reinterpret_cast<uintptr_t>(ptr) % 4 != 0) {
+            printf("[NG] static block %d is not in the object\n", i);
+            return 1;
+        }
+        ring.Commit();
+    }
+    ring.Initialize();
+    if (ring.block_num() != 4 || ring.block_size() != kBlockSize || !ring.IsUnderflow() || ring.WritePtr() == NULL) {
+        printf("[NG] static ring after Initialize\n");
+        return 1;
+    }
+    printf("[OK] StaticRingBlockBuffer\n");
+    return 0;
+}
+
+template<class T>
+int32_t TestSpsc(int32_t buffer_size, uint32_t block_num_to_pass, bool use_write)
+{
+    RingBlockBuffer<T> ring;
+    ring.Initialize(buffer_size, kBlockSize);
+    const T mask = static_cast<T>(~T(0));
+
+    std::thread producer([&]() {
+        std::vector<T> data(kBlockSize);
+        for (uint32_t block = 0; block < block_num_to_pass; ) {
+            if (use_write) {
+                if (ring.IsOverflow()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (int32_t i = 0; i < kBlockSize; i++) data[i] = static_cast<T>((block * kBlockSize + i) & mask);
+                ring.Write(data, block);
+            } else {
+                T* ptr = ring.ReservePtr(0);
+                if (ptr == NULL) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (int32_t i = 0; i < kBlockSize; i++) ptr[i] = static_cast<T>((block * kBlockSize + i) & mask);
+                ring.Commit(block);
+            }
+            block++;
+        }
+    });
+
+    uint64_t torn_num = 0;
+    uint64_t stamp_error_num = 0;
+    for (uint32_t block = 0; block < block_num_to_pass; ) {
+        if (ring.IsUnderflow()) {
+            std::this_thread::yield();
+            continue;
+        }
+        const T* ptr = ring.ReferPtr(0);
+        const BlockStamp& stamp = ring.ReferStamp(0);
+        for (int32_t i = 0; i < kBlockSize; i++) {
+            if (ptr[i] != static_cast<T>((block * kBlockSize + i) & mask)) {
+                torn_num++;
+                break;
+            }
+        }
+        if (stamp.sample_index != static_cast<uint64_t>(block) * kBlockSize || stamp.time_us != block) stamp_error_num++;
+        ring.ReadPtr();
+        block++;
+    }
+    producer.join();
+
+    const bool ok = torn_num == 0 && stamp_error_num == 0 && ring.IsUnderflow()
+        && static_cast<uint32_t>(ring.accumulated_read_data_num()) == block_num_to_pass;
+    printf("[%s] SPSC %d-bit, %d blocks, %s: %u blocks passed, torn or lost = %llu, stamp error = %llu\n",
+        ok ? "OK" : "NG", static_cast<int32_t>(sizeof(T) * 8), ring.block_num(), use_write ? "Write" : "ReservePtr/Commit",
+        block_num_to_pass, static_cast<unsigned long long>(torn_num), static_cast<unsigned long long>(stamp_error_num));
+    return ok ? 0 : 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t block_num_to_pass = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 2000000;
+    int32_t error_num = 0;
+    error_num += TestCapacity();
+    error_num += TestStatic();
+    error_num += TestSpsc<uint32_t>(16, block_num_to_pass, false);
+    error_num += TestSpsc<uint32_t>(16, block_num_to_pass, true);
+    error_num += TestSpsc<uint16_t>(2, block_num_to_pass, false);
+    error_num += TestSpsc<uint8_t>(4, block_num_to_pass, false);
+    printf("%s\n", error_num == 0 ? "PASSED" : "FAILED");
+    return error_num == 0 ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*** Minimal stand-in of TFLM for the host tests ( the errors are printed to stdout ) ***/
+#ifndef TEST_STUB_TENSORFLOW_LITE_MICRO_MICRO_ERROR_REPORTER_H_
+#define TEST_STUB_TENSORFLOW_LITE_MICRO_MICRO_ERROR_REPORTER_H_
+
+#include <cstdio>
+
+namespace tflite {
+class ErrorReporter {};
+}
+
+#define TF_LITE_REPORT_ERROR(reporter, ...) \
+    ((void)(reporter), printf(__VA_ARGS__), printf("\n"))
+
+#endif
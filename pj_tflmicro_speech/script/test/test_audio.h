@@ -0,0 +1,51 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TEST_AUDIO_H_
+#define TEST_AUDIO_H_
+
+#include <cstdint>
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+/*** Synthetic audio for the frontend tests
+ * Segments of 0.5 sec are repeated: silence, quiet noise, noise, full scale sweep, Nyquist, clipping noise, impulses and tone with noise
+ ***/
+inline std::vector<int16_t> GenerateTestAudio(int32_t sample_num, int32_t sample_frequency, std::mt19937& rng)
+{
+    std::vector<int16_t> audio(sample_num);
+    std::normal_distribution<double> noise(0, 1);
+    for (int32_t i = 0; i < sample_num; i++) {
+        const double t = static_cast<double>(i) / sample_frequency;
+        double value = 0;
+        switch ((i / (sample_frequency / 2)) % 8) {
+        case 0: value = 0; break;
+        case 1: value = 30 * noise(rng); break;
+        case 2: value = 3000 * noise(rng); break;
+        case 3: value = 32767 * sin(2 * M_PI * (100 + 3000 * (t - floor(t))) * t); break;
+        case 4: value = (i & 1) ? 32767 : -32768; break;
+        case 5: value = 20000 * noise(rng); break;
+        case 6: value = (i % 480 == 0) ? 32767 : 0; break;
+        default: value = 1000 * sin(2 * M_PI * 440 * t) + 50 * noise(rng); break;
+        }
+        audio[i] = static_cast<int16_t>(std::max(-32768.0, std::min(32767.0, value)));
+    }
+    return audio;
+}
+
+#endif
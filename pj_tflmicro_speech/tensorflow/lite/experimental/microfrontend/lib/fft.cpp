@@ -18,6 +18,7 @@ limitations under the License.
 
 #define FIXED_POINT 16
 #include "kiss_fft.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_fixed.h"
 #include "tools/kiss_fftr.h"
 
 void FftCompute(struct FftState* state, const int16_t* input,
@@ -25,6 +26,13 @@ void FftCompute(struct FftState* state, const int16_t* input,
   const size_t input_size = state->input_size;
   const size_t fft_size = state->fft_size;
 
+  // The sizes specialized in fft_fixed.h read the input directly, and give
+  // the same result as kiss_fftr.
+  if (fft_fixed::Compute(fft_size, input, input_size, input_scale_shift,
+                         state->output)) {
+    return;
+  }
+
   int16_t* fft_input = state->input;
   // First, scale the input by the given shift.
   size_t i;
@@ -43,11 +51,20 @@ void FftCompute(struct FftState* state, const int16_t* input,
             reinterpret_cast<kiss_fft_cpx*>(state->output));
 }
 
+int FftComputeEnergy(struct FftState* state, const int16_t* input,
+                     int input_scale_shift, int start_index, int end_index) {
+  return fft_fixed::ComputeEnergy(state->fft_size, input, state->input_size,
+                                  input_scale_shift, start_index, end_index,
+                                  state->output);
+}
+
 void FftInit(struct FftState* state) {
   // All the initialization is done in FftPopulateState()
 }
 
 void FftReset(struct FftState* state) {
-  memset(state->input, 0, state->fft_size * sizeof(*state->input));
+  if (state->input != nullptr) {
+    memset(state->input, 0, state->fft_size * sizeof(*state->input));
+  }
   memset(state->output, 0, (state->fft_size / 2 + 1) * sizeof(*state->output));
 }
@@ -39,6 +39,13 @@ struct FftState {
 void FftCompute(struct FftState* state, const int16_t* input,
                 int input_scale_shift);
 
+// The same as FftCompute followed by FilterbankConvertFftComplexToEnergy, but
+// the energy of the bins in [start_index, end_index) is calculated while the
+// FFT writes its output. The energy is written into state->output as int32_t.
+// Returns 0 if the fft size is not supported, and nothing is calculated then.
+int FftComputeEnergy(struct FftState* state, const int16_t* input,
+                     int input_scale_shift, int start_index, int end_index);
+
 void FftInit(struct FftState* state);
 
 void FftReset(struct FftState* state);
@@ -18,29 +18,45 @@ limitations under the License.
 
 #define FIXED_POINT 16
 #include "kiss_fft.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_fixed.h"
 #include "tools/kiss_fftr.h"
 
 int FftPopulateState(struct FftState* state, size_t input_size) {
+  return FftPopulateStateInArena(state, input_size, nullptr);
+}
+
+int FftPopulateStateInArena(struct FftState* state, size_t input_size,
+                            struct FrontendArena* arena) {
   state->input_size = input_size;
   state->fft_size = 1;
   while (state->fft_size < state->input_size) {
     state->fft_size <<= 1;
   }
 
-  state->input = reinterpret_cast<int16_t*>(
-      malloc(state->fft_size * sizeof(*state->input)));
-  if (state->input == nullptr) {
-    fprintf(stderr, "Failed to alloc fft input buffer\n");
-    return 0;
-  }
-
   state->output = reinterpret_cast<complex_int16_t*>(
-      malloc((state->fft_size / 2 + 1) * sizeof(*state->output) * 2));
+      FrontendArenaAlloc(arena, (state->fft_size / 2 + 1) *
+                                    sizeof(*state->output) * 2));
   if (state->output == nullptr) {
     fprintf(stderr, "Failed to alloc fft output buffer\n");
     return 0;
   }
 
+  // The specialized FFT has its tables in flash and reads the input directly,
+  // so it needs neither the input buffer nor the scratch.
+  state->input = nullptr;
+  state->scratch = nullptr;
+  state->scratch_size = 0;
+  if (fft_fixed::IsSupported(state->fft_size)) {
+    return 1;
+  }
+
+  state->input = reinterpret_cast<int16_t*>(
+      FrontendArenaAlloc(arena, state->fft_size * sizeof(*state->input)));
+  if (state->input == nullptr) {
+    fprintf(stderr, "Failed to alloc fft input buffer\n");
+    return 0;
+  }
+
   // Ask kissfft how much memory it wants.
   size_t scratch_size = 0;
   kiss_fftr_cfg kfft_cfg = kiss_fftr_alloc(
@@ -49,7 +65,7 @@ int FftPopulateState(struct FftState* state, size_t input_size) {
     fprintf(stderr, "Kiss memory sizing failed.\n");
     return 0;
   }
-  state->scratch = malloc(scratch_size);
+  state->scratch = FrontendArenaAlloc(arena, scratch_size);
   if (state->scratch == nullptr) {
     fprintf(stderr, "Failed to alloc fft scratch buffer\n");
     return 0;
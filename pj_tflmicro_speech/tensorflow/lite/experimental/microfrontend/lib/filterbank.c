@@ -16,7 +16,7 @@ limitations under the License.
 
 #include <string.h>
 
-#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/integer_math.h"
 
 void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
                                          struct complex_int16_t* fft_output,
@@ -36,6 +36,11 @@ void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
 
 void FilterbankAccumulateChannels(struct FilterbankState* state,
                                   const int32_t* energy) {
+  if (state->use_fixed_table) {
+    FilterbankAccumulateChannelsFixed(state, energy);
+    return;
+  }
+
   uint64_t* work = state->work;
   uint64_t weight_accumulator = 0;
   uint64_t unweight_accumulator = 0;
@@ -63,59 +68,6 @@ void FilterbankAccumulateChannels(struct FilterbankState* state,
   }
 }
 
-static uint16_t Sqrt32(uint32_t num) {
-  if (num == 0) {
-    return 0;
-  }
-  uint32_t res = 0;
-  int max_bit_number = 32 - MostSignificantBit32(num);
-  max_bit_number |= 1;
-  uint32_t bit = 1U << (31 - max_bit_number);
-  int iterations = (31 - max_bit_number) / 2 + 1;
-  while (iterations--) {
-    if (num >= res + bit) {
-      num -= res + bit;
-      res = (res >> 1U) + bit;
-    } else {
-      res >>= 1U;
-    }
-    bit >>= 2U;
-  }
-  // Do rounding - if we have the bits.
-  if (num > res && res != 0xFFFF) {
-    ++res;
-  }
-  return res;
-}
-
-static uint32_t Sqrt64(uint64_t num) {
-  // Take a shortcut and just use 32 bit operations if the upper word is all
-  // clear. This will cause a slight off by one issue for numbers close to 2^32,
-  // but it probably isn't going to matter (and gives us a big performance win).
-  if ((num >> 32) == 0) {
-    return Sqrt32((uint32_t)num);
-  }
-  uint64_t res = 0;
-  int max_bit_number = 64 - MostSignificantBit64(num);
-  max_bit_number |= 1;
-  uint64_t bit = 1ULL << (63 - max_bit_number);
-  int iterations = (63 - max_bit_number) / 2 + 1;
-  while (iterations--) {
-    if (num >= res + bit) {
-      num -= res + bit;
-      res = (res >> 1U) + bit;
-    } else {
-      res >>= 1U;
-    }
-    bit >>= 2U;
-  }
-  // Do rounding - if we have the bits.
-  if (num > res && res != 0xFFFFFFFFLL) {
-    ++res;
-  }
-  return res;
-}
-
 uint32_t* FilterbankSqrt(struct FilterbankState* state, int scale_down_shift) {
   const int num_channels = state->num_channels;
   const uint64_t* work = state->work + 1;
@@ -123,8 +75,22 @@ uint32_t* FilterbankSqrt(struct FilterbankState* state, int scale_down_shift) {
   // the output.
   uint32_t* output = (uint32_t*)state->work;
   int i;
-  for (i = 0; i < num_channels; ++i) {
-    *output++ = Sqrt64(*work++) >> scale_down_shift;
+  // Four channels at a time. All the inputs are read before the outputs are
+  // written, because output[3] overlaps work[1].
+  for (i = 0; i + 4 <= num_channels; i += 4) {
+    const uint64_t work0 = work[0];
+    const uint64_t work1 = work[1];
+    const uint64_t work2 = work[2];
+    const uint64_t work3 = work[3];
+    output[0] = IntegerSqrt64(work0) >> scale_down_shift;
+    output[1] = IntegerSqrt64(work1) >> scale_down_shift;
+    output[2] = IntegerSqrt64(work2) >> scale_down_shift;
+    output[3] = IntegerSqrt64(work3) >> scale_down_shift;
+    work += 4;
+    output += 4;
+  }
+  for (; i < num_channels; ++i) {
+    *output++ = IntegerSqrt64(*work++) >> scale_down_shift;
   }
   return (uint32_t*)state->work;
 }
@@ -0,0 +1,69 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank_fixed.h"
+
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank.h"
+
+namespace filterbank_fixed {
+
+bool Matches(const FilterbankState& state) {
+  if (state.num_channels != kNumChannels || state.start_index != kStartIndex ||
+      state.end_index != kEndIndex) {
+    return false;
+  }
+  const int16_t* table = kTable.data();
+  int bin = kStartIndex;
+  for (int chan = 0; chan < kNumChannels + 1; ++chan) {
+    const int width = *table++;
+    const int16_t* weights = table;
+    table += width;
+    // Every slot of the padded channel must have the weight of the bin in the
+    // table, or zero (for both weight and unweight) if the bin is not in the
+    // channel.
+    const int frequency_start = state.channel_frequency_starts[chan];
+    const int weight_start = state.channel_weight_starts[chan];
+    const int padded_width = state.channel_widths[chan];
+    if (width > 0 &&
+        (bin < frequency_start || bin + width > frequency_start + padded_width)) {
+      return false;
+    }
+    for (int j = 0; j < padded_width; ++j) {
+      const int frequency = frequency_start + j;
+      int16_t weight = 0;
+      int16_t unweight = 0;
+      if (width > 0 && frequency >= bin && frequency < bin + width) {
+        weight = weights[frequency - bin];
+        unweight = (1 << kFilterbankBits) - weight;
+      }
+      if (state.weights[weight_start + j] != weight ||
+          state.unweights[weight_start + j] != unweight) {
+        return false;
+      }
+    }
+    bin += width;
+  }
+  return true;
+}
+
+}  // namespace filterbank_fixed
+
+int FilterbankMatchesFixedTable(const struct FilterbankState* state) {
+  return filterbank_fixed::Matches(*state) ? 1 : 0;
+}
+
+void FilterbankAccumulateChannelsFixed(struct FilterbankState* state,
+                                       const int32_t* energy) {
+  filterbank_fixed::AccumulateChannels(energy, state->work);
+}
@@ -0,0 +1,290 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FILTERBANK_FIXED_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FILTERBANK_FIXED_H_
+
+// Mel filterbank specialized for the configuration of micro_speech (40
+// channels, 125 - 7500 Hz, 16 kHz, 512-point FFT).
+//
+// The channels calculated by FilterbankPopulateState tile the spectrum: each
+// frequency bin in [start_index, end_index) belongs to exactly one channel,
+// and its unweight is (1 << kFilterbankBits) - weight. So the table here
+// doesn't need the per-channel starts, the alignment padding and the
+// unweights:
+//   - The table is one stream of the width of the channel followed by the
+//     weights of its bins, for each channel. It's constexpr (in flash), and
+//     is calculated at compile time in the same way (and with the same float
+//     precision) as FilterbankPopulateState calculates it at runtime.
+//   - The unweighted sum of a channel is calculated as
+//     (sum of energy << kFilterbankBits) - weighted sum, so only one multiply
+//     is needed per bin.
+//   - On 32-bit targets, the sums are accumulated in 32 bits for the upper
+//     and lower 16 bits of the energy separately. The channels are narrow
+//     enough that they don't overflow, and no 64-bit multiply (a library call
+//     on Cortex-M0+) is needed. On 64-bit hosts, 64-bit sums are faster.
+// The result is the same as FilterbankAccumulateChannels. To be safe against
+// the differences of libm, FilterbankPopulateState uses the table only when it
+// matches the one calculated at runtime.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank.h"
+
+namespace filterbank_fixed {
+
+constexpr bool kHas64BitWord = (sizeof(void*) >= 8);
+
+constexpr int kNumChannels = 40;
+constexpr float kLowerBandLimit = 125.0f;
+constexpr float kUpperBandLimit = 7500.0f;
+constexpr int kSampleRate = 16000;
+constexpr int kSpectrumSize = 257;
+
+namespace internal {
+
+constexpr double kLn2 = 0.693147180559945309417232121458176568;
+constexpr double kSqrt2 = 1.41421356237309504880168872420969808;
+
+// log(1 + x) for x >= 0 (error < 1 ulp or so).
+constexpr double Log1p(double x) {
+  const double u = 1.0 + x;
+  // u = m * 2^k, sqrt(0.5) <= m < sqrt(2)
+  double m = u;
+  int k = 0;
+  while (m >= kSqrt2) {
+    m *= 0.5;
+    ++k;
+  }
+  // log(m) = 2 * atanh(s)
+  const double s = (m - 1) / (m + 1);
+  const double s2 = s * s;
+  double term = s;
+  double sum = 0;
+  for (int n = 0; n < 40; ++n) {
+    sum += term / (2 * n + 1);
+    term *= s2;
+  }
+  // Compensate the rounding error of 1 + x.
+  return (2 * sum + k * kLn2) + (x - (u - 1.0)) / u;
+}
+
+constexpr double Floor(double x) {
+  const double t = static_cast<double>(static_cast<int64_t>(x));
+  return (t > x) ? t - 1 : t;
+}
+
+// The same as FreqToMel in filterbank_util.c.
+constexpr float FreqToMel(float freq) {
+  return static_cast<float>(1127.0 * Log1p(freq / 700.0));
+}
+
+// The same as hz_per_sbin in FilterbankPopulateState.
+constexpr float kHzPerSbin = static_cast<float>(
+    0.5 * kSampleRate / (static_cast<float>(kSpectrumSize) - 1));
+
+// The same as CalculateCenterFrequencies in filterbank_util.c.
+constexpr float CenterMelFreq(int channel) {
+  const float mel_low = FreqToMel(kLowerBandLimit);
+  const float mel_hi = FreqToMel(kUpperBandLimit);
+  const float mel_span = mel_hi - mel_low;
+  const float mel_spacing =
+      mel_span / static_cast<float>(kNumChannels + 1);
+  return mel_low + (mel_spacing * (channel + 1));
+}
+
+// The channels and the bins in them, as FilterbankPopulateState calculates.
+struct Layout {
+  int start_index;
+  int end_index;
+  int max_width;
+  std::array<int, kNumChannels + 1> channel_starts;
+  std::array<int, kNumChannels + 1> channel_widths;
+};
+
+constexpr Layout MakeLayout() {
+  Layout layout{};
+  layout.start_index =
+      static_cast<int>(1.5 + kLowerBandLimit / kHzPerSbin);
+  int freq_index = layout.start_index;
+  for (int chan = 0; chan < kNumChannels + 1; ++chan) {
+    const int chan_freq_index_start = freq_index;
+    while (FreqToMel(freq_index * kHzPerSbin) <= CenterMelFreq(chan)) {
+      ++freq_index;
+    }
+    const int width = freq_index - chan_freq_index_start;
+    layout.channel_starts[chan] = chan_freq_index_start;
+    layout.channel_widths[chan] = width;
+    if (width > layout.max_width) layout.max_width = width;
+  }
+  layout.end_index = freq_index;
+  return layout;
+}
+
+constexpr Layout kLayout = MakeLayout();
+
+// The same as QuantizeFilterbankWeights in filterbank_util.c.
+constexpr int16_t QuantizeWeight(float float_weight) {
+  return static_cast<int16_t>(
+      Floor(float_weight * (1 << kFilterbankBits) + 0.5));
+}
+
+constexpr int16_t QuantizeUnweight(float float_weight) {
+  return static_cast<int16_t>(
+      Floor((1.0 - float_weight) * (1 << kFilterbankBits) + 0.5));
+}
+
+constexpr float FloatWeight(int chan, int frequency) {
+  const float denom_val = (chan == 0) ? FreqToMel(kLowerBandLimit)
+                                      : CenterMelFreq(chan - 1);
+  return (CenterMelFreq(chan) - FreqToMel(frequency * kHzPerSbin)) /
+         (CenterMelFreq(chan) - denom_val);
+}
+
+constexpr int kNumBins = kLayout.end_index - kLayout.start_index;
+constexpr int kTableSize = (kNumChannels + 1) + kNumBins;
+
+constexpr std::array<int16_t, kTableSize> MakeTable() {
+  std::array<int16_t, kTableSize> table{};
+  int index = 0;
+  for (int chan = 0; chan < kNumChannels + 1; ++chan) {
+    const int width = kLayout.channel_widths[chan];
+    table[index++] = static_cast<int16_t>(width);
+    for (int j = 0; j < width; ++j) {
+      const int frequency = kLayout.channel_starts[chan] + j;
+      table[index++] = QuantizeWeight(FloatWeight(chan, frequency));
+    }
+  }
+  return table;
+}
+
+// The unweights of FilterbankPopulateState must be exactly the complement of
+// the weights, otherwise they can't be derived.
+constexpr bool UnweightsAreComplement() {
+  for (int chan = 0; chan < kNumChannels + 1; ++chan) {
+    for (int j = 0; j < kLayout.channel_widths[chan]; ++j) {
+      const float float_weight =
+          FloatWeight(chan, kLayout.channel_starts[chan] + j);
+      if (QuantizeWeight(float_weight) + QuantizeUnweight(float_weight) !=
+          (1 << kFilterbankBits)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The same as weight_index_start in FilterbankPopulateState (with
+// kFilterbankIndexAlignment = 4 bytes and kFilterbankChannelBlockSize = 4):
+// each channel starts at a multiple of 2 bins and is padded to a multiple of 4
+// bins, and the channels without bins share one block of zeros.
+constexpr int PaddedWeightNum() {
+  constexpr int kIndexAlignment = 2;
+  constexpr int kChannelBlockSize = 4;
+  int num = 0;
+  bool needs_zeros = false;
+  for (int chan = 0; chan < kNumChannels + 1; ++chan) {
+    const int width = kLayout.channel_widths[chan];
+    if (width == 0) {
+      if (!needs_zeros) {
+        needs_zeros = true;
+        num += kChannelBlockSize;
+      }
+    } else {
+      const int aligned_width =
+          kLayout.channel_starts[chan] % kIndexAlignment + width;
+      num += ((aligned_width - 1) / kChannelBlockSize + 1) * kChannelBlockSize;
+    }
+  }
+  return num;
+}
+
+}  // namespace internal
+
+constexpr int kStartIndex = internal::kLayout.start_index;
+constexpr int kEndIndex = internal::kLayout.end_index;
+
+// For each channel: the width, then the weights of the bins.
+constexpr std::array<int16_t, internal::kTableSize> kTable =
+    internal::MakeTable();
+
+// The number of the weights (and of the unweights) FilterbankPopulateState
+// allocates before it finds that they match the table.
+constexpr int kPaddedWeightNum = internal::PaddedWeightNum();
+
+static_assert(kEndIndex < kSpectrumSize, "the filterbank exceeds the spectrum");
+static_assert(internal::UnweightsAreComplement(),
+              "the unweights can't be derived from the weights");
+// The 32-bit sums of a channel must not overflow: weight * (energy & 0xFFFF)
+// is less than 2^28, and |weight * (energy >> 16)| is at most 2^27.
+static_assert(static_cast<uint64_t>(internal::kLayout.max_width) *
+                      (1 << kFilterbankBits) * 0xFFFF <=
+                  UINT32_MAX,
+              "a channel is too wide for the 32-bit sums");
+
+// Returns true if the state has the same channels and weights as kTable.
+bool Matches(const FilterbankState& state);
+
+// The same as FilterbankAccumulateChannels with the state which Matches.
+inline void AccumulateChannels(const int32_t* energy, uint64_t* work) {
+  const int16_t* table = kTable.data();
+  const int32_t* magnitudes = energy + kStartIndex;
+  uint64_t unweight_accumulator = 0;
+  for (int i = 0; i < kNumChannels + 1; ++i) {
+    const int width = *table++;
+    if (kHas64BitWord) {
+      uint64_t weight_accumulator = 0;
+      uint64_t sum = 0;
+      for (int j = 0; j < width; ++j) {
+        const uint64_t magnitude = static_cast<uint64_t>(*magnitudes++);
+        weight_accumulator += *table++ * magnitude;
+        sum += magnitude;
+      }
+      *work++ = weight_accumulator + unweight_accumulator;
+      unweight_accumulator = (sum << kFilterbankBits) - weight_accumulator;
+      continue;
+    }
+    // energy = (high << 16) + low. The energy is used as uint64_t, but the
+    // sums are the same modulo 2^64 even for a negative value.
+    int32_t weight_high = 0;
+    uint32_t weight_low = 0;
+    int32_t sum_high = 0;
+    uint32_t sum_low = 0;
+    for (int j = 0; j < width; ++j) {
+      const int32_t magnitude = *magnitudes++;
+      const int32_t high = magnitude >> 16;
+      const uint32_t low = static_cast<uint32_t>(magnitude) & 0xFFFF;
+      const int32_t weight = *table++;
+      weight_high += weight * high;
+      weight_low += weight * low;
+      sum_high += high;
+      sum_low += low;
+    }
+    const uint64_t weight_accumulator =
+        (static_cast<uint64_t>(static_cast<int64_t>(weight_high)) << 16) +
+        weight_low;
+    const uint64_t sum =
+        (static_cast<uint64_t>(static_cast<int64_t>(sum_high)) << 16) +
+        sum_low;
+    *work++ = weight_accumulator + unweight_accumulator;
+    unweight_accumulator = (sum << kFilterbankBits) - weight_accumulator;
+  }
+}
+
+}  // namespace filterbank_fixed
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FILTERBANK_FIXED_H_
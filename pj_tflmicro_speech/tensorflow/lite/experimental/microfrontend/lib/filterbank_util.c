@@ -56,7 +56,16 @@ static void QuantizeFilterbankWeights(const float float_weight, int16_t* weight,
 int FilterbankPopulateState(const struct FilterbankConfig* config,
                             struct FilterbankState* state, int sample_rate,
                             int spectrum_size) {
+  return FilterbankPopulateStateInArena(config, state, sample_rate,
+                                        spectrum_size, NULL);
+}
+
+int FilterbankPopulateStateInArena(const struct FilterbankConfig* config,
+                                   struct FilterbankState* state,
+                                   int sample_rate, int spectrum_size,
+                                   struct FrontendArena* arena) {
   state->num_channels = config->num_channels;
+  state->use_fixed_table = 0;
   const int num_channels_plus_1 = config->num_channels + 1;
 
   // How should we align things to index counts given the byte alignment?
@@ -65,28 +74,38 @@ int FilterbankPopulateState(const struct FilterbankConfig* config,
            ? 1
            : kFilterbankIndexAlignment / sizeof(int16_t));
 
+  // The work buffer is taken first, so that everything after it can be given
+  // back to the arena if the fixed table is used.
+  state->work =
+      FrontendArenaAlloc(arena, num_channels_plus_1 * sizeof(*state->work));
+  const size_t arena_mark = FrontendArenaMark(arena);
   state->channel_frequency_starts =
-      malloc(num_channels_plus_1 * sizeof(*state->channel_frequency_starts));
+      FrontendArenaAlloc(arena, num_channels_plus_1 *
+                                    sizeof(*state->channel_frequency_starts));
   state->channel_weight_starts =
-      malloc(num_channels_plus_1 * sizeof(*state->channel_weight_starts));
+      FrontendArenaAlloc(arena, num_channels_plus_1 *
+                                    sizeof(*state->channel_weight_starts));
   state->channel_widths =
-      malloc(num_channels_plus_1 * sizeof(*state->channel_widths));
-  state->work = malloc(num_channels_plus_1 * sizeof(*state->work));
+      FrontendArenaAlloc(arena, num_channels_plus_1 *
+                                    sizeof(*state->channel_widths));
 
   float* center_mel_freqs =
-      malloc(num_channels_plus_1 * sizeof(*center_mel_freqs));
+      FrontendArenaAlloc(arena, num_channels_plus_1 *
+                                    sizeof(*center_mel_freqs));
   int16_t* actual_channel_starts =
-      malloc(num_channels_plus_1 * sizeof(*actual_channel_starts));
+      FrontendArenaAlloc(arena, num_channels_plus_1 *
+                                    sizeof(*actual_channel_starts));
   int16_t* actual_channel_widths =
-      malloc(num_channels_plus_1 * sizeof(*actual_channel_widths));
+      FrontendArenaAlloc(arena, num_channels_plus_1 *
+                                    sizeof(*actual_channel_widths));
 
-  if (state->channel_frequency_starts == NULL ||
+  if (state->work == NULL || state->channel_frequency_starts == NULL ||
       state->channel_weight_starts == NULL || state->channel_widths == NULL ||
       center_mel_freqs == NULL || actual_channel_starts == NULL ||
       actual_channel_widths == NULL) {
-    free(center_mel_freqs);
-    free(actual_channel_starts);
-    free(actual_channel_widths);
+    FrontendArenaFree(arena, center_mel_freqs);
+    FrontendArenaFree(arena, actual_channel_starts);
+    FrontendArenaFree(arena, actual_channel_widths);
     fprintf(stderr, "Failed to allocate channel buffers\n");
     return 0;
   }
@@ -160,14 +179,16 @@ int FilterbankPopulateState(const struct FilterbankConfig* config,
   // Allocate the two arrays to store the weights - weight_index_start contains
   // the index of what would be the next set of weights that we would need to
   // add, so that's how many weights we need to allocate.
-  state->weights = calloc(weight_index_start, sizeof(*state->weights));
-  state->unweights = calloc(weight_index_start, sizeof(*state->unweights));
+  state->weights =
+      FrontendArenaCalloc(arena, weight_index_start, sizeof(*state->weights));
+  state->unweights = FrontendArenaCalloc(arena, weight_index_start,
+                                         sizeof(*state->unweights));
 
   // If the alloc failed, we also need to nuke the arrays.
   if (state->weights == NULL || state->unweights == NULL) {
-    free(center_mel_freqs);
-    free(actual_channel_starts);
-    free(actual_channel_widths);
+    FrontendArenaFree(arena, center_mel_freqs);
+    FrontendArenaFree(arena, actual_channel_starts);
+    FrontendArenaFree(arena, actual_channel_widths);
     fprintf(stderr, "Failed to allocate weights or unweights\n");
     return 0;
   }
@@ -200,13 +221,30 @@ int FilterbankPopulateState(const struct FilterbankConfig* config,
     }
   }
 
-  free(center_mel_freqs);
-  free(actual_channel_starts);
-  free(actual_channel_widths);
+  FrontendArenaFree(arena, center_mel_freqs);
+  FrontendArenaFree(arena, actual_channel_starts);
+  FrontendArenaFree(arena, actual_channel_widths);
   if (state->end_index >= spectrum_size) {
     fprintf(stderr, "Filterbank end_index is above spectrum size.\n");
     return 0;
   }
+
+  // The table in filterbank_fixed.h is used instead if it's the same as the
+  // one calculated here. Only the work buffer is needed then.
+  if (FilterbankMatchesFixedTable(state)) {
+    state->use_fixed_table = 1;
+    FrontendArenaFree(arena, state->channel_frequency_starts);
+    FrontendArenaFree(arena, state->channel_weight_starts);
+    FrontendArenaFree(arena, state->channel_widths);
+    FrontendArenaFree(arena, state->weights);
+    FrontendArenaFree(arena, state->unweights);
+    state->channel_frequency_starts = NULL;
+    state->channel_weight_starts = NULL;
+    state->channel_widths = NULL;
+    state->weights = NULL;
+    state->unweights = NULL;
+    FrontendArenaRelease(arena, arena_mark);
+  }
   return 1;
 }
 
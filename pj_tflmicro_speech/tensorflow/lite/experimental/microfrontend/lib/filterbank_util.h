@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FILTERBANK_UTIL_H_
 
 #include "tensorflow/lite/experimental/microfrontend/lib/filterbank.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,14 @@ int FilterbankPopulateState(const struct FilterbankConfig* config,
                             struct FilterbankState* state, int sample_rate,
                             int spectrum_size);
 
+// The same as FilterbankPopulateState, but the buffers are taken from the
+// arena. The buffers which are not needed with the fixed table are given back
+// to the arena.
+int FilterbankPopulateStateInArena(const struct FilterbankConfig* config,
+                                   struct FilterbankState* state,
+                                   int sample_rate, int spectrum_size,
+                                   struct FrontendArena* arena);
+
 // Frees any allocated buffers.
 void FilterbankFreeStateContents(struct FilterbankState* state);
 
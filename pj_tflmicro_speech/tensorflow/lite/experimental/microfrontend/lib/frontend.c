@@ -16,6 +16,35 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
 
+// The steps after the energy of the FFT output has been calculated in
+// state->fft.output.
+static struct FrontendOutput FrontendProcessEnergy(struct FrontendState* state,
+                                                   int input_shift) {
+  struct FrontendOutput output;
+  int32_t* energy = (int32_t*)state->fft.output;
+
+  FilterbankAccumulateChannels(&state->filterbank, energy);
+  uint32_t* scaled_filterbank = FilterbankSqrt(&state->filterbank, input_shift);
+
+  // Apply noise reduction.
+  NoiseReductionApply(&state->noise_reduction, scaled_filterbank);
+
+  if (state->pcan_gain_control.enable_pcan) {
+    PcanGainControlApply(&state->pcan_gain_control, scaled_filterbank);
+  }
+
+  // Apply the log and scale.
+  int correction_bits =
+      MostSignificantBit32(state->fft.fft_size) - 1 - (kFilterbankBits / 2);
+  uint16_t* logged_filterbank =
+      LogScaleApply(&state->log_scale, scaled_filterbank,
+                    state->filterbank.num_channels, correction_bits);
+
+  output.size = state->filterbank.num_channels;
+  output.values = logged_filterbank;
+  return output;
+}
+
 struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
                                              const int16_t* samples,
                                              size_t num_samples,
@@ -30,6 +59,35 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
     return output;
   }
 
+  // Apply the FFT to the window's output (and scale it so that the fixed point
+  // FFT can have as much resolution as possible). The energy is calculated
+  // while the FFT writes its output if the fft size is supported.
+  int input_shift =
+      15 - MostSignificantBit32(state->window.max_abs_output_value);
+  if (!FftComputeEnergy(&state->fft, state->window.output, input_shift,
+                        state->filterbank.start_index,
+                        state->filterbank.end_index)) {
+    FftCompute(&state->fft, state->window.output, input_shift);
+    FilterbankConvertFftComplexToEnergy(&state->filterbank, state->fft.output,
+                                        (int32_t*)state->fft.output);
+  }
+
+  return FrontendProcessEnergy(state, input_shift);
+}
+
+struct FrontendOutput FrontendProcessSamplesReference(
+    struct FrontendState* state, const int16_t* samples, size_t num_samples,
+    size_t* num_samples_read) {
+  struct FrontendOutput output;
+  output.values = NULL;
+  output.size = 0;
+
+  // Try to apply the window - if it fails, return and wait for more data.
+  if (!WindowProcessSamples(&state->window, samples, num_samples,
+                            num_samples_read)) {
+    return output;
+  }
+
   // Apply the FFT to the window's output (and scale it so that the fixed point
   // FFT can have as much resolution as possible).
   int input_shift =
@@ -42,26 +100,7 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
   FilterbankConvertFftComplexToEnergy(&state->filterbank, state->fft.output,
                                       energy);
 
-  FilterbankAccumulateChannels(&state->filterbank, energy);
-  uint32_t* scaled_filterbank = FilterbankSqrt(&state->filterbank, input_shift);
-
-  // Apply noise reduction.
-  NoiseReductionApply(&state->noise_reduction, scaled_filterbank);
-
-  if (state->pcan_gain_control.enable_pcan) {
-    PcanGainControlApply(&state->pcan_gain_control, scaled_filterbank);
-  }
-
-  // Apply the log and scale.
-  int correction_bits =
-      MostSignificantBit32(state->fft.fft_size) - 1 - (kFilterbankBits / 2);
-  uint16_t* logged_filterbank =
-      LogScaleApply(&state->log_scale, scaled_filterbank,
-                    state->filterbank.num_channels, correction_bits);
-
-  output.size = state->filterbank.num_channels;
-  output.values = logged_filterbank;
-  return output;
+  return FrontendProcessEnergy(state, input_shift);
 }
 
 void FrontendReset(struct FrontendState* state) {
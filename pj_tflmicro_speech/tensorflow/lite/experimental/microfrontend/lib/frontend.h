@@ -55,6 +55,13 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
                                              size_t num_samples,
                                              size_t* num_samples_read);
 
+// The same as FrontendProcessSamples, but runs the FFT and the energy
+// calculation as separate passes over the frame. Kept as the reference of the
+// fused path.
+struct FrontendOutput FrontendProcessSamplesReference(
+    struct FrontendState* state, const int16_t* samples, size_t num_samples,
+    size_t* num_samples_read);
+
 void FrontendReset(struct FrontendState* state);
 
 #ifdef __cplusplus
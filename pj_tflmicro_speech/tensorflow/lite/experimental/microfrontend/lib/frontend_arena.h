@@ -0,0 +1,66 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FRONTEND_ARENA_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FRONTEND_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Memory supplied by the caller for the buffers of a state, so that the state
+// can be populated without malloc (*PopulateStateInArena). The buffers are
+// taken from the head one after another and are not freed one by one: the
+// whole arena is released by the caller after the state is no longer used.
+// Only the buffers taken last can be given back (FrontendArenaRelease).
+// The functions below take NULL as the arena, and then they are malloc,
+// calloc and free.
+struct FrontendArena {
+  uint8_t* buffer;
+  size_t size;
+  // Bytes taken so far. If an allocation has failed, this includes the size
+  // of the failed one.
+  size_t used;
+};
+
+// The buffers are aligned to this (enough for uint64_t and pointers).
+#define kFrontendArenaAlignment 8
+
+void FrontendArenaInit(struct FrontendArena* arena, void* buffer, size_t size);
+
+// Returns NULL if the arena doesn't have size bytes left.
+void* FrontendArenaAlloc(struct FrontendArena* arena, size_t size);
+
+// The same as FrontendArenaAlloc, and fills the buffer with zero.
+void* FrontendArenaCalloc(struct FrontendArena* arena, size_t num,
+                          size_t size);
+
+// Does nothing if the arena is not NULL (the buffer stays taken).
+void FrontendArenaFree(struct FrontendArena* arena, void* ptr);
+
+// Returns the current position of the arena (0 if the arena is NULL).
+size_t FrontendArenaMark(const struct FrontendArena* arena);
+
+// Gives back the buffers taken after the mark, which must not be used anymore.
+// Does nothing if the arena is NULL.
+void FrontendArenaRelease(struct FrontendArena* arena, size_t mark);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FRONTEND_ARENA_H_
@@ -42,6 +42,15 @@ void FrontendFillConfigWithDefaults(struct FrontendConfig* config);
 int FrontendPopulateState(const struct FrontendConfig* config,
                           struct FrontendState* state, int sample_rate);
 
+// The same as FrontendPopulateState, but all the buffers are taken from the
+// arena (no malloc), so the state can be placed in memory supplied by the
+// caller. Don't call FrontendFreeStateContents for the state: the arena is
+// released as a whole. If this fails for the size of the arena, arena->used
+// is the size needed so far.
+int FrontendPopulateStateInArena(const struct FrontendConfig* config,
+                                 struct FrontendState* state, int sample_rate,
+                                 struct FrontendArena* arena);
+
 // Frees any allocated buffers.
 void FrontendFreeStateContents(struct FrontendState* state);
 
@@ -0,0 +1,61 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/integer_math.h"
+
+const uint8_t kClzLut[]
+#ifndef _MSC_VER
+    __attribute__((aligned(4)))
+#endif  // _MSV_VER
+    = {8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4,
+       3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+       2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+       2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+       1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+       1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+       1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+       1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+const uint16_t kSqrtSeedLut[]
+#ifndef _MSC_VER
+    __attribute__((aligned(4)))
+#endif  // _MSV_VER
+    = {33024, 33277, 33528, 33777, 34024, 34270, 34514, 34756, 34997, 35236,
+       35473, 35709, 35943, 36175, 36407, 36636, 36864, 37091, 37317, 37541,
+       37764, 37985, 38205, 38424, 38642, 38859, 39074, 39288, 39501, 39713,
+       39923, 40133, 40341, 40549, 40755, 40960, 41165, 41368, 41570, 41772,
+       41972, 42171, 42370, 42567, 42764, 42960, 43155, 43348, 43542, 43734,
+       43925, 44116, 44306, 44494, 44683, 44870, 45056, 45242, 45427, 45612,
+       45795, 45978, 46160, 46341, 46522, 46702, 46881, 47060, 47238, 47415,
+       47592, 47768, 47943, 48118, 48292, 48465, 48638, 48810, 48982, 49152,
+       49323, 49493, 49662, 49830, 49999, 50166, 50333, 50499, 50665, 50831,
+       50995, 51160, 51323, 51486, 51649, 51811, 51973, 52134, 52295, 52455,
+       52615, 52774, 52932, 53091, 53248, 53406, 53563, 53719, 53875, 54030,
+       54185, 54340, 54494, 54648, 54801, 54954, 55107, 55259, 55410, 55561,
+       55712, 55862, 56012, 56162, 56311, 56460, 56608, 56756, 56904, 57051,
+       57198, 57344, 57491, 57636, 57782, 57927, 58071, 58216, 58360, 58503,
+       58646, 58789, 58932, 59074, 59216, 59357, 59498, 59639, 59780, 59920,
+       60060, 60199, 60338, 60477, 60616, 60754, 60892, 61030, 61167, 61304,
+       61440, 61577, 61713, 61849, 61984, 62119, 62254, 62389, 62523, 62657,
+       62791, 62924, 63058, 63191, 63323, 63455, 63588, 63719, 63851, 63982,
+       64113, 64244, 64374, 64504, 64634, 64764, 64893, 65022, 65151, 65280,
+       65408, 65535};
@@ -16,9 +16,57 @@ limitations under the License.
 
 #include <string.h>
 
-void NoiseReductionApply(struct NoiseReductionState* state, uint32_t* signal) {
+#include "tensorflow/lite/experimental/microfrontend/lib/simd.h"
+
+#if !defined(MICROFRONTEND_SIMD)
+// (a * a_weight + b * b_weight) >> kNoiseReductionBits (truncated to 32 bits)
+// without 64-bit multiplication. It's exact when a_weight + b_weight is not
+// more than 1 << 16, because then the sums of the upper and the lower 16 bits
+// don't overflow.
+static inline uint32_t WeightedSum(uint32_t a, uint32_t a_weight, uint32_t b,
+                                   uint32_t b_weight) {
+  const uint32_t high = (a >> 16) * a_weight + (b >> 16) * b_weight;
+  const uint32_t low = (a & 0xFFFF) * a_weight + (b & 0xFFFF) * b_weight;
+  return (high << (16 - kNoiseReductionBits)) + (low >> kNoiseReductionBits);
+}
+
+// The channels of start, start + 2, start + 4, ... (the even or the odd
+// channels), which have the same smoothing.
+static void NoiseReductionApplyChannels(struct NoiseReductionState* state,
+                                        uint32_t* signal, int start,
+                                        uint32_t smoothing) {
+  const uint32_t one_minus_smoothing = (1 << kNoiseReductionBits) - smoothing;
+  const int smoothing_bits = state->smoothing_bits;
+  const uint32_t min_signal_remaining = state->min_signal_remaining;
+  const int num_channels = state->num_channels;
+  uint32_t* estimates = state->estimate;
+  int i;
+  for (i = start; i < num_channels; i += 2) {
+    // Update the estimate of the noise.
+    const uint32_t signal_scaled_up = signal[i] << smoothing_bits;
+    uint32_t estimate = WeightedSum(signal_scaled_up, smoothing, estimates[i],
+                                    one_minus_smoothing);
+    estimates[i] = estimate;
+
+    // Make sure that we can't get a negative value for the signal - estimate.
+    if (estimate > signal_scaled_up) {
+      estimate = signal_scaled_up;
+    }
+
+    const uint32_t floor = WeightedSum(signal[i], min_signal_remaining, 0, 0);
+    const uint32_t subtracted =
+        (signal_scaled_up - estimate) >> smoothing_bits;
+    const uint32_t output = subtracted > floor ? subtracted : floor;
+    signal[i] = output;
+  }
+}
+#endif
+
+// The original calculation with 64-bit multiplication, for any smoothing.
+static void NoiseReductionApplyWide(struct NoiseReductionState* state,
+                                    uint32_t* signal, int start, int end) {
   int i;
-  for (i = 0; i < state->num_channels; ++i) {
+  for (i = start; i < end; ++i) {
     const uint32_t smoothing =
         ((i & 1) == 0) ? state->even_smoothing : state->odd_smoothing;
     const uint32_t one_minus_smoothing = (1 << kNoiseReductionBits) - smoothing;
@@ -46,6 +94,118 @@ void NoiseReductionApply(struct NoiseReductionState* state, uint32_t* signal) {
   }
 }
 
+#if defined(MICROFRONTEND_SIMD_SSE2)
+// Four channels at a time. The even and the odd channels are in the even and
+// the odd lanes, and they are multiplied into 64 bits separately.
+static int NoiseReductionApplySimd(struct NoiseReductionState* state,
+                                   uint32_t* signal) {
+  const __m128i smoothing = _mm_set_epi32(
+      state->odd_smoothing, state->even_smoothing, state->odd_smoothing,
+      state->even_smoothing);
+  const __m128i one_minus_smoothing =
+      _mm_sub_epi32(_mm_set1_epi32(1 << kNoiseReductionBits), smoothing);
+  const __m128i min_signal_remaining =
+      _mm_set1_epi32(state->min_signal_remaining);
+  const __m128i smoothing_bits = _mm_cvtsi32_si128(state->smoothing_bits);
+  const __m128i noise_reduction_bits = _mm_cvtsi32_si128(kNoiseReductionBits);
+  int i;
+  for (i = 0; i + 4 <= state->num_channels; i += 4) {
+    const __m128i value = _mm_loadu_si128((const __m128i*)(signal + i));
+    const __m128i previous =
+        _mm_loadu_si128((const __m128i*)(state->estimate + i));
+    const __m128i signal_scaled_up = _mm_sll_epi32(value, smoothing_bits);
+
+    // Update the estimate of the noise.
+    const __m128i estimate_even = _mm_srl_epi64(
+        _mm_add_epi64(SimdMulEven(signal_scaled_up, smoothing),
+                      SimdMulEven(previous, one_minus_smoothing)),
+        noise_reduction_bits);
+    const __m128i estimate_odd = _mm_srl_epi64(
+        _mm_add_epi64(SimdMulOdd(signal_scaled_up, smoothing),
+                      SimdMulOdd(previous, one_minus_smoothing)),
+        noise_reduction_bits);
+    __m128i estimate = SimdInterleave(estimate_even, estimate_odd);
+    _mm_storeu_si128((__m128i*)(state->estimate + i), estimate);
+
+    // Make sure that we can't get a negative value for the signal - estimate.
+    estimate = SimdMinU32(estimate, signal_scaled_up);
+
+    const __m128i floor = SimdInterleave(
+        _mm_srl_epi64(SimdMulEven(value, min_signal_remaining),
+                      noise_reduction_bits),
+        _mm_srl_epi64(SimdMulOdd(value, min_signal_remaining),
+                      noise_reduction_bits));
+    const __m128i subtracted = _mm_srl_epi32(
+        _mm_sub_epi32(signal_scaled_up, estimate), smoothing_bits);
+    _mm_storeu_si128((__m128i*)(signal + i), SimdMaxU32(subtracted, floor));
+  }
+  return i;
+}
+#elif defined(MICROFRONTEND_SIMD_NEON)
+// Four channels at a time. The products are calculated in 64 bits for the
+// lower and the upper two lanes.
+static int NoiseReductionApplySimd(struct NoiseReductionState* state,
+                                   uint32_t* signal) {
+  const uint32_t smoothing_values[2] = {state->even_smoothing,
+                                        state->odd_smoothing};
+  const uint32x2_t smoothing = vld1_u32(smoothing_values);
+  const uint32x2_t one_minus_smoothing =
+      vsub_u32(vdup_n_u32(1 << kNoiseReductionBits), smoothing);
+  const uint32x2_t min_signal_remaining =
+      vdup_n_u32(state->min_signal_remaining);
+  const int32x4_t smoothing_bits = vdupq_n_s32(state->smoothing_bits);
+  const int32x4_t minus_smoothing_bits = vdupq_n_s32(-state->smoothing_bits);
+  int i;
+  for (i = 0; i + 4 <= state->num_channels; i += 4) {
+    const uint32x4_t value = vld1q_u32(signal + i);
+    const uint32x4_t previous = vld1q_u32(state->estimate + i);
+    const uint32x4_t signal_scaled_up = vshlq_u32(value, smoothing_bits);
+
+    // Update the estimate of the noise.
+    uint64x2_t low = vmull_u32(vget_low_u32(signal_scaled_up), smoothing);
+    uint64x2_t high = vmull_u32(vget_high_u32(signal_scaled_up), smoothing);
+    low = vmlal_u32(low, vget_low_u32(previous), one_minus_smoothing);
+    high = vmlal_u32(high, vget_high_u32(previous), one_minus_smoothing);
+    uint32x4_t estimate =
+        vcombine_u32(vmovn_u64(vshrq_n_u64(low, kNoiseReductionBits)),
+                     vmovn_u64(vshrq_n_u64(high, kNoiseReductionBits)));
+    vst1q_u32(state->estimate + i, estimate);
+
+    // Make sure that we can't get a negative value for the signal - estimate.
+    estimate = vminq_u32(estimate, signal_scaled_up);
+
+    const uint32x4_t floor = vcombine_u32(
+        vmovn_u64(vshrq_n_u64(
+            vmull_u32(vget_low_u32(value), min_signal_remaining),
+            kNoiseReductionBits)),
+        vmovn_u64(vshrq_n_u64(
+            vmull_u32(vget_high_u32(value), min_signal_remaining),
+            kNoiseReductionBits)));
+    const uint32x4_t subtracted = vshlq_u32(
+        vsubq_u32(signal_scaled_up, estimate), minus_smoothing_bits);
+    vst1q_u32(signal + i, vmaxq_u32(subtracted, floor));
+  }
+  return i;
+}
+#endif
+
+void NoiseReductionApply(struct NoiseReductionState* state, uint32_t* signal) {
+#if defined(MICROFRONTEND_SIMD)
+  // The SIMD version multiplies into 64 bits, so it works for any smoothing.
+  const int done = NoiseReductionApplySimd(state, signal);
+  NoiseReductionApplyWide(state, signal, done, state->num_channels);
+#else
+  // one_minus_smoothing must not be negative for WeightedSum.
+  const uint32_t weight_max = 1 << kNoiseReductionBits;
+  if (state->even_smoothing > weight_max || state->odd_smoothing > weight_max) {
+    NoiseReductionApplyWide(state, signal, 0, state->num_channels);
+    return;
+  }
+  NoiseReductionApplyChannels(state, signal, 0, state->even_smoothing);
+  NoiseReductionApplyChannels(state, signal, 1, state->odd_smoothing);
+#endif
+}
+
 void NoiseReductionReset(struct NoiseReductionState* state) {
   memset(state->estimate, 0, sizeof(*state->estimate) * state->num_channels);
 }
@@ -26,13 +26,21 @@ void NoiseReductionFillConfigWithDefaults(struct NoiseReductionConfig* config) {
 int NoiseReductionPopulateState(const struct NoiseReductionConfig* config,
                                 struct NoiseReductionState* state,
                                 int num_channels) {
+  return NoiseReductionPopulateStateInArena(config, state, num_channels, NULL);
+}
+
+int NoiseReductionPopulateStateInArena(
+    const struct NoiseReductionConfig* config,
+    struct NoiseReductionState* state, int num_channels,
+    struct FrontendArena* arena) {
   state->smoothing_bits = config->smoothing_bits;
   state->odd_smoothing = config->odd_smoothing * (1 << kNoiseReductionBits);
   state->even_smoothing = config->even_smoothing * (1 << kNoiseReductionBits);
   state->min_signal_remaining =
       config->min_signal_remaining * (1 << kNoiseReductionBits);
   state->num_channels = num_channels;
-  state->estimate = calloc(state->num_channels, sizeof(*state->estimate));
+  state->estimate =
+      FrontendArenaCalloc(arena, state->num_channels, sizeof(*state->estimate));
   if (state->estimate == NULL) {
     fprintf(stderr, "Failed to alloc estimate buffer\n");
     return 0;
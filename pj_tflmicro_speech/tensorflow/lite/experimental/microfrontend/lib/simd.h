@@ -0,0 +1,75 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_SIMD_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_SIMD_H_
+
+// SIMD backend of the per-channel kernels, for the host (offline feature
+// extraction). SSE2 on x86 and NEON on ARM are used if the compiler targets
+// them. Cortex-M0+ has neither, so the scalar kernels are used there.
+// The SIMD kernels give the same result as the scalar ones: the products are
+// calculated in 64 bits as the original code does.
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MICROFRONTEND_SIMD_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MICROFRONTEND_SIMD_NEON
+#endif
+
+#if defined(MICROFRONTEND_SIMD_SSE2) || defined(MICROFRONTEND_SIMD_NEON)
+#define MICROFRONTEND_SIMD
+#endif
+
+#if defined(MICROFRONTEND_SIMD_SSE2)
+// SSE2 multiplies only the even lanes into 64 bits, so the even and the odd
+// lanes are calculated separately, then put back in order.
+
+// (a * b) of the even lanes as 64 bits.
+static inline __m128i SimdMulEven(__m128i a, __m128i b) {
+  return _mm_mul_epu32(a, b);
+}
+
+// (a * b) of the odd lanes as 64 bits.
+static inline __m128i SimdMulOdd(__m128i a, __m128i b) {
+  return _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+}
+
+// The lower 32 bits of the 64-bit lanes of even and odd, in lane order.
+static inline __m128i SimdInterleave(__m128i even, __m128i odd) {
+  return _mm_or_si128(_mm_and_si128(even, _mm_set_epi32(0, -1, 0, -1)),
+                      _mm_slli_epi64(odd, 32));
+}
+
+// a > b for uint32_t (all bits set if true).
+static inline __m128i SimdGreaterThanU32(__m128i a, __m128i b) {
+  const __m128i bias = _mm_set1_epi32((int32_t)0x80000000);
+  return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+static inline __m128i SimdSelect(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128i SimdMaxU32(__m128i a, __m128i b) {
+  return SimdSelect(SimdGreaterThanU32(a, b), a, b);
+}
+
+static inline __m128i SimdMinU32(__m128i a, __m128i b) {
+  return SimdSelect(SimdGreaterThanU32(a, b), b, a);
+}
+#endif
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_SIMD_H_
@@ -27,14 +27,22 @@ limitations under the License.
 void WindowFillConfigWithDefaults(struct WindowConfig* config) {
   config->size_ms = 25;
   config->step_size_ms = 10;
+  config->circular_input = 0;
 }
 
 int WindowPopulateState(const struct WindowConfig* config,
                         struct WindowState* state, int sample_rate) {
+  return WindowPopulateStateInArena(config, state, sample_rate, NULL);
+}
+
+int WindowPopulateStateInArena(const struct WindowConfig* config,
+                               struct WindowState* state, int sample_rate,
+                               struct FrontendArena* arena) {
   state->size = config->size_ms * sample_rate / 1000;
   state->step = config->step_size_ms * sample_rate / 1000;
 
-  state->coefficients = malloc(state->size * sizeof(*state->coefficients));
+  state->coefficients =
+      FrontendArenaAlloc(arena, state->size * sizeof(*state->coefficients));
   if (state->coefficients == NULL) {
     fprintf(stderr, "Failed to allocate window coefficients\n");
     return 0;
@@ -50,14 +58,17 @@ int WindowPopulateState(const struct WindowConfig* config,
         floor(float_value * (1 << kFrontendWindowBits) + 0.5);
   }
 
+  state->circular_input = config->circular_input;
+  state->input_start = 0;
   state->input_used = 0;
-  state->input = malloc(state->size * sizeof(*state->input));
+  state->input = FrontendArenaAlloc(arena, state->size * sizeof(*state->input));
   if (state->input == NULL) {
     fprintf(stderr, "Failed to allocate window input\n");
     return 0;
   }
 
-  state->output = malloc(state->size * sizeof(*state->output));
+  state->output =
+      FrontendArenaAlloc(arena, state->size * sizeof(*state->output));
   if (state->output == NULL) {
     fprintf(stderr, "Failed to allocate window output\n");
     return 0;
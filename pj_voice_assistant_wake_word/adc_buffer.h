@@ -24,8 +24,29 @@ limitations under the License.
 #include "hardware/irq.h"
 
 #include "ring_block_buffer.h"
+#include "ping_pong_capture.h"
 #include "audio_buffer.h"
 
+/* Two DMA channels reading ADC FIFO, chained to each other */
+class AdcDma : public PingPongDma {
+public:
+    AdcDma() {
+        dma_channel_[0] = -1;
+        dma_channel_[1] = -1;
+    }
+    ~AdcDma() {}
+
+    void Initialize(enum dma_channel_transfer_size transfer_size, int32_t transfer_count);
+    void Finalize();
+    void SetWriteAddress(int32_t channel_index, void* dst) override;
+    void Start() override;
+    void Abort();
+    int32_t dma_channel(int32_t channel_index) const { return dma_channel_[channel_index]; }
+
+private:
+    int32_t dma_channel_[2];
+};
+
 class AdcBuffer : public AudioBuffer {
 public:
     static constexpr int32_t ADC_CLOCK  = (48 * 1000 * 1000);        // Fixed value (48MHz)
@@ -37,7 +58,7 @@ public:
         , capture_channel_(0)
         , capture_depth_(0)
         , sampling_rate_(0)
-        , dma_channel_(0)
+        , sample_bits_(8)
      {};
     ~AdcBuffer() {}
 
@@ -46,21 +67,28 @@ public:
     int32_t Start(void) override;
     int32_t Stop(void) override;
     RingBlockBuffer<uint8_t>& GetRingBlockBuffer(void) override;
+    RingBlockBuffer<uint16_t>& GetRingBlockBuffer16(void) override;
 
 public:
     static std::function<void(void)> irq_handler_static_;
 
 private:
     void IrqHandler();
+    template<class T>
+    void HandleFinishedBlocks(PingPongCapture<T>& capture, const RingBlockBuffer<T>& ring_buffer);
+    void SetIrqEnabled(bool enabled);
 
 private:
     int32_t buffer_num_;
     int32_t capture_channel_;
     int32_t capture_depth_;
     int32_t sampling_rate_;
-    RingBlockBuffer<uint8_t> adc_block_buffer_;
-    dma_channel_config dma_config_;
-    int32_t dma_channel_;
+    int32_t sample_bits_;
+    RingBlockBuffer<uint8_t> adc_block_buffer_;         // sample_bits_ = 8
+    RingBlockBuffer<uint16_t> adc_block_buffer16_;      // sample_bits_ = 12
+    PingPongCapture<uint8_t> capture_;                  // sample_bits_ = 8
+    PingPongCapture<uint16_t> capture16_;               // sample_bits_ = 12
+    AdcDma dma_;
 };
 
 #endif
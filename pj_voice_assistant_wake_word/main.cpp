@@ -135,8 +135,9 @@ int main(void) {
 
     /* Create feature provider */
     static int8_t feature_buffer[kFeatureElementCount];
-    static FeatureProvider feature_provider(kFeatureElementCount, feature_buffer);
-    static AudioProvider audio_provider;
+    static FeatureProvider feature_provider(kFeatureElementCount, feature_buffer, true);    // circular mode (slices are not scrolled)
+    static AudioProvider audio_provider(12);    // capture full 12-bit ADC samples
+
     audio_provider.Initialize();
     int32_t previous_time = 0;
 
@@ -149,6 +150,7 @@ int main(void) {
         /* Generate feature */
         audio_provider.DebugWriteData(32);
         const int32_t current_time = audio_provider.GetLatestAudioTimestamp();
+        audio_provider.HandleStatsCommand(current_time);
         if (current_time < 0 || current_time == previous_time) continue;
 
         int32_t how_many_new_slices = 0;
@@ -163,10 +165,8 @@ int main(void) {
         previous_time = current_time;
         if (how_many_new_slices == 0) continue;
 
-        /* Copy the generated feature data to input tensor buffer */
-        for (int32_t i = 0; i < kFeatureElementCount; i++) {
-            input->data.int8[i] = feature_buffer[i];
-        }
+        /* Copy the generated feature data to input tensor buffer in time order */
+        feature_provider.CopyFeatureData(input->data.int8);
 
         /* Run inference */
         TfLiteStatus invoke_status = interpreter->Invoke();
@@ -216,9 +216,13 @@ int main(void) {
 
         /* Display feature data */
         static std::vector<uint8_t> buffer(kFeatureElementCount * 2, 0);
-        for (int i = 0; i < kFeatureElementCount; i++ ) {
-            buffer[2 * i + 1] = feature_buffer[i];
+        for (int slice = 0; slice < kFeatureSliceCount; slice++) {
+            const int8_t* slice_data = feature_provider.GetSliceData(slice);
+            for (int i = 0; i < kFeatureSliceSize; i++) {
+                buffer[2 * (slice * kFeatureSliceSize + i) + 1] = slice_data[i];
+            }
         }
+
         oled.DrawBuffer(0, (OledSeps525Spi::kHeight - kFeatureSliceCount) / 2, kFeatureSliceSize, kFeatureSliceCount, buffer);
     }
 
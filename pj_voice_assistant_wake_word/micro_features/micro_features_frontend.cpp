@@ -0,0 +1,73 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "micro_features/micro_features_frontend.h"
+
+#include "micro_features/micro_model_settings.h"
+
+void FillMicroFeaturesFrontendConfig(FrontendConfig* config) {
+  config->window.size_ms = kFeatureSliceDurationMs;
+  config->window.step_size_ms = kFeatureSliceStrideMs;
+  // The window keeps its input in a circular buffer (no memmove per slice).
+  config->window.circular_input = 1;
+  config->noise_reduction.smoothing_bits = 10;
+  config->filterbank.num_channels = kFeatureSliceSize;
+  config->filterbank.lower_band_limit = 125.0;
+  config->filterbank.upper_band_limit = 7500.0;
+  config->noise_reduction.smoothing_bits = 10;
+  config->noise_reduction.even_smoothing = 0.025;
+  config->noise_reduction.odd_smoothing = 0.06;
+  config->noise_reduction.min_signal_remaining = 0.05;
+  config->pcan_gain_control.enable_pcan = 1;
+  config->pcan_gain_control.strength = 0.95;
+  config->pcan_gain_control.offset = 80.0;
+  config->pcan_gain_control.gain_bits = 21;
+  config->log_scale.enable_log = 1;
+  config->log_scale.scale_shift = 6;
+}
+
+void QuantizeMicroFeatures(const FrontendOutput& frontend_output,
+                           int8_t* output) {
+  for (size_t i = 0; i < frontend_output.size; ++i) {
+    // These scaling values are derived from those used in input_data.py in the
+    // training pipeline.
+    // The feature pipeline outputs 16-bit signed integers in roughly a 0 to 670
+    // range. In training, these are then arbitrarily divided by 25.6 to get
+    // float values in the rough range of 0.0 to 26.0. This scaling is performed
+    // for historical reasons, to match up with the output of other feature
+    // generators.
+    // The process is then further complicated when we quantize the model. This
+    // means we have to scale the 0.0 to 26.0 real values to the -128 to 127
+    // signed integer numbers.
+    // All this means that to get matching values from our integer feature
+    // output into the tensor input, we have to perform:
+    // input = (((feature / 25.6) / 26.0) * 256) - 128
+    // To simplify this and perform it in 32-bit integer math, we rearrange to:
+    // input = (feature * 256) / (25.6 * 26.0) - 128
+    constexpr int32_t value_scale = 256;
+    constexpr int32_t value_div = static_cast<int32_t>((25.6f * 26.0f) + 0.5f);
+    int32_t value =
+        ((frontend_output.values[i] * value_scale) + (value_div / 2)) /
+        value_div;
+    value -= 128;
+    if (value < -128) {
+      value = -128;
+    }
+    if (value > 127) {
+      value = 127;
+    }
+    output[i] = value;
+  }
+}
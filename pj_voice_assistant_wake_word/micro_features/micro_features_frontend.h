@@ -0,0 +1,108 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_MICRO_FEATURES_MICRO_FEATURES_FRONTEND_H_
+#define TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_MICRO_FEATURES_MICRO_FEATURES_FRONTEND_H_
+
+// The frontend configuration and the quantization of the model input, shared
+// by the feature generator on the device and the host tools (which don't
+// depend on TFLM), so that both produce the same features.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "micro_features/micro_model_settings.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_fixed.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank_fixed.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/pcan_gain_control_util.h"
+
+// Fills the configuration of the frontend used for the model. The state is
+// populated with FrontendPopulateState(config, state, kAudioSampleFrequency).
+void FillMicroFeaturesFrontendConfig(FrontendConfig* config);
+
+// The bytes of the arena FrontendPopulateStateInArena takes for this
+// configuration, counted in the same way as the *PopulateStateInArena
+// functions take the buffers.
+namespace micro_features_arena {
+
+constexpr size_t Align(size_t size) {
+  return (size + kFrontendArenaAlignment - 1) / kFrontendArenaAlignment *
+         kFrontendArenaAlignment;
+}
+
+constexpr size_t FftSize(size_t input_size) {
+  size_t fft_size = 1;
+  while (fft_size < input_size) {
+    fft_size <<= 1;
+  }
+  return fft_size;
+}
+
+constexpr size_t kWindowSize =
+    kFeatureSliceDurationMs * kAudioSampleFrequency / 1000;
+constexpr size_t kFftSize = FftSize(kWindowSize);
+constexpr size_t kNumChannelsPlus1 = kFeatureSliceSize + 1;
+
+static_assert(fft_fixed::IsSupported(kFftSize),
+              "kiss_fftr needs the input and the scratch in the arena");
+static_assert(filterbank_fixed::kNumChannels == kFeatureSliceSize &&
+                  filterbank_fixed::kSampleRate == kAudioSampleFrequency &&
+                  filterbank_fixed::kSpectrumSize == kFftSize / 2 + 1,
+              "the filterbank table is not for this configuration");
+
+// The coefficients, the input and the output of the window.
+constexpr size_t kWindowBytes = 3 * Align(kWindowSize * sizeof(int16_t));
+// The output of the FFT (the specialized FFT doesn't need the others).
+constexpr size_t kFftBytes =
+    Align((kFftSize / 2 + 1) * sizeof(complex_int16_t) * 2);
+// The work buffer of the filterbank, which stays.
+constexpr size_t kFilterbankWorkBytes =
+    Align(kNumChannelsPlus1 * sizeof(uint64_t));
+// The per-channel arrays, the temporaries and the weights of the filterbank,
+// which are given back as the fixed table is used.
+constexpr size_t kFilterbankTableBytes =
+    5 * Align(kNumChannelsPlus1 * sizeof(int16_t)) +
+    Align(kNumChannelsPlus1 * sizeof(float)) +
+    2 * Align(filterbank_fixed::kPaddedWeightNum * sizeof(int16_t));
+// The noise estimates and the gain LUT of PCAN, taken after the above.
+constexpr size_t kNoiseReductionPcanBytes =
+    Align(kFeatureSliceSize * sizeof(uint32_t)) +
+    Align(kWideDynamicFunctionLUTSize * sizeof(int16_t));
+
+constexpr size_t kFixedBytes = kWindowBytes + kFftBytes + kFilterbankWorkBytes;
+
+}  // namespace micro_features_arena
+
+// The arena needed at the peak (while the filterbank is populated).
+constexpr size_t kMicroFeaturesArenaSize =
+    micro_features_arena::kFixedBytes +
+    (micro_features_arena::kFilterbankTableBytes >
+             micro_features_arena::kNoiseReductionPcanBytes
+         ? micro_features_arena::kFilterbankTableBytes
+         : micro_features_arena::kNoiseReductionPcanBytes);
+
+// The arena which stays in use after the state is populated.
+constexpr size_t kMicroFeaturesArenaUsed =
+    micro_features_arena::kFixedBytes +
+    micro_features_arena::kNoiseReductionPcanBytes;
+
+// Converts the frontend output into the int8 input of the model.
+void QuantizeMicroFeatures(const FrontendOutput& frontend_output,
+                           int8_t* output);
+
+#endif  // TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_MICRO_FEATURES_MICRO_FEATURES_FRONTEND_H_
@@ -20,97 +20,95 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
 #include "tensorflow/lite/experimental/microfrontend/lib/frontend_util.h"
+#include "micro_features/micro_features_frontend.h"
 #include "micro_features/micro_model_settings.h"
 
 // Configure FFT to output 16 bit fixed point.
 #define FIXED_POINT 16
 
-namespace {
-
-FrontendState g_micro_features_state;
-bool g_is_first_time = true;
-
-}  // namespace
+MicroFeaturesGenerator::MicroFeaturesGenerator() : is_initialized_(false) {
+  FrontendArenaInit(&arena_, nullptr, 0);
+}
 
-TfLiteStatus InitializeMicroFeatures(tflite::ErrorReporter* error_reporter) {
+TfLiteStatus MicroFeaturesGenerator::Initialize(
+    tflite::ErrorReporter* error_reporter, uint8_t* arena, size_t arena_size) {
+  is_initialized_ = false;
+  FrontendArenaInit(&arena_, arena, arena_size);
+  if (arena_.size < kArenaSize) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Arena is too small: %d / %d",
+                         static_cast<int>(arena_.size),
+                         static_cast<int>(kArenaSize));
+    return kTfLiteError;
+  }
   FrontendConfig config;
-  config.window.size_ms = kFeatureSliceDurationMs;
-  config.window.step_size_ms = kFeatureSliceStrideMs;
-  config.noise_reduction.smoothing_bits = 10;
-  config.filterbank.num_channels = kFeatureSliceSize;
-  config.filterbank.lower_band_limit = 125.0;
-  config.filterbank.upper_band_limit = 7500.0;
-  config.noise_reduction.smoothing_bits = 10;
-  config.noise_reduction.even_smoothing = 0.025;
-  config.noise_reduction.odd_smoothing = 0.06;
-  config.noise_reduction.min_signal_remaining = 0.05;
-  config.pcan_gain_control.enable_pcan = 1;
-  config.pcan_gain_control.strength = 0.95;
-  config.pcan_gain_control.offset = 80.0;
-  config.pcan_gain_control.gain_bits = 21;
-  config.log_scale.enable_log = 1;
-  config.log_scale.scale_shift = 6;
-  if (!FrontendPopulateState(&config, &g_micro_features_state,
-                             kAudioSampleFrequency)) {
-    TF_LITE_REPORT_ERROR(error_reporter, "FrontendPopulateState() failed");
+  FillMicroFeaturesFrontendConfig(&config);
+  if (!FrontendPopulateStateInArena(&config, &state_, kAudioSampleFrequency,
+                                    &arena_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "FrontendPopulateState() failed. Arena: %d / %d",
+                         static_cast<int>(arena_.used),
+                         static_cast<int>(arena_.size));
     return kTfLiteError;
   }
-  g_is_first_time = true;
+  is_initialized_ = true;
   return kTfLiteOk;
 }
 
-// This is not exposed in any header, and is only used for testing, to ensure
-// that the state is correctly set up before generating results.
-void SetMicroFeaturesNoiseEstimates(const uint32_t* estimate_presets) {
-  for (int i = 0; i < g_micro_features_state.filterbank.num_channels; ++i) {
-    g_micro_features_state.noise_reduction.estimate[i] = estimate_presets[i];
+void MicroFeaturesGenerator::SetNoiseEstimates(
+    const uint32_t* estimate_presets) {
+  for (int i = 0; i < state_.filterbank.num_channels; ++i) {
+    state_.noise_reduction.estimate[i] = estimate_presets[i];
   }
 }
 
-TfLiteStatus GenerateMicroFeatures(tflite::ErrorReporter* error_reporter,
-                                   const int16_t* input, int input_size,
-                                   int output_size, int8_t* output,
-                                   size_t* num_samples_read) {
-  const int16_t* frontend_input;
-  if (g_is_first_time) {
-    frontend_input = input;
-    g_is_first_time = false;
-  } else {
-    frontend_input = input + 160;
+void MicroFeaturesGenerator::ResetWindow() { WindowReset(&state_.window); }
+
+TfLiteStatus MicroFeaturesGenerator::Generate(
+    tflite::ErrorReporter* error_reporter, const int16_t* input,
+    int input_size, int output_size, int8_t* output,
+    size_t* num_samples_read) {
+  if (!is_initialized_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Not initialized");
+    return kTfLiteError;
   }
+  // The window already has the head of the slice (the overlap with the
+  // previous slice), so skip it.
+  const int16_t* frontend_input = input + state_.window.input_used;
   FrontendOutput frontend_output = FrontendProcessSamples(
-      &g_micro_features_state, frontend_input, input_size, num_samples_read);
+      &state_, frontend_input, input_size, num_samples_read);
+  QuantizeMicroFeatures(frontend_output, output);
 
-  for (size_t i = 0; i < frontend_output.size; ++i) {
-    // These scaling values are derived from those used in input_data.py in the
-    // training pipeline.
-    // The feature pipeline outputs 16-bit signed integers in roughly a 0 to 670
-    // range. In training, these are then arbitrarily divided by 25.6 to get
-    // float values in the rough range of 0.0 to 26.0. This scaling is performed
-    // for historical reasons, to match up with the output of other feature
-    // generators.
-    // The process is then further complicated when we quantize the model. This
-    // means we have to scale the 0.0 to 26.0 real values to the -128 to 127
-    // signed integer numbers.
-    // All this means that to get matching values from our integer feature
-    // output into the tensor input, we have to perform:
-    // input = (((feature / 25.6) / 26.0) * 256) - 128
-    // To simplify this and perform it in 32-bit integer math, we rearrange to:
-    // input = (feature * 256) / (25.6 * 26.0) - 128
-    constexpr int32_t value_scale = 256;
-    constexpr int32_t value_div = static_cast<int32_t>((25.6f * 26.0f) + 0.5f);
-    int32_t value =
-        ((frontend_output.values[i] * value_scale) + (value_div / 2)) /
-        value_div;
-    value -= 128;
-    if (value < -128) {
-      value = -128;
-    }
-    if (value > 127) {
-      value = 127;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroFeaturesGenerator::GenerateBatch(
+    tflite::ErrorReporter* error_reporter, const int16_t* samples,
+    int num_samples, int8_t* out_slices, int max_slices, int* num_slices) {
+  *num_slices = 0;
+  if (!is_initialized_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Not initialized");
+    return kTfLiteError;
+  }
+  // The window already has the head of the first slice.
+  size_t position = state_.window.input_used;
+  int slice_count = 0;
+  while (slice_count < max_slices &&
+         position < static_cast<size_t>(num_samples)) {
+    size_t num_samples_read;
+    FrontendOutput frontend_output =
+        FrontendProcessSamples(&state_, samples + position,
+                               num_samples - position, &num_samples_read);
+    position += num_samples_read;
+    if (frontend_output.size == 0) {
+      // The rest of the samples stay in the window for the next call.
+      break;
     }
-    output[i] = value;
+    QuantizeMicroFeatures(frontend_output,
+                          out_slices + slice_count * kFeatureSliceSize);
+    ++slice_count;
   }
+  *num_slices = slice_count;
 
   return kTfLiteOk;
 }
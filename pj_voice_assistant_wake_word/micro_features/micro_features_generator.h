@@ -16,17 +16,69 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_MICRO_FEATURES_MICRO_FEATURES_GENERATOR_H_
 #define TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_MICRO_FEATURES_MICRO_FEATURES_GENERATOR_H_
 
+#include <cstddef>
+#include <cstdint>
+
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "micro_features/micro_features_frontend.h"
+
+// Generates the features of one audio stream. Each generator owns its frontend
+// state (the window, the noise estimates and so on), so generators are
+// independent of each other: e.g. one per microphone, or one per thread on the
+// host. The buffers of the state are taken from the arena supplied by the
+// caller, not from the heap.
+class MicroFeaturesGenerator {
+ public:
+  // Bytes of the arena needed to set up the frontend state, calculated from
+  // the configuration (7136 bytes at the peak, and 5680 bytes stay in use
+  // after the filterbank buffers which are not needed with the fixed table are
+  // given back).
+  static constexpr size_t kArenaSize = kMicroFeaturesArenaSize;
+
+  MicroFeaturesGenerator();
+
+  // Sets up the frontend state in the arena, which must be kArenaSize bytes or
+  // more. The arena must remain accessible for the lifetime of the generator
+  // (or until Initialize is called again).
+  TfLiteStatus Initialize(tflite::ErrorReporter* error_reporter,
+                          uint8_t* arena, size_t arena_size);
+
+  // Converts audio sample data into a more compact form that's appropriate for
+  // feeding into a neural network.
+  TfLiteStatus Generate(tflite::ErrorReporter* error_reporter,
+                        const int16_t* input, int input_size, int output_size,
+                        int8_t* output, size_t* num_samples_read);
+
+  // Converts the consecutive slices in one contiguous span of audio at once.
+  // samples[0] is the first sample of the first slice, and the slices follow
+  // at the window step. The first slice must follow the last slice generated
+  // before (the overlap of the two slices is kept in the window), otherwise
+  // call ResetWindow() first. The noise reduction and PCAN state carries over
+  // from slice to slice as with Generate. Up to max_slices rows of
+  // kFeatureSliceSize are written into out_slices, and num_slices is set to
+  // the number of rows written (less than max_slices if samples run out).
+  TfLiteStatus GenerateBatch(tflite::ErrorReporter* error_reporter,
+                             const int16_t* samples, int num_samples,
+                             int8_t* out_slices, int max_slices,
+                             int* num_slices);
+
+  // Drops the audio kept in the window for the overlap with the next slice.
+  void ResetWindow();
+
+  // Only used for testing, to ensure that the state is correctly set up before
+  // generating results.
+  void SetNoiseEstimates(const uint32_t* estimate_presets);
 
-// Sets up any resources needed for the feature generation pipeline.
-TfLiteStatus InitializeMicroFeatures(tflite::ErrorReporter* error_reporter);
+  // Bytes of the arena used by the frontend state.
+  size_t arena_used() const { return arena_.used; }
 
-// Converts audio sample data into a more compact form that's appropriate for
-// feeding into a neural network.
-TfLiteStatus GenerateMicroFeatures(tflite::ErrorReporter* error_reporter,
-                                   const int16_t* input, int input_size,
-                                   int output_size, int8_t* output,
-                                   size_t* num_samples_read);
+ private:
+  FrontendState state_;
+  FrontendArena arena_;
+  bool is_initialized_;
+};
 
 #endif  // TENSORFLOW_LITE_MICRO_EXAMPLES_MICRO_SPEECH_MICRO_FEATURES_MICRO_FEATURES_GENERATOR_H_
@@ -19,6 +19,8 @@ limitations under the License.
 #include <cstdint>
 #include <cstdio>
 #include <vector>
+#include <algorithm>
+#include <atomic>
 
 /*** Buffer structure
  *   |------------------------------------------|
@@ -30,18 +32,34 @@ limitations under the License.
  *   |------------------------------------------|
  ***/
 
- /*** Notice
-  * Mutex is not implemented!!!
-  ***/
+/*** Notice
+ * Lock-free for single producer (e.g. DMA IRQ) and single consumer (e.g. main loop)
+ *   - Write functions (Write, WritePtr, GetLatestWritePtr, ReservePtr, Commit, Drop) must be called only from the producer
+ *   - Read functions (ReadPtr, ReferPtr, ReferStamp) must be called only from the consumer
+ *   - WP and RP are not stored. They are calculated from the accumulated counters
+ *     - The producer updates only accumulated_stored_data_num_ (release) and the consumer updates only accumulated_read_data_num_ (release)
+ * The number of blocks is rounded up to power of 2, so that the index can be calculated by mask
+ ***/
+
+/*** Block stamp
+ * Each block is stamped by the producer when it's committed, so that the consumer can locate audio by sample index
+ * The sample index keeps counting over dropped blocks (Drop), so a gap in sample index means the audio is lost there
+ ***/
+typedef struct {
+    uint64_t sample_index;  // index of the first sample in the block (0 = the first sample after Initialize)
+    uint64_t time_us;       // capture time of the block (0 if unknown)
+} BlockStamp;
 
 template<class T>
 class RingBlockBuffer
 {
 public:
     RingBlockBuffer()
-        : wp_(0)
-        , rp_(0)
-        // , stored_data_num_(0)
+        : buffer_(nullptr)
+        , stamps_(nullptr)
+        , block_size_(0)
+        , mask_(0)
+        , next_sample_index_(0)
         , accumulated_stored_data_num_(0)
         , accumulated_read_data_num_(0) {
     };
@@ -49,81 +67,86 @@ public:
     ~RingBlockBuffer() {
     };
 
+    /* All blocks are allocated at once in a contiguous area */
     void Initialize(int32_t buffer_size, int32_t block_size) {
-        buffer_.resize(buffer_size);
-        for (auto& block : buffer_) {
-            block.resize(block_size);
-        }
-
-        wp_ = 0;
-        rp_ = 0;
-        // stored_data_num_ = 0;
-        accumulated_stored_data_num_ = 0;
-        accumulated_read_data_num_ = 0;
+        int32_t block_num = 1;
+        while (block_num < buffer_size) block_num <<= 1;
+        storage_.assign(static_cast<size_t>(block_num) * block_size, T());
+        stamp_storage_.assign(block_num, BlockStamp());
+        InitializeWithStorage(storage_.data(), stamp_storage_.data(), block_num, block_size);
     }
 
     void Finalize() {
-        for (auto& block : buffer_) {
-            block.clear();
-        }
-        buffer_.clear();
+        if (storage_.empty()) return;   // the storage is not owned (StaticRingBlockBuffer)
+        storage_.clear();
+        storage_.shrink_to_fit();
+        stamp_storage_.clear();
+        stamp_storage_.shrink_to_fit();
+        buffer_ = nullptr;
+        stamps_ = nullptr;
     }
 
-    void Write(const std::vector<T>& data) {
+    void Write(const std::vector<T>& data, uint64_t time_us = 0) {
         if (IsOverflow()) return;
-        buffer_[wp_] = data;
-        IncrementWp();
+        std::copy(data.begin(), data.begin() + std::min(static_cast<int32_t>(data.size()), block_size_), BlockPtr(WriteIndex()));
+        Commit(time_us);
     }
 
-    T* WritePtr() {
+    /* The block is stamped (and visible to the consumer) at this call. Fill it before the consumer reads it */
+    T* WritePtr(uint64_t time_us = 0) {
         if (IsOverflow()) return NULL;
-        T* ptr = buffer_[wp_].data();
-        IncrementWp();
+        T* ptr = BlockPtr(WriteIndex());
+        Commit(time_us);
         return ptr;
     }
 
 
-    T* GetLatestWritePtr() {
-        int32_t previous_wp = wp_ - 1;
-        if (previous_wp < 0) previous_wp += buffer_.size();
-        T* ptr = buffer_[previous_wp].data();
-        return ptr;
+    /* For producers which fill a block asynchronously (e.g. DMA). A reserved block is not visible to the consumer until it's committed */
+    /* pos: 0 = the block to be committed next, 1 = the block after it. Returns NULL if the block is not free */
+    T* ReservePtr(int32_t pos) {
+        if (stored_data_num() + pos > static_cast<int32_t>(mask_)) return NULL;
+        return BlockPtr((WriteIndex() + pos) & mask_);
     }
 
-    std::vector<T>& Read() {
-        int32_t previous_rp = rp_;
-        IncrementRp();
-        return buffer_[previous_rp];
+    /* Stamp and publish the block reserved at pos = 0 */
+    void Commit(uint64_t time_us = 0) {
+        BlockStamp& stamp = stamps_[WriteIndex()];
+        stamp.sample_index = next_sample_index_;
+        stamp.time_us = time_us;
+        next_sample_index_ += block_size_;
+        IncrementWp();
     }
 
-    // do not update RP. 0 = current, 1 = next, 2 = next next (NOTE: underflow is not checked)
-    std::vector<T>& Refer(int32_t pos) {
-        int32_t index = rp_ + pos;
-        if (index >= buffer_.size()) index -= buffer_.size();
-        std::vector<T>& read_data = buffer_[index];
-        return read_data;
+    /* The producer lost one block (e.g. overrun). Only the sample index advances */
+    void Drop() {
+        next_sample_index_ += block_size_;
+    }
+
+    T* GetLatestWritePtr() {
+        uint32_t previous_wp = (WriteIndex() - 1) & mask_;
+        T* ptr = BlockPtr(previous_wp);
+        return ptr;
     }
 
     T* ReadPtr() {
-        std::vector<T>& read_data = buffer_[rp_];
+        T* ptr = BlockPtr(ReadIndex());
         IncrementRp();
-        return read_data.data();
+        return ptr;
     }
 
     // do not update RP. 0 = current, 1 = next, 2 = next next (NOTE: underflow is not checked)
     T* ReferPtr(int32_t pos) {
-        int32_t index = rp_ + pos;
-        if (index >= buffer_.size()) index -= buffer_.size();
-        std::vector<T>& readData = buffer_[index];
-        return readData.data();
+        uint32_t index = (ReadIndex() + pos) & mask_;
+        return BlockPtr(index);
+    }
+
+    /* Stamp of the block at ReferPtr(pos). pos must be less than stored_data_num() */
+    const BlockStamp& ReferStamp(int32_t pos) const {
+        return stamps_[(ReadIndex() + pos) & mask_];
     }
 
     bool IsOverflow() const {
-        if (wp_ == rp_ && stored_data_num() > 0) {
-            return true;
-        } else {
-            return false;
-        }
+        return stored_data_num() > static_cast<int32_t>(mask_);
     }
 
     bool IsUnderflow() const {
@@ -131,43 +154,103 @@ public:
     }
 
     int32_t stored_data_num() const {
-        // return stored_data_num_;
-        return accumulated_stored_data_num_ - accumulated_read_data_num_;
+        /* unsigned subtraction works even after the counters wrap around */
+        return static_cast<int32_t>(accumulated_stored_data_num_.load(std::memory_order_acquire) - accumulated_read_data_num_.load(std::memory_order_acquire));
     }
 
     int32_t accumulated_stored_data_num() const {
-        return accumulated_stored_data_num_;
+        return static_cast<int32_t>(accumulated_stored_data_num_.load(std::memory_order_acquire));
     }
 
     int32_t accumulated_read_data_num() const {
-        return accumulated_read_data_num_;
+        return static_cast<int32_t>(accumulated_read_data_num_.load(std::memory_order_acquire));
+    }
+
+    int32_t block_num() const {
+        return static_cast<int32_t>(mask_ + 1);
+    }
+
+    int32_t block_size() const {
+        return block_size_;
+    }
+
+protected:
+    /* storage must have block_num * block_size elements, and stamps must have block_num elements. block_num must be 2^x */
+    void InitializeWithStorage(T* storage, BlockStamp* stamps, int32_t block_num, int32_t block_size) {
+        buffer_ = storage;
+        stamps_ = stamps;
+        block_size_ = block_size;
+        mask_ = static_cast<uint32_t>(block_num - 1);
+        next_sample_index_ = 0;
+
+        accumulated_stored_data_num_.store(0, std::memory_order_relaxed);
+        accumulated_read_data_num_.store(0, std::memory_order_relaxed);
     }
 
 private:
+    T* BlockPtr(uint32_t index) const {
+        return buffer_ + index * block_size_;
+    }
+
+    /* Only the owner of each counter modifies it, so relaxed load + release store is enough (no read-modify-write) */
+    uint32_t WriteIndex() const {
+        return accumulated_stored_data_num_.load(std::memory_order_relaxed) & mask_;
+    }
+
+    uint32_t ReadIndex() const {
+        return accumulated_read_data_num_.load(std::memory_order_relaxed) & mask_;
+    }
+
     void IncrementWp() {
-        accumulated_stored_data_num_++;
-        // stored_data_num_++;
-        wp_++;
-        if (wp_ >= buffer_.size()) wp_ = 0;
+        accumulated_stored_data_num_.store(accumulated_stored_data_num_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
     }
 
     void IncrementRp() {
         if (!IsUnderflow()) {
-            accumulated_read_data_num_++;
-            // stored_data_num_--;
-            rp_++;
-            if (rp_ >= buffer_.size()) rp_ = 0;
-
+            accumulated_read_data_num_.store(accumulated_read_data_num_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
         }
     }
 
 private:
-    std::vector<std::vector<T>> buffer_;
-    int32_t wp_;
-    int32_t rp_;
-    // int32_t stored_data_num_;
-    int32_t accumulated_stored_data_num_;
-    int32_t accumulated_read_data_num_;
+    std::vector<T> storage_;
+    std::vector<BlockStamp> stamp_storage_;
+    T* buffer_;
+    BlockStamp* stamps_;
+    int32_t block_size_;
+    uint32_t mask_;
+    uint64_t next_sample_index_;    // used only by the producer
+    std::atomic<uint32_t> accumulated_stored_data_num_;
+    std::atomic<uint32_t> accumulated_read_data_num_;
+};
+
+/*** Compile-time sized version
+ * All blocks are placed in an aligned array in the object itself (no heap allocation)
+ * It can be used as a DMA target when the object is placed in static memory
+ * The array is never replaced or released: Initialize(buffer_size, block_size) and Finalize() are not available. It can't be copied
+ ***/
+template<class T, size_t kBlocks, size_t kBlockSize>
+class StaticRingBlockBuffer : public RingBlockBuffer<T>
+{
+    static_assert(kBlocks > 0 && (kBlocks & (kBlocks - 1)) == 0, "kBlocks must be 2^x");
+
+public:
+    StaticRingBlockBuffer() {
+        Initialize();
+    }
+
+    StaticRingBlockBuffer(const StaticRingBlockBuffer&) = delete;
+    StaticRingBlockBuffer& operator=(const StaticRingBlockBuffer&) = delete;
+
+    void Initialize() {
+        this->InitializeWithStorage(storage_, stamp_storage_, kBlocks, kBlockSize);
+    }
+
+    void Initialize(int32_t buffer_size, int32_t block_size) = delete;
+    void Finalize() = delete;
+
+private:
+    alignas(4) T storage_[kBlocks * kBlockSize];
+    BlockStamp stamp_storage_[kBlocks];
 };
 
 #endif  // RING_BLOCK_BUFFER_H_
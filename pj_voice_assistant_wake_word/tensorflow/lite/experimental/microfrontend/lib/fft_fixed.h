@@ -0,0 +1,484 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_FIXED_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_FIXED_H_
+
+// int16 real FFT specialized for a power-of-two size known at compile time.
+//
+// The output is bit-exact with kiss_fftr (FIXED_POINT=16) of the same size:
+//   - The twiddle tables hold the same values as kiss_fft_alloc and
+//     kiss_fftr_alloc calculate at runtime, but they are constexpr (in flash).
+//   - The radix-4 (and one radix-2 if needed) stages are the ones kf_factor
+//     selects, and each butterfly does the same fixed-point operations as
+//     kf_bfly4 / kf_bfly2. Only the recursion of kf_work is replaced with an
+//     input permutation table and iterative stages.
+//   - The input is read directly from the caller's buffer in the first stage.
+//     The zero padding up to the FFT size is not materialized, and the first
+//     stage butterflies whose inputs are all zero are skipped.
+//   - The butterflies with the twiddle factor of index 0 ( = 32767 + 0i) skip
+//     the multiplication. It's exact because the inputs are already scaled
+//     down by C_FIXDIV, and sround(x * 32767) == x for |x| < 16384.
+// The FFT runs in place in the output buffer, so no scratch buffer is needed.
+//
+// ComputeEnergy fuses FilterbankConvertFftComplexToEnergy into the FFT: the
+// square magnitude is calculated while the spectrum is written.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/fft.h"
+
+namespace fft_fixed {
+
+namespace internal {
+
+constexpr double kPi =
+    3.141592653589793238462643383279502884197169399375105820974944;
+
+// sin(x) and cos(x) for |x| <= pi/4 (error < 1e-16).
+constexpr double SinTaylor(double x) {
+  const double x2 = x * x;
+  double term = x;
+  double sum = x;
+  for (int n = 1; n <= 12; ++n) {
+    term *= -x2 / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double CosTaylor(double x) {
+  const double x2 = x * x;
+  double term = 1.0;
+  double sum = 1.0;
+  for (int n = 1; n <= 12; ++n) {
+    term *= -x2 / ((2 * n - 1) * (2 * n));
+    sum += term;
+  }
+  return sum;
+}
+
+// cos(phase) for |phase| <= 2 * pi.
+constexpr double Cos(double phase) {
+  const double quarter = kPi / 2;
+  double q = phase / quarter;
+  const int quadrant = static_cast<int>(q < 0 ? q - 0.5 : q + 0.5);
+  const double r = phase - quadrant * quarter;
+  switch (quadrant & 3) {
+    case 0:
+      return CosTaylor(r);
+    case 1:
+      return -SinTaylor(r);
+    case 2:
+      return -CosTaylor(r);
+    default:
+      return SinTaylor(r);
+  }
+}
+
+constexpr double Sin(double phase) { return Cos(phase - kPi / 2); }
+
+// The same as KISS_FFT_COS / KISS_FFT_SIN for FIXED_POINT=16.
+constexpr int16_t ToQ15(double value) {
+  const double v = 0.5 + 32767 * value;
+  int32_t floor_v = static_cast<int32_t>(v);
+  if (floor_v > v) --floor_v;
+  return static_cast<int16_t>(floor_v);
+}
+
+// sround(smul(a, b)) in _kiss_fft_guts.h.
+inline int16_t MulQ15(int32_t a, int32_t b) {
+  return static_cast<int16_t>((a * b + (1 << 14)) >> 15);
+}
+
+// C_FIXDIV(x, 4) and C_FIXDIV(x, 2): sround(x * (SAMP_MAX / div)).
+inline void FixDiv4(complex_int16_t* c) {
+  c->real = MulQ15(c->real, 32767 / 4);
+  c->imag = MulQ15(c->imag, 32767 / 4);
+}
+
+inline void FixDiv2(complex_int16_t* c) {
+  c->real = MulQ15(c->real, 32767 / 2);
+  c->imag = MulQ15(c->imag, 32767 / 2);
+}
+
+// C_MUL.
+inline complex_int16_t Mul(const complex_int16_t& a,
+                           const complex_int16_t& b) {
+  complex_int16_t m;
+  m.real = static_cast<int16_t>(
+      (a.real * b.real - a.imag * b.imag + (1 << 14)) >> 15);
+  m.imag = static_cast<int16_t>(
+      (a.real * b.imag + a.imag * b.real + (1 << 14)) >> 15);
+  return m;
+}
+
+}  // namespace internal
+
+// Input sample i of the FFT: input[i] << shift, as FftCompute prepares the
+// input of kiss_fftr.
+struct ScaledInput {
+  const int16_t* input;
+  int shift;
+  int16_t operator()(int i) const {
+    return static_cast<int16_t>(static_cast<uint16_t>(input[i]) << shift);
+  }
+};
+
+// Stores bin k of the spectrum.
+struct ComplexOutput {
+  void operator()(complex_int16_t* freq, int k, int16_t real,
+                  int16_t imag) const {
+    freq[k].real = real;
+    freq[k].imag = imag;
+  }
+};
+
+// Stores the square magnitude of bin k in [start_index, end_index) as int32_t
+// in place of the bin, as FilterbankConvertFftComplexToEnergy does.
+struct EnergyOutput {
+  int start_index;
+  int end_index;
+  void operator()(complex_int16_t* freq, int k, int16_t real,
+                  int16_t imag) const {
+    if (k < start_index || k >= end_index) return;
+    const int32_t r = real;
+    const int32_t i = imag;
+    reinterpret_cast<int32_t*>(freq)[k] = static_cast<int32_t>(
+        static_cast<uint32_t>(r * r) + static_cast<uint32_t>(i * i));
+  }
+};
+
+template <int kFftSize>
+class RealFft {
+ public:
+  static_assert(kFftSize >= 8 && (kFftSize & (kFftSize - 1)) == 0,
+                "kFftSize must be 2^x (>= 8)");
+  // The size of the complex FFT which calculates the real FFT.
+  static constexpr int kComplexSize = kFftSize / 2;
+  // kf_factor takes 4 as long as possible, then 2.
+  static constexpr int kRadix4StageNum = [] {
+    int n = 0;
+    for (int size = kComplexSize; size % 4 == 0; size /= 4) ++n;
+    return n;
+  }();
+  static constexpr bool kHasRadix2Stage =
+      (kComplexSize >> (2 * kRadix4StageNum)) == 2;
+
+  // input: input_size samples (<= kFftSize). They are shifted left by
+  // input_scale_shift, and the rest up to kFftSize is zero, as FftCompute
+  // prepares the input of kiss_fftr. output: kFftSize / 2 + 1 bins.
+  static void Compute(const int16_t* input, int input_size,
+                      int input_scale_shift, complex_int16_t* output) {
+    Run(ScaledInput{input, input_scale_shift}, input_size, ComplexOutput(),
+        output);
+  }
+
+  // input: kFftSize samples.
+  static void Compute(const int16_t* input, complex_int16_t* output) {
+    Compute(input, kFftSize, 0, output);
+  }
+
+  // The same input as Compute. buffer: kFftSize / 2 + 1 bins. The energy of
+  // the bins in [start_index, end_index) is written in buffer as int32_t
+  // (energy[k] is at the address of bin k). The other bins are undefined.
+  static void ComputeEnergy(const int16_t* input, int input_size,
+                            int input_scale_shift, int start_index,
+                            int end_index, complex_int16_t* buffer) {
+    Run(ScaledInput{input, input_scale_shift}, input_size,
+        EnergyOutput{start_index, end_index}, buffer);
+  }
+
+ private:
+  template <class Input, class Output>
+  static void Run(const Input& input, int input_size, const Output& store,
+                  complex_int16_t* output) {
+    // The innermost factor of kf_factor is combined first. Its butterflies
+    // read the input in the order of the decimation (the leaves of kf_work),
+    // and need no twiddle factor. The input is prepared while it's read, and
+    // only the groups which include the zero padding check the input size.
+    const int full_num = input_size / 2;  // complex samples in the input
+    int m;
+    if (kHasRadix2Stage) {
+      constexpr int kLaneStride = kComplexSize / 2;
+      for (int g = 0; g < kComplexSize / 2; ++g) {
+        const int j = kGroupBase[g];
+        complex_int16_t f0, f1;
+        if (j + kLaneStride < full_num) {
+          f0 = LoadInput(input, j);
+          f1 = LoadInput(input, j + kLaneStride);
+        } else if (2 * j < input_size) {
+          f0 = LoadInput(input, input_size, j);
+          f1 = LoadInput(input, input_size, j + kLaneStride);
+        } else {
+          output[2 * g] = output[2 * g + 1] = complex_int16_t{0, 0};
+          continue;
+        }
+        internal::FixDiv2(&f0);
+        internal::FixDiv2(&f1);
+        output[2 * g].real = static_cast<int16_t>(f0.real + f1.real);
+        output[2 * g].imag = static_cast<int16_t>(f0.imag + f1.imag);
+        output[2 * g + 1].real = static_cast<int16_t>(f0.real - f1.real);
+        output[2 * g + 1].imag = static_cast<int16_t>(f0.imag - f1.imag);
+      }
+      m = 2;
+    } else {
+      constexpr int kLaneStride = kComplexSize / 4;
+      for (int g = 0; g < kComplexSize / 4; ++g) {
+        const int j = kGroupBase[g];
+        complex_int16_t* fout = output + 4 * g;
+        complex_int16_t f0, f1, f2, f3;
+        if (j + 3 * kLaneStride < full_num) {
+          f0 = LoadInput(input, j);
+          f1 = LoadInput(input, j + kLaneStride);
+          f2 = LoadInput(input, j + 2 * kLaneStride);
+          f3 = LoadInput(input, j + 3 * kLaneStride);
+        } else if (2 * j < input_size) {
+          f0 = LoadInput(input, input_size, j);
+          f1 = LoadInput(input, input_size, j + kLaneStride);
+          f2 = LoadInput(input, input_size, j + 2 * kLaneStride);
+          f3 = LoadInput(input, input_size, j + 3 * kLaneStride);
+        } else {
+          // All the inputs are zero, and so are the outputs.
+          fout[0] = fout[1] = fout[2] = fout[3] = complex_int16_t{0, 0};
+          continue;
+        }
+        internal::FixDiv4(&f0);
+        internal::FixDiv4(&f1);
+        internal::FixDiv4(&f2);
+        internal::FixDiv4(&f3);
+        Radix4(f0, f1, f2, f3, fout, 1);
+      }
+      m = 4;
+    }
+
+    const complex_int16_t* twiddles = kStageTwiddles.data();
+    for (; m < kComplexSize; m *= 4) {
+      for (int i = 0; i < kComplexSize; i += 4 * m) {
+        Butterfly4(output + i, twiddles, m);
+      }
+      twiddles += 3 * (m - 1);
+    }
+
+    SplitRealSpectrum(output, store);
+  }
+
+  static constexpr int kFirstRadix = kHasRadix2Stage ? 2 : 4;
+
+  // Index of the first complex input of each group of the first stage.
+  // The other inputs of the group follow at the stride of
+  // kComplexSize / kFirstRadix.
+  static constexpr std::array<uint16_t, kComplexSize / kFirstRadix>
+      kGroupBase = [] {
+        std::array<uint16_t, kComplexSize / kFirstRadix> table{};
+        for (int g = 0; g < kComplexSize / kFirstRadix; ++g) {
+          // Digits of the position (outermost factor first) give the input
+          // index in the reversed order.
+          int rest = g * kFirstRadix;
+          int size = kComplexSize;
+          int stride = 1;
+          int index = 0;
+          const int stage_num = kRadix4StageNum + (kHasRadix2Stage ? 1 : 0);
+          for (int stage = 0; stage < stage_num; ++stage) {
+            const int radix = (stage < kRadix4StageNum) ? 4 : 2;
+            size /= radix;
+            index += (rest / size) * stride;
+            rest %= size;
+            stride *= radix;
+          }
+          table[g] = static_cast<uint16_t>(index);
+        }
+        return table;
+      }();
+
+  // Complex input sample j. Both parts must be in the input.
+  template <class Input>
+  static inline complex_int16_t LoadInput(const Input& input, int j) {
+    complex_int16_t c;
+    c.real = input(2 * j);
+    c.imag = input(2 * j + 1);
+    return c;
+  }
+
+  // Complex input sample j with the zero padding after input_size.
+  template <class Input>
+  static inline complex_int16_t LoadInput(const Input& input, int input_size,
+                                          int j) {
+    complex_int16_t c = {0, 0};
+    if (2 * j < input_size) c.real = input(2 * j);
+    if (2 * j + 1 < input_size) c.imag = input(2 * j + 1);
+    return c;
+  }
+
+  // The radix-4 stages after the first one (m = 2 or 4, then x4).
+  static constexpr int kStageTwiddleNum = [] {
+    int num = 0;
+    for (int m = kHasRadix2Stage ? 2 : 4; m < kComplexSize; m *= 4) {
+      num += 3 * (m - 1);
+    }
+    return num;
+  }();
+
+  // st->twiddles of kiss_fft_alloc in the order Butterfly4 refers to them:
+  // for each stage, tw[k * fstride], tw[2 * k * fstride], tw[3 * k * fstride]
+  // for k = 1, ..., m - 1.
+  static constexpr std::array<complex_int16_t, kStageTwiddleNum>
+      kStageTwiddles = [] {
+        std::array<complex_int16_t, kStageTwiddleNum> table{};
+        int n = 0;
+        for (int m = kHasRadix2Stage ? 2 : 4; m < kComplexSize; m *= 4) {
+          const int fstride = kComplexSize / (4 * m);
+          for (int k = 1; k < m; ++k) {
+            for (int q = 1; q <= 3; ++q) {
+              const int i = q * k * fstride;
+              const double phase = -2 * internal::kPi * i / kComplexSize;
+              table[n].real = internal::ToQ15(internal::Cos(phase));
+              table[n].imag = internal::ToQ15(internal::Sin(phase));
+              ++n;
+            }
+          }
+        }
+        return table;
+      }();
+
+  // st->super_twiddles of kiss_fftr_alloc.
+  static constexpr std::array<complex_int16_t, kComplexSize / 2>
+      kSuperTwiddles = [] {
+        std::array<complex_int16_t, kComplexSize / 2> table{};
+        for (int i = 0; i < kComplexSize / 2; ++i) {
+          const double phase =
+              -internal::kPi *
+              (static_cast<double>(i + 1) / kComplexSize + .5);
+          table[i].real = internal::ToQ15(internal::Cos(phase));
+          table[i].imag = internal::ToQ15(internal::Sin(phase));
+        }
+        return table;
+      }();
+
+  // The part of kf_bfly4 (forward) after the twiddle multiplication.
+  static inline void Radix4(complex_int16_t f0, const complex_int16_t& s0,
+                            const complex_int16_t& s1,
+                            const complex_int16_t& s2, complex_int16_t* fout,
+                            int m) {
+    complex_int16_t s3, s4, s5;
+    s5.real = static_cast<int16_t>(f0.real - s1.real);
+    s5.imag = static_cast<int16_t>(f0.imag - s1.imag);
+    f0.real = static_cast<int16_t>(f0.real + s1.real);
+    f0.imag = static_cast<int16_t>(f0.imag + s1.imag);
+    s3.real = static_cast<int16_t>(s0.real + s2.real);
+    s3.imag = static_cast<int16_t>(s0.imag + s2.imag);
+    s4.real = static_cast<int16_t>(s0.real - s2.real);
+    s4.imag = static_cast<int16_t>(s0.imag - s2.imag);
+    fout[2 * m].real = static_cast<int16_t>(f0.real - s3.real);
+    fout[2 * m].imag = static_cast<int16_t>(f0.imag - s3.imag);
+    fout[0].real = static_cast<int16_t>(f0.real + s3.real);
+    fout[0].imag = static_cast<int16_t>(f0.imag + s3.imag);
+    fout[m].real = static_cast<int16_t>(s5.real + s4.imag);
+    fout[m].imag = static_cast<int16_t>(s5.imag - s4.real);
+    fout[3 * m].real = static_cast<int16_t>(s5.real - s4.imag);
+    fout[3 * m].imag = static_cast<int16_t>(s5.imag + s4.real);
+  }
+
+  // kf_bfly4 (forward). twiddles: the part of kStageTwiddles for this stage.
+  static void Butterfly4(complex_int16_t* fout,
+                         const complex_int16_t* twiddles, int m) {
+    for (int k = 0; k < m; ++k) {
+      complex_int16_t f0 = fout[k];
+      complex_int16_t f1 = fout[k + m];
+      complex_int16_t f2 = fout[k + 2 * m];
+      complex_int16_t f3 = fout[k + 3 * m];
+      internal::FixDiv4(&f0);
+      internal::FixDiv4(&f1);
+      internal::FixDiv4(&f2);
+      internal::FixDiv4(&f3);
+      if (k == 0) {
+        Radix4(f0, f1, f2, f3, fout, m);
+      } else {
+        const complex_int16_t* tw = &twiddles[3 * (k - 1)];
+        Radix4(f0, internal::Mul(f1, tw[0]), internal::Mul(f2, tw[1]),
+               internal::Mul(f3, tw[2]), fout + k, m);
+      }
+    }
+  }
+
+  // The second half of kiss_fftr. It works in place because the bins k and
+  // kComplexSize - k are calculated from the same two complex bins.
+  template <class Output>
+  static void SplitRealSpectrum(complex_int16_t* freq, const Output& store) {
+    complex_int16_t tdc = freq[0];
+    internal::FixDiv2(&tdc);
+    store(freq, 0, static_cast<int16_t>(tdc.real + tdc.imag), 0);
+    store(freq, kComplexSize, static_cast<int16_t>(tdc.real - tdc.imag), 0);
+
+    for (int k = 1; k <= kComplexSize / 2; ++k) {
+      complex_int16_t fpk = freq[k];
+      complex_int16_t fpnk;
+      fpnk.real = freq[kComplexSize - k].real;
+      fpnk.imag = static_cast<int16_t>(-freq[kComplexSize - k].imag);
+      internal::FixDiv2(&fpk);
+      internal::FixDiv2(&fpnk);
+      complex_int16_t f1k, f2k;
+      f1k.real = static_cast<int16_t>(fpk.real + fpnk.real);
+      f1k.imag = static_cast<int16_t>(fpk.imag + fpnk.imag);
+      f2k.real = static_cast<int16_t>(fpk.real - fpnk.real);
+      f2k.imag = static_cast<int16_t>(fpk.imag - fpnk.imag);
+      const complex_int16_t tw = internal::Mul(f2k, kSuperTwiddles[k - 1]);
+      store(freq, k, static_cast<int16_t>((f1k.real + tw.real) >> 1),
+            static_cast<int16_t>((f1k.imag + tw.imag) >> 1));
+      store(freq, kComplexSize - k,
+            static_cast<int16_t>((f1k.real - tw.real) >> 1),
+            static_cast<int16_t>((tw.imag - f1k.imag) >> 1));
+    }
+  }
+};
+
+// The sizes used by the frontend. Add a size here to specialize it.
+constexpr bool IsSupported(size_t fft_size) { return fft_size == 512; }
+
+// Returns false if fft_size is not supported (use kiss_fftr instead).
+// input: input_size samples to be shifted left by input_scale_shift.
+inline bool Compute(size_t fft_size, const int16_t* input, size_t input_size,
+                    int input_scale_shift, complex_int16_t* output) {
+  switch (fft_size) {
+    case 512:
+      RealFft<512>::Compute(input, static_cast<int>(input_size),
+                            input_scale_shift, output);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns false if fft_size is not supported (nothing is calculated).
+inline bool ComputeEnergy(size_t fft_size, const int16_t* input,
+                          size_t input_size, int input_scale_shift,
+                          int start_index, int end_index,
+                          complex_int16_t* buffer) {
+  switch (fft_size) {
+    case 512:
+      RealFft<512>::ComputeEnergy(input, static_cast<int>(input_size),
+                                  input_scale_shift, start_index, end_index,
+                                  buffer);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace fft_fixed
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_FIXED_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_UTIL_H_
 
 #include "tensorflow/lite/experimental/microfrontend/lib/fft.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,10 @@ extern "C" {
 // Prepares and FFT for the given input size.
 int FftPopulateState(struct FftState* state, size_t input_size);
 
+// The same as FftPopulateState, but the buffers are taken from the arena.
+int FftPopulateStateInArena(struct FftState* state, size_t input_size,
+                            struct FrontendArena* arena);
+
 // Frees any allocated buffers.
 void FftFreeStateContents(struct FftState* state);
 
@@ -36,6 +36,10 @@ struct FilterbankState {
   int16_t* weights;
   int16_t* unweights;
   uint64_t* work;
+  // Set by FilterbankPopulateState when the channels are the ones of the
+  // table in filterbank_fixed.h. The per-channel arrays and the weights are
+  // not allocated then.
+  int use_fixed_table;
 };
 
 // Converts the relevant complex values of an FFT output into energy (the
@@ -49,6 +53,14 @@ void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
 void FilterbankAccumulateChannels(struct FilterbankState* state,
                                   const int32_t* energy);
 
+// Returns 1 if the channels and the weights of the state are the same as the
+// table in filterbank_fixed.h, so that the table can be used instead.
+int FilterbankMatchesFixedTable(const struct FilterbankState* state);
+
+// FilterbankAccumulateChannels with the table in filterbank_fixed.h.
+void FilterbankAccumulateChannelsFixed(struct FilterbankState* state,
+                                       const int32_t* energy);
+
 // Applies an integer square root to the 64 bit intermediate values of the
 // filterbank, and returns a pointer to them. Memory will be invalidated the
 // next time FilterbankAccumulateChannels is called.
@@ -0,0 +1,71 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void FrontendArenaInit(struct FrontendArena* arena, void* buffer, size_t size) {
+  // Skip the head of the buffer up to the alignment.
+  const size_t misalignment =
+      (size_t)((uintptr_t)buffer % kFrontendArenaAlignment);
+  const size_t skip =
+      (misalignment == 0) ? 0 : kFrontendArenaAlignment - misalignment;
+  arena->buffer = (uint8_t*)buffer + skip;
+  arena->size = (size > skip) ? size - skip : 0;
+  arena->used = 0;
+}
+
+void* FrontendArenaAlloc(struct FrontendArena* arena, size_t size) {
+  if (arena == NULL) {
+    return malloc(size);
+  }
+  const size_t offset = arena->used;
+  const size_t aligned_size = (size + kFrontendArenaAlignment - 1) &
+                              ~(size_t)(kFrontendArenaAlignment - 1);
+  arena->used += aligned_size;
+  if (arena->used > arena->size) {
+    return NULL;
+  }
+  return arena->buffer + offset;
+}
+
+void* FrontendArenaCalloc(struct FrontendArena* arena, size_t num,
+                          size_t size) {
+  if (arena == NULL) {
+    return calloc(num, size);
+  }
+  void* ptr = FrontendArenaAlloc(arena, num * size);
+  if (ptr != NULL) {
+    memset(ptr, 0, num * size);
+  }
+  return ptr;
+}
+
+void FrontendArenaFree(struct FrontendArena* arena, void* ptr) {
+  if (arena == NULL) {
+    free(ptr);
+  }
+}
+
+size_t FrontendArenaMark(const struct FrontendArena* arena) {
+  return (arena == NULL) ? 0 : arena->used;
+}
+
+void FrontendArenaRelease(struct FrontendArena* arena, size_t mark) {
+  if (arena != NULL && mark < arena->used) {
+    arena->used = mark;
+  }
+}
@@ -29,38 +29,47 @@ void FrontendFillConfigWithDefaults(struct FrontendConfig* config) {
 
 int FrontendPopulateState(const struct FrontendConfig* config,
                           struct FrontendState* state, int sample_rate) {
+  return FrontendPopulateStateInArena(config, state, sample_rate, NULL);
+}
+
+int FrontendPopulateStateInArena(const struct FrontendConfig* config,
+                                 struct FrontendState* state, int sample_rate,
+                                 struct FrontendArena* arena) {
   memset(state, 0, sizeof(*state));
 
-  if (!WindowPopulateState(&config->window, &state->window, sample_rate)) {
+  if (!WindowPopulateStateInArena(&config->window, &state->window, sample_rate,
+                                  arena)) {
     fprintf(stderr, "Failed to populate window state\n");
     return 0;
   }
 
-  if (!FftPopulateState(&state->fft, state->window.size)) {
+  if (!FftPopulateStateInArena(&state->fft, state->window.size, arena)) {
     fprintf(stderr, "Failed to populate fft state\n");
     return 0;
   }
   FftInit(&state->fft);
 
-  if (!FilterbankPopulateState(&config->filterbank, &state->filterbank,
-                               sample_rate, state->fft.fft_size / 2 + 1)) {
+  if (!FilterbankPopulateStateInArena(&config->filterbank, &state->filterbank,
+                                      sample_rate, state->fft.fft_size / 2 + 1,
+                                      arena)) {
     fprintf(stderr, "Failed to populate filterbank state\n");
     return 0;
   }
 
-  if (!NoiseReductionPopulateState(&config->noise_reduction,
-                                   &state->noise_reduction,
-                                   state->filterbank.num_channels)) {
+  if (!NoiseReductionPopulateStateInArena(
+          &config->noise_reduction, &state->noise_reduction,
+          state->filterbank.num_channels, arena)) {
     fprintf(stderr, "Failed to populate noise reduction state\n");
     return 0;
   }
 
   int input_correction_bits =
       MostSignificantBit32(state->fft.fft_size) - 1 - (kFilterbankBits / 2);
-  if (!PcanGainControlPopulateState(
+  if (!PcanGainControlPopulateStateInArena(
           &config->pcan_gain_control, &state->pcan_gain_control,
           state->noise_reduction.estimate, state->filterbank.num_channels,
-          state->noise_reduction.smoothing_bits, input_correction_bits)) {
+          state->noise_reduction.smoothing_bits, input_correction_bits,
+          arena)) {
     fprintf(stderr, "Failed to populate pcan gain control state\n");
     return 0;
   }
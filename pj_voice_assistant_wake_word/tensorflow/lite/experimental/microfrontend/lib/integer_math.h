@@ -0,0 +1,183 @@
+/* Copyright 2021 iwatake2222
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_INTEGER_MATH_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_INTEGER_MATH_H_
+
+// Integer square root and logarithm used by FilterbankSqrt and LogScaleApply.
+//
+// The results are bit-exact with the bit-by-bit square root and the log of the
+// TFLM microfrontend, but:
+//   - The square root starts from a table seed and refines it with Newton
+//     steps, instead of calculating one bit per iteration. The 64-bit one
+//     stays bit-by-bit on Cortex-M0+ (see IntegerSqrt64).
+//   - Count leading zeros uses a table on Cortex-M0+, which has no CLZ
+//     instruction, and __builtin_clz elsewhere.
+//   - The log does only 32-bit multiplications.
+
+#include <stdint.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/log_lut.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// kClzLut[n] is the number of leading zeros of the 8-bit value n.
+extern const uint8_t kClzLut[];
+// kSqrtSeedLut[i - 64] is ceil(sqrt((i + 1) << 24)) (limited to 65535), which
+// is not less than the square root of any value whose top 8 bits are i.
+extern const uint16_t kSqrtSeedLut[];
+
+static inline int IntegerCountLeadingZeros32(uint32_t n) {
+#if defined(__ARM_ARCH_6M__)
+  int zeros = 0;
+  if (n < 0x10000U) zeros += 16, n <<= 16;
+  if (n < 0x1000000U) zeros += 8, n <<= 8;
+  return zeros + kClzLut[n >> 24];
+#else
+  return CountLeadingZeros32(n);
+#endif
+}
+
+static inline int IntegerCountLeadingZeros64(uint64_t n) {
+  const uint32_t high = (uint32_t)(n >> 32);
+  if (high != 0) {
+    return IntegerCountLeadingZeros32(high);
+  }
+  return 32 + IntegerCountLeadingZeros32((uint32_t)n);
+}
+
+// floor(sqrt(num)) for num in [2^30, 2^32).
+static inline uint32_t IntegerSqrtNormalized32(uint32_t num) {
+  // The seed is not less than the square root, and the error is less than
+  // 2^-7. Newton's method from above stays above floor(sqrt(num)), and two
+  // steps make it floor(sqrt(num)) or one more.
+  uint32_t res = kSqrtSeedLut[(num >> 24) - 64];
+  res = (res + num / res) >> 1;
+  res = (res + num / res) >> 1;
+  if (res * res > num) {
+    --res;
+  }
+  return res;
+}
+
+// sqrt(num) rounded to the nearest, but limited to 0xFFFF (so it's rounded down
+// for num >= 0xFFFF8001).
+static inline uint16_t IntegerSqrt32(uint32_t num) {
+  if (num == 0) {
+    return 0;
+  }
+  // floor(sqrt(num << 2k)) >> k == floor(sqrt(num))
+  const int shift = IntegerCountLeadingZeros32(num) & ~1;
+  const uint32_t res = IntegerSqrtNormalized32(num << shift) >> (shift / 2);
+  const uint32_t remainder = num - res * res;
+  // Do rounding - if we have the bits.
+  if (remainder > res && res != 0xFFFF) {
+    return res + 1;
+  }
+  return res;
+}
+
+// sqrt(num) rounded to the nearest, but limited to 0xFFFFFFFF. num less than
+// 2^32 takes the 32-bit shortcut, so it's limited to 0xFFFF as IntegerSqrt32.
+static inline uint32_t IntegerSqrt64(uint64_t num) {
+  if ((num >> 32) == 0) {
+    return IntegerSqrt32((uint32_t)num);
+  }
+#if defined(__ARM_ARCH_6M__)
+  // The Newton step below is a 64/64 division, which is __aeabi_uldivmod in
+  // software on Cortex-M0+. It's not measured to be faster than one bit per
+  // iteration, so the bit-by-bit root is kept here.
+  uint64_t res = 0;
+  const int max_bit_number = IntegerCountLeadingZeros64(num) | 1;
+  uint64_t bit = 1ULL << (63 - max_bit_number);
+  int iterations = (63 - max_bit_number) / 2 + 1;
+  while (iterations--) {
+    if (num >= res + bit) {
+      num -= res + bit;
+      res = (res >> 1U) + bit;
+    } else {
+      res >>= 1U;
+    }
+    bit >>= 2U;
+  }
+  const uint64_t remainder = num;
+#else
+  const int shift = IntegerCountLeadingZeros64(num) & ~1;
+  const uint64_t normalized = num << shift;
+  // The top 16 bits of the root come from the top 32 bits, and one Newton step
+  // from above gives the rest (with the error of one at most). It divides 64
+  // bits by 64 bits.
+  const uint32_t high = IntegerSqrtNormalized32((uint32_t)(normalized >> 32));
+  uint64_t root = ((uint64_t)(high + 1) << 16) - 1;
+  root = (root + normalized / root) >> 1;
+  if (root > 0xFFFFFFFFULL) {
+    root = 0xFFFFFFFFULL;
+  }
+  while (root * root > normalized) {
+    --root;
+  }
+  const uint64_t res = root >> (shift / 2);
+  const uint64_t remainder = num - res * res;
+#endif
+  // Do rounding - if we have the bits.
+  if (remainder > res && res != 0xFFFFFFFFLL) {
+    return (uint32_t)(res + 1);
+  }
+  return (uint32_t)res;
+}
+
+// Integer logarithm of x (2 or more), scaled by scale_shift. The approximation
+// is calculated according to method described in
+//       www.inti.gob.ar/electronicaeinformatica/instrumentacion/utic/
+//       publicaciones/SPL2007/Log10-spl07.pdf
+// It first calculates log2 of the input and then converts it to natural
+// logarithm.
+static inline uint32_t IntegerLog(uint32_t x, uint32_t scale_shift) {
+  const uint32_t integer = 31 - IntegerCountLeadingZeros32(x);
+  // Log2FractionPart
+  int32_t frac = x - (1U << integer);
+  if (integer < kLogScaleLog2) {
+    frac <<= kLogScaleLog2 - integer;
+  } else {
+    frac >>= integer - kLogScaleLog2;
+  }
+  const uint32_t base_seg = frac >> (kLogScaleLog2 - kLogSegmentsLog2);
+  const uint32_t seg_unit =
+      (((uint32_t)1) << kLogScaleLog2) >> kLogSegmentsLog2;
+  const int32_t c0 = kLogLut[base_seg];
+  const int32_t c1 = kLogLut[base_seg + 1];
+  const int32_t seg_base = seg_unit * base_seg;
+  const int32_t rel_pos = ((c1 - c0) * (frac - seg_base)) >> kLogScaleLog2;
+  const uint32_t fraction = frac + c0 + rel_pos;
+
+  const uint32_t log2 = (integer << kLogScaleLog2) + fraction;
+  const uint32_t round = kLogScale / 2;
+  // (kLogCoeff * log2 + round) >> kLogScaleLog2 in 32 bits: log2 is less than
+  // 2^21, so it's split into the upper and lower 16 bits.
+  const uint32_t loge =
+      kLogCoeff * (log2 >> kLogScaleLog2) +
+      ((kLogCoeff * (log2 & (kLogScale - 1)) + round) >> kLogScaleLog2);
+  // Finally scale to our output scale
+  const uint32_t loge_scaled = ((loge << scale_shift) + round) >> kLogScaleLog2;
+  return loge_scaled;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_INTEGER_MATH_H_
@@ -14,47 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/microfrontend/lib/log_scale.h"
 
-#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
-#include "tensorflow/lite/experimental/microfrontend/lib/log_lut.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/integer_math.h"
 
 #define kuint16max 0x0000FFFF
 
-// The following functions implement integer logarithms of various sizes. The
-// approximation is calculated according to method described in
-//       www.inti.gob.ar/electronicaeinformatica/instrumentacion/utic/
-//       publicaciones/SPL2007/Log10-spl07.pdf
-// It first calculates log2 of the input and then converts it to natural
-// logarithm.
-
-static uint32_t Log2FractionPart(const uint32_t x, const uint32_t log2x) {
-  // Part 1
-  int32_t frac = x - (1LL << log2x);
-  if (log2x < kLogScaleLog2) {
-    frac <<= kLogScaleLog2 - log2x;
+static inline uint16_t LogScaleValue(uint32_t value, int scale_shift,
+                                     int correction_bits) {
+  if (correction_bits < 0) {
+    value >>= -correction_bits;
   } else {
-    frac >>= log2x - kLogScaleLog2;
+    value <<= correction_bits;
   }
-  // Part 2
-  const uint32_t base_seg = frac >> (kLogScaleLog2 - kLogSegmentsLog2);
-  const uint32_t seg_unit =
-      (((uint32_t)1) << kLogScaleLog2) >> kLogSegmentsLog2;
-
-  const int32_t c0 = kLogLut[base_seg];
-  const int32_t c1 = kLogLut[base_seg + 1];
-  const int32_t seg_base = seg_unit * base_seg;
-  const int32_t rel_pos = ((c1 - c0) * (frac - seg_base)) >> kLogScaleLog2;
-  return frac + c0 + rel_pos;
-}
-
-static uint32_t Log(const uint32_t x, const uint32_t scale_shift) {
-  const uint32_t integer = MostSignificantBit32(x) - 1;
-  const uint32_t fraction = Log2FractionPart(x, integer);
-  const uint32_t log2 = (integer << kLogScaleLog2) + fraction;
-  const uint32_t round = kLogScale / 2;
-  const uint32_t loge = (((uint64_t)kLogCoeff) * log2 + round) >> kLogScaleLog2;
-  // Finally scale to our output scale
-  const uint32_t loge_scaled = ((loge << scale_shift) + round) >> kLogScaleLog2;
-  return loge_scaled;
+  if (value > 1) {
+    value = IntegerLog(value, scale_shift);
+  } else {
+    value = 0;
+  }
+  return (value < kuint16max) ? value : kuint16max;
 }
 
 uint16_t* LogScaleApply(struct LogScaleState* state, uint32_t* signal,
@@ -63,21 +39,29 @@ uint16_t* LogScaleApply(struct LogScaleState* state, uint32_t* signal,
   uint16_t* output = (uint16_t*)signal;
   uint16_t* ret = output;
   int i;
-  for (i = 0; i < signal_size; ++i) {
-    uint32_t value = *signal++;
-    if (state->enable_log) {
-      if (correction_bits < 0) {
-        value >>= -correction_bits;
-      } else {
-        value <<= correction_bits;
-      }
-      if (value > 1) {
-        value = Log(value, scale_shift);
-      } else {
-        value = 0;
-      }
+  if (!state->enable_log) {
+    for (i = 0; i < signal_size; ++i) {
+      const uint32_t value = *signal++;
+      *output++ = (value < kuint16max) ? value : kuint16max;
     }
-    *output++ = (value < kuint16max) ? value : kuint16max;
+    return ret;
+  }
+  // Four channels at a time. All the inputs are read before the outputs are
+  // written, because the output overlaps the signal.
+  for (i = 0; i + 4 <= signal_size; i += 4) {
+    const uint32_t value0 = signal[0];
+    const uint32_t value1 = signal[1];
+    const uint32_t value2 = signal[2];
+    const uint32_t value3 = signal[3];
+    output[0] = LogScaleValue(value0, scale_shift, correction_bits);
+    output[1] = LogScaleValue(value1, scale_shift, correction_bits);
+    output[2] = LogScaleValue(value2, scale_shift, correction_bits);
+    output[3] = LogScaleValue(value3, scale_shift, correction_bits);
+    signal += 4;
+    output += 4;
+  }
+  for (; i < signal_size; ++i) {
+    *output++ = LogScaleValue(*signal++, scale_shift, correction_bits);
   }
   return ret;
 }
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_NOISE_REDUCTION_UTIL_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_NOISE_REDUCTION_UTIL_H_
 
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
 #include "tensorflow/lite/experimental/microfrontend/lib/noise_reduction.h"
 
 #ifdef __cplusplus
@@ -40,6 +41,13 @@ int NoiseReductionPopulateState(const struct NoiseReductionConfig* config,
                                 struct NoiseReductionState* state,
                                 int num_channels);
 
+// The same as NoiseReductionPopulateState, but the buffer is taken from the
+// arena.
+int NoiseReductionPopulateStateInArena(
+    const struct NoiseReductionConfig* config,
+    struct NoiseReductionState* state, int num_channels,
+    struct FrontendArena* arena);
+
 // Frees any allocated buffers.
 void NoiseReductionFreeStateContents(struct NoiseReductionState* state);
 
@@ -14,14 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/microfrontend/lib/pcan_gain_control.h"
 
-#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/integer_math.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/simd.h"
 
 int16_t WideDynamicFunction(const uint32_t x, const int16_t* lut) {
   if (x <= 2) {
     return lut[x];
   }
 
-  const int16_t interval = MostSignificantBit32(x);
+  const int16_t interval = 32 - IntegerCountLeadingZeros32(x);
   lut += 4 * interval - 6;
 
   const int16_t frac =
@@ -44,13 +45,106 @@ uint32_t PcanShrink(const uint32_t x) {
   }
 }
 
-void PcanGainControlApply(struct PcanGainControlState* state,
-                          uint32_t* signal) {
+// The original calculation with 64-bit multiplication.
+static void PcanGainControlApplyWide(struct PcanGainControlState* state,
+                                     uint32_t* signal, int start, int end) {
   int i;
-  for (i = 0; i < state->num_channels; ++i) {
+  for (i = start; i < end; ++i) {
     const uint32_t gain =
         WideDynamicFunction(state->noise_estimate[i], state->gain_lut);
     const uint32_t snr = ((uint64_t)signal[i] * gain) >> state->snr_shift;
     signal[i] = PcanShrink(snr);
   }
 }
+
+#if defined(MICROFRONTEND_SIMD)
+// Four channels at a time. Only the gains are calculated one by one (the
+// lookup depends on each noise estimate).
+static int PcanGainControlApplySimd(struct PcanGainControlState* state,
+                                    uint32_t* signal) {
+  const int16_t* gain_lut = state->gain_lut;
+  const uint32_t* noise_estimate = state->noise_estimate;
+  uint32_t gains[4];
+  int i;
+#if defined(MICROFRONTEND_SIMD_SSE2)
+  const __m128i snr_shift = _mm_cvtsi32_si128(state->snr_shift);
+  const __m128i shrink_threshold = _mm_set1_epi32((2 << kPcanSnrBits) - 1);
+  const __m128i shrink_offset = _mm_set1_epi32(1 << kPcanOutputBits);
+#else
+  const int64x2_t minus_snr_shift = vdupq_n_s64(-state->snr_shift);
+  const uint32x4_t shrink_threshold = vdupq_n_u32(2 << kPcanSnrBits);
+  const uint32x4_t shrink_offset = vdupq_n_u32(1 << kPcanOutputBits);
+#endif
+  for (i = 0; i + 4 <= state->num_channels; i += 4) {
+    gains[0] = WideDynamicFunction(noise_estimate[i], gain_lut);
+    gains[1] = WideDynamicFunction(noise_estimate[i + 1], gain_lut);
+    gains[2] = WideDynamicFunction(noise_estimate[i + 2], gain_lut);
+    gains[3] = WideDynamicFunction(noise_estimate[i + 3], gain_lut);
+#if defined(MICROFRONTEND_SIMD_SSE2)
+    const __m128i value = _mm_loadu_si128((const __m128i*)(signal + i));
+    const __m128i gain = _mm_loadu_si128((const __m128i*)gains);
+    const __m128i snr = SimdInterleave(
+        _mm_srl_epi64(SimdMulEven(value, gain), snr_shift),
+        _mm_srl_epi64(SimdMulOdd(value, gain), snr_shift));
+    // PcanShrink
+    const __m128i snr_squared =
+        SimdInterleave(SimdMulEven(snr, snr), SimdMulOdd(snr, snr));
+    const __m128i small = _mm_srli_epi32(
+        snr_squared, 2 + 2 * kPcanSnrBits - kPcanOutputBits);
+    const __m128i large = _mm_sub_epi32(
+        _mm_srli_epi32(snr, kPcanSnrBits - kPcanOutputBits), shrink_offset);
+    _mm_storeu_si128(
+        (__m128i*)(signal + i),
+        SimdSelect(SimdGreaterThanU32(snr, shrink_threshold), large, small));
+#else
+    const uint32x4_t value = vld1q_u32(signal + i);
+    const uint32x4_t gain = vld1q_u32(gains);
+    const uint32x4_t snr = vcombine_u32(
+        vmovn_u64(vshlq_u64(vmull_u32(vget_low_u32(value), vget_low_u32(gain)),
+                            minus_snr_shift)),
+        vmovn_u64(vshlq_u64(
+            vmull_u32(vget_high_u32(value), vget_high_u32(gain)),
+            minus_snr_shift)));
+    // PcanShrink
+    const uint32x4_t small = vshrq_n_u32(
+        vmulq_u32(snr, snr), 2 + 2 * kPcanSnrBits - kPcanOutputBits);
+    const uint32x4_t large = vsubq_u32(
+        vshrq_n_u32(snr, kPcanSnrBits - kPcanOutputBits), shrink_offset);
+    vst1q_u32(signal + i,
+              vbslq_u32(vcltq_u32(snr, shrink_threshold), small, large));
+#endif
+  }
+  return i;
+}
+#endif
+
+void PcanGainControlApply(struct PcanGainControlState* state,
+                          uint32_t* signal) {
+#if defined(MICROFRONTEND_SIMD)
+  const int done = PcanGainControlApplySimd(state, signal);
+  PcanGainControlApplyWide(state, signal, done, state->num_channels);
+#else
+  const int32_t snr_shift = state->snr_shift;
+  if (snr_shift < 0 || snr_shift > 16) {
+    PcanGainControlApplyWide(state, signal, 0, state->num_channels);
+    return;
+  }
+  const int16_t* gain_lut = state->gain_lut;
+  const uint32_t* noise_estimate = state->noise_estimate;
+  int i;
+  for (i = 0; i < state->num_channels; ++i) {
+    const uint32_t gain = WideDynamicFunction(noise_estimate[i], gain_lut);
+    if (gain > 0xFFFF) {
+      // A negative gain (only with a broken LUT) needs 64 bits.
+      PcanGainControlApplyWide(state, signal, i, i + 1);
+      continue;
+    }
+    // (signal * gain) >> snr_shift without 64-bit multiplication: the upper
+    // and the lower 16 bits of the signal are multiplied separately.
+    const uint32_t value = signal[i];
+    const uint32_t snr = (((value >> 16) * gain) << (16 - snr_shift)) +
+                         (((value & 0xFFFF) * gain) >> snr_shift);
+    signal[i] = PcanShrink(snr);
+  }
+#endif
+}
@@ -46,13 +46,24 @@ int PcanGainControlPopulateState(const struct PcanGainControlConfig* config,
                                  const int num_channels,
                                  const uint16_t smoothing_bits,
                                  const int32_t input_correction_bits) {
+  return PcanGainControlPopulateStateInArena(config, state, noise_estimate,
+                                             num_channels, smoothing_bits,
+                                             input_correction_bits, NULL);
+}
+
+int PcanGainControlPopulateStateInArena(
+    const struct PcanGainControlConfig* config,
+    struct PcanGainControlState* state, uint32_t* noise_estimate,
+    const int num_channels, const uint16_t smoothing_bits,
+    const int32_t input_correction_bits, struct FrontendArena* arena) {
   state->enable_pcan = config->enable_pcan;
   if (!state->enable_pcan) {
     return 1;
   }
   state->noise_estimate = noise_estimate;
   state->num_channels = num_channels;
-  state->gain_lut = malloc(kWideDynamicFunctionLUTSize * sizeof(int16_t));
+  state->gain_lut =
+      FrontendArenaAlloc(arena, kWideDynamicFunctionLUTSize * sizeof(int16_t));
   if (state->gain_lut == NULL) {
     fprintf(stderr, "Failed to allocate gain LUT\n");
     return 0;
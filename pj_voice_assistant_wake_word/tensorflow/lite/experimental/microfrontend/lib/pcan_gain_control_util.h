@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_PCAN_GAIN_CONTROL_UTIL_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_PCAN_GAIN_CONTROL_UTIL_H_
 
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
 #include "tensorflow/lite/experimental/microfrontend/lib/pcan_gain_control.h"
 
 #define kWideDynamicFunctionBits 32
@@ -48,6 +49,14 @@ int PcanGainControlPopulateState(const struct PcanGainControlConfig* config,
                                  const uint16_t smoothing_bits,
                                  const int32_t input_correction_bits);
 
+// The same as PcanGainControlPopulateState, but the LUT is taken from the
+// arena.
+int PcanGainControlPopulateStateInArena(
+    const struct PcanGainControlConfig* config,
+    struct PcanGainControlState* state, uint32_t* noise_estimate,
+    const int num_channels, const uint16_t smoothing_bits,
+    const int32_t input_correction_bits, struct FrontendArena* arena);
+
 void PcanGainControlFreeStateContents(struct PcanGainControlState* state);
 
 #ifdef __cplusplus
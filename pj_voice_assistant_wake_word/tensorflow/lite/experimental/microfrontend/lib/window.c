@@ -16,8 +16,86 @@ limitations under the License.
 
 #include <string.h>
 
+// Applies the window to num samples of input from coefficients, and updates
+// max_abs_output_value (which must be initialized by the caller).
+static int16_t* WindowApply(const int16_t* input, const int16_t* coefficients,
+                            int num, int16_t* output,
+                            int16_t* max_abs_output_value) {
+  int i;
+  int16_t max_value = *max_abs_output_value;
+  for (i = 0; i < num; ++i) {
+    int16_t new_value =
+        (((int32_t)*input++) * *coefficients++) >> kFrontendWindowBits;
+    *output++ = new_value;
+    if (new_value < 0) {
+      new_value = -new_value;
+    }
+    if (new_value > max_value) {
+      max_value = new_value;
+    }
+  }
+  *max_abs_output_value = max_value;
+  return output;
+}
+
+static int WindowProcessSamplesCircular(struct WindowState* state,
+                                        const int16_t* samples,
+                                        size_t num_samples,
+                                        size_t* num_samples_read) {
+  const int size = state->size;
+
+  // Copy samples after the newest one. The copy wraps around at size.
+  size_t max_samples_to_copy = state->size - state->input_used;
+  if (max_samples_to_copy > num_samples) {
+    max_samples_to_copy = num_samples;
+  }
+  size_t write_index = state->input_start + state->input_used;
+  if (write_index >= state->size) {
+    write_index -= state->size;
+  }
+  size_t first_copy = state->size - write_index;
+  if (first_copy > max_samples_to_copy) {
+    first_copy = max_samples_to_copy;
+  }
+  memcpy(state->input + write_index, samples, first_copy * sizeof(*samples));
+  memcpy(state->input, samples + first_copy,
+         (max_samples_to_copy - first_copy) * sizeof(*samples));
+  *num_samples_read = max_samples_to_copy;
+  state->input_used += max_samples_to_copy;
+
+  if (state->input_used < state->size) {
+    // We don't have enough samples to compute a window.
+    return 0;
+  }
+
+  // Apply the window from the oldest sample, reading across the wrap point.
+  const int first_num = size - state->input_start;
+  int16_t max_abs_output_value = 0;
+  int16_t* output =
+      WindowApply(state->input + state->input_start, state->coefficients,
+                  first_num, state->output, &max_abs_output_value);
+  WindowApply(state->input, state->coefficients + first_num,
+              size - first_num, output, &max_abs_output_value);
+
+  // Step forward without moving the input.
+  state->input_start += state->step;
+  if (state->input_start >= state->size) {
+    state->input_start -= state->size;
+  }
+  state->input_used -= state->step;
+  state->max_abs_output_value = max_abs_output_value;
+
+  // Indicate that the output buffer is valid for the next stage.
+  return 1;
+}
+
 int WindowProcessSamples(struct WindowState* state, const int16_t* samples,
                          size_t num_samples, size_t* num_samples_read) {
+  if (state->circular_input) {
+    return WindowProcessSamplesCircular(state, samples, num_samples,
+                                        num_samples_read);
+  }
+
   const int size = state->size;
 
   // Copy samples from the samples buffer over to our local input.
@@ -36,22 +114,9 @@ int WindowProcessSamples(struct WindowState* state, const int16_t* samples,
   }
 
   // Apply the window to the input.
-  const int16_t* coefficients = state->coefficients;
-  const int16_t* input = state->input;
-  int16_t* output = state->output;
-  int i;
   int16_t max_abs_output_value = 0;
-  for (i = 0; i < size; ++i) {
-    int16_t new_value =
-        (((int32_t)*input++) * *coefficients++) >> kFrontendWindowBits;
-    *output++ = new_value;
-    if (new_value < 0) {
-      new_value = -new_value;
-    }
-    if (new_value > max_abs_output_value) {
-      max_abs_output_value = new_value;
-    }
-  }
+  WindowApply(state->input, state->coefficients, size, state->output,
+              &max_abs_output_value);
   // Shuffle the input down by the step size, and update how much we have used.
   memmove(state->input, state->input + state->step,
           sizeof(*state->input) * (state->size - state->step));
@@ -65,6 +130,7 @@ int WindowProcessSamples(struct WindowState* state, const int16_t* samples,
 void WindowReset(struct WindowState* state) {
   memset(state->input, 0, state->size * sizeof(*state->input));
   memset(state->output, 0, state->size * sizeof(*state->output));
+  state->input_start = 0;
   state->input_used = 0;
   state->max_abs_output_value = 0;
 }
@@ -31,6 +31,10 @@ struct WindowState {
 
   int16_t* input;
   size_t input_used;
+  // Circular input: the oldest sample is at input[input_start], and the input
+  // wraps around at size. Otherwise input_start is always 0.
+  int circular_input;
+  size_t input_start;
   int16_t* output;
   int16_t max_abs_output_value;
 };
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_WINDOW_UTIL_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_WINDOW_UTIL_H_
 
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_arena.h"
 #include "tensorflow/lite/experimental/microfrontend/lib/window.h"
 
 #ifdef __cplusplus
@@ -26,6 +27,9 @@ struct WindowConfig {
   size_t size_ms;
   // length of step for next frame in milliseconds
   size_t step_size_ms;
+  // 1: keep the input in a circular buffer instead of shifting it down by the
+  // step after every frame (memmove). The output is the same.
+  int circular_input;
 };
 
 // Populates the WindowConfig with "sane" default values.
@@ -35,6 +39,11 @@ void WindowFillConfigWithDefaults(struct WindowConfig* config);
 int WindowPopulateState(const struct WindowConfig* config,
                         struct WindowState* state, int sample_rate);
 
+// The same as WindowPopulateState, but the buffers are taken from the arena.
+int WindowPopulateStateInArena(const struct WindowConfig* config,
+                               struct WindowState* state, int sample_rate,
+                               struct FrontendArena* arena);
+
 // Frees any allocated buffers.
 void WindowFreeStateContents(struct WindowState* state);
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 
 #include "utility_macro.h"
+#include "sample_converter.h"
 #include "test_audio_data.h"
 
 /*** MACRO ***/
@@ -30,6 +31,7 @@ limitations under the License.
 
 /*** GLOBAL VARIABLE ***/
 static std::vector<uint8_t> s_test_data;
+static std::vector<uint16_t> s_test_data16;    // for sample_bits = 12
 static int32_t s_current_test_data_index = 0;
 
 /*** FUNCTION ***/
@@ -39,15 +41,24 @@ int32_t TestBuffer::Initialize(const Config& config) {
     capture_channel_ = config.capture_channel;	// not in use
     capture_depth_ = config.capture_depth;
     sampling_rate_ = config.sampling_rate;
+    sample_bits_ = config.sample_bits;
+    if (sample_bits_ != 8 && sample_bits_ != 12) {
+        PRINT_E("sample_bits must be 8 or 12: %d\n", sample_bits_);
+        return kRetErr;
+    }
 
-    /* Reset buffer */
-    test_block_buffer_.Initialize(buffer_num_, capture_depth_);
-
+    /* Reset buffer and prepare test data quantized in the same way as ADC */
     const int32_t kTestDataNum = sizeof(s_testAudioData) / sizeof(int16_t);
-    for (int32_t i = 0; i < kTestDataNum; i++) {
-        //s_test_data.push_back(i);
-        //s_test_data.push_back( (1 + sin((3.14 * i) / 16000.0 * 400)) * 128  );
-        s_test_data.push_back(s_testAudioData[i] / 256 + 128);
+    if (sample_bits_ == 12) {
+        test_block_buffer16_.Initialize(buffer_num_, capture_depth_);
+        s_test_data16.resize(kTestDataNum);
+        SampleConverter::ConvertS16ToU12(s_testAudioData, s_test_data16.data(), kTestDataNum);    // s_testAudioData[i] / 16 + 2048
+    } else {
+        test_block_buffer_.Initialize(buffer_num_, capture_depth_);
+        s_test_data.resize(kTestDataNum);
+        SampleConverter::ConvertS16ToU8(s_testAudioData, s_test_data.data(), kTestDataNum);    // s_testAudioData[i] / 256 + 128
+        //for (int32_t i = 0; i < kTestDataNum; i++) s_test_data[i] = i;
+        //for (int32_t i = 0; i < kTestDataNum; i++) s_test_data[i] = (1 + sin((3.14 * i) / 16000.0 * 400)) * 128;
     }
 
     return kRetOk;
@@ -70,22 +81,38 @@ RingBlockBuffer<uint8_t>& TestBuffer::GetRingBlockBuffer(void) {
     return test_block_buffer_;
 }
 
+RingBlockBuffer<uint16_t>& TestBuffer::GetRingBlockBuffer16(void) {
+    return test_block_buffer16_;
+}
+
 void TestBuffer::DebugWriteData(int32_t duration_ms) {
     const int32_t kUpdateNum = duration_ms * sampling_rate_ / 1000 / capture_depth_;
-    const int32_t kTestDataNum = static_cast<int32_t>(s_test_data.size());
+    if (sample_bits_ == 12) {
+        WriteTestData(test_block_buffer16_, s_test_data16, kUpdateNum);
+    } else {
+        WriteTestData(test_block_buffer_, s_test_data, kUpdateNum);
+    }
+}
+
+template<class T>
+void TestBuffer::WriteTestData(RingBlockBuffer<T>& block_buffer, const std::vector<T>& test_data, int32_t update_num) {
+    const int32_t kTestDataNum = static_cast<int32_t>(test_data.size());
 
     if (s_current_test_data_index == kTestDataNum) return;  // do not write debug data exceed prepared test data
 
-    for (int32_t update_count = 0; update_count < kUpdateNum; update_count++) {
-        uint8_t* p = test_block_buffer_.WritePtr();
+    for (int32_t update_count = 0; update_count < update_num; update_count++) {
+        /* stamp the time when the last sample of the block would be captured */
+        const uint64_t time_us = static_cast<uint64_t>(s_current_test_data_index + capture_depth_) * 1000 * 1000 / sampling_rate_;
+        T* p = block_buffer.WritePtr(time_us);
         if (p == nullptr) {
-            //printf("AdcBuffer: overflow\n");
-            //p = m_testBufferList.getLatestWritePtr();
+            /* the test data is not dropped but written at the next call. Count it anyway to see how the buffer size works */
+            CountOverrun();
             break;
         }
+        UpdateMaxStoredDataNum(block_buffer.stored_data_num());
 
         for (int32_t i = 0; i < capture_depth_; i++) {
-            p[i] = s_test_data[s_current_test_data_index];
+            p[i] = test_data[s_current_test_data_index];
             s_current_test_data_index++;
             if (s_current_test_data_index == kTestDataNum) return;
             //s_current_test_data_index %= SIZE_DATA_NUM;
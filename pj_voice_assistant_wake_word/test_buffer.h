@@ -17,6 +17,7 @@ limitations under the License.
 #define TEST_BUFFER_H_
 
 #include <cstdint>
+#include <vector>
 #include "ring_block_buffer.h"
 #include "audio_buffer.h"
 
@@ -27,6 +28,7 @@ public:
         , capture_channel_(0)
         , capture_depth_(0)
         , sampling_rate_(0)
+        , sample_bits_(8)
     {};
     ~TestBuffer() {}
     int32_t Initialize(const Config& config) override;
@@ -34,16 +36,24 @@ public:
     int32_t Start(void) override;
     int32_t Stop(void) override;
     RingBlockBuffer<uint8_t>& GetRingBlockBuffer(void) override;
+    RingBlockBuffer<uint16_t>& GetRingBlockBuffer16(void) override;
 
 public:
     void DebugWriteData(int32_t duration_ms);
 
+private:
+    template<class T>
+    void WriteTestData(RingBlockBuffer<T>& block_buffer, const std::vector<T>& test_data, int32_t update_num);
+
 private:
     int32_t buffer_num_;
     int32_t capture_channel_;
     int32_t capture_depth_;
     int32_t sampling_rate_;
-    RingBlockBuffer<uint8_t> test_block_buffer_;
+    int32_t sample_bits_;
+    RingBlockBuffer<uint8_t> test_block_buffer_;        // sample_bits_ = 8
+    RingBlockBuffer<uint16_t> test_block_buffer16_;     // sample_bits_ = 12
+
 };
 
 #endif  // TEST_BUFFER_H_